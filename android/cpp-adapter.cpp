@@ -1,5 +1,7 @@
 #include <jni.h>
 #include <jsi/jsi.h>
+#include <fbjni/fbjni.h>
+#include <ReactCommon/CallInvokerHolder.h>
 #include "vision-camera-plugin-anpr.h"
 #include <string>
 
@@ -7,11 +9,14 @@ using namespace facebook;
 
 extern "C"
 JNIEXPORT void JNICALL
-Java_com_visioncamerapluginanpr_VisionCameraPluginAnprModule_nativeInstallPlugin(JNIEnv *env, jclass type, jlong jsi) {
+Java_com_visioncamerapluginanpr_VisionCameraPluginAnprModule_nativeInstallPlugin(JNIEnv *env, jclass type, jlong jsi, jobject jsCallInvokerHolder) {
     auto runtime = reinterpret_cast<facebook::jsi::Runtime *>(jsi);
 
     if (runtime) {
-        visioncamerapluginanpr::installPlugin(*runtime);
+        auto callInvokerHolder = jni::alias_ref<react::CallInvokerHolder::javaobject>{
+            reinterpret_cast<react::CallInvokerHolder::javaobject>(jsCallInvokerHolder)
+        };
+        visioncamerapluginanpr::installPlugin(*runtime, callInvokerHolder->cthis()->getCallInvoker());
     }
 }
 
@@ -26,4 +31,16 @@ Java_com_visioncamerapluginanpr_VisionCameraPluginAnprModule_nativeAddAssetPaths
 
     env->ReleaseStringUTFChars(configFilePath, configPath);
     env->ReleaseStringUTFChars(runtimeDirPath, runtimePath);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_visioncamerapluginanpr_VisionCameraPluginAnprModule_nativeAddRuntimeBundle(JNIEnv* env, jobject clazz, jstring bundleFilePath, jstring extractDirPath) {
+    const char* bundlePath = env->GetStringUTFChars(bundleFilePath, nullptr);
+    const char* extractPath = env->GetStringUTFChars(extractDirPath, nullptr);
+
+    visioncamerapluginanpr::setRuntimeBundle(bundlePath, extractPath);
+
+    env->ReleaseStringUTFChars(bundleFilePath, bundlePath);
+    env->ReleaseStringUTFChars(extractDirPath, extractPath);
 }
\ No newline at end of file
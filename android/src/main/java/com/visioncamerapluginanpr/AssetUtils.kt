@@ -1,79 +1,72 @@
 package com.visioncamerapluginanpr
 
 import android.content.Context
-import android.content.res.AssetManager
 import android.util.Log
 import java.io.File
 import java.io.FileOutputStream
 import java.io.IOException
+import java.io.InputStream
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
 
 object AssetUtils {
-  @JvmStatic
-  fun copyAssets(context: Context, destinationDir: File) {
-    try {
-      val assetManager = context.assets
+  // Packed by the packRuntimeBundle Gradle task
+  private const val RUNTIME_BUNDLE_ASSET = "openalpr/runtime.bundle"
+  // Magic, format version, entry count and content version
+  private const val RUNTIME_BUNDLE_VERSION_BYTES = 24
+  // Written by the native extraction into the directory it extracted to, holding the content version in hex
+  private const val EXTRACTED_VERSION_STAMP = ".bundle-version"
 
-      if (assetExists(assetManager, "openalpr.conf")) {
-        copyAssetFile(context, "openalpr.conf", File(destinationDir, "openalpr.conf"))
-      } else {
-        copyAssetFile(context, "openalpr/openalpr.conf", File(destinationDir, "openalpr.conf"))
-      }
-      
-      // Copy runtime_data folder recursively
-      if (assetExists(assetManager, "runtime_data")) {
-        copyAssetDirectory(context, "runtime_data", File(destinationDir, "runtime_data"))
-      } else {
-        copyAssetDirectory(context, "openalpr/runtime_data", File(destinationDir, "runtime_data"))
-      }
+  // Copies the runtime data bundle out of the APK, where it may be compressed and so cannot be mapped, for the native
+  // side to extract into `extractedDir` and then delete. Returns null, without copying, if `extractedDir` already holds
+  // this version of the bundle or the app has no bundle.
+  @JvmStatic
+  fun copyRuntimeBundle(context: Context, destination: File, extractedDir: File): File? {
+    val bundledVersion = try {
+      context.assets.open(RUNTIME_BUNDLE_ASSET).use { readBundleVersion(it) }
     } catch (e: IOException) {
-      Log.e("ReactNative", "Failed to copy assets", e)
+      Log.e("ReactNative", "No runtime bundle in the APK", e)
+      return null
     }
-  }
 
-  // Recursively copy assets from a directory to the specified destination directory
-  private fun copyAssetDirectory(context: Context, assetDirName: String, destinationDir: File) {
-    try {
-      val assets = context.assets.list(assetDirName)
-      if (assets != null && assets.isNotEmpty()) {
-        // It's a directory, create if not exists
-        if (!destinationDir.exists()) {
-          destinationDir.mkdirs()
-        }
-        
-        for (asset in assets) {
-          val assetPath = "$assetDirName/$asset"
-          val destinationFile = File(destinationDir, asset)
-          copyAssetDirectory(context, assetPath, destinationFile) // Recursively copy
-        }
-      } else {
-        // It's a file, copy it
-        copyAssetFile(context, assetDirName, destinationDir)
-      }
-    } catch (e: IOException) {
-      Log.e("ReactNative", "Failed to copy assets: $assetDirName", e)
+    val stamp = File(extractedDir, EXTRACTED_VERSION_STAMP)
+    if (stamp.exists() && stamp.readText() == bundledVersion) {
+      // Left over if a launch was killed between copying and extracting
+      destination.delete()
+      return null
     }
-  }
 
-  // Helper method to copy a single asset file to the specified destination
-  private fun copyAssetFile(context: Context, assetFileName: String, destination: File) {
+    // Copied under another name first, so a bundle cut short is never mistaken for a complete one
+    val partial = File(destination.parentFile, destination.name + ".partial")
     try {
-      context.assets.open(assetFileName).use { inputStream ->
-        FileOutputStream(destination).use { outputStream ->
+      context.assets.open(RUNTIME_BUNDLE_ASSET).use { inputStream ->
+        FileOutputStream(partial).use { outputStream ->
           inputStream.copyTo(outputStream)
         }
       }
+      if (!partial.renameTo(destination)) {
+        throw IOException("Unable to rename ${partial.path}")
+      }
     } catch (e: IOException) {
-      Log.e("ReactNative", "Failed to copy asset file: $assetFileName", e)
+      Log.e("ReactNative", "Failed to copy runtime bundle", e)
+      partial.delete()
+      return null
     }
+    return destination
   }
 
-  // Helper function to check if an asset exists
-  private fun assetExists(assetManager: AssetManager, path: String): Boolean {
-    return try {
-      val assets = assetManager.list(path)
-      assets != null && assets.isNotEmpty()
-    } catch (e: IOException) {
-      false
+  // The content version from a bundle's header, formatted as the native extraction writes it to its stamp
+  private fun readBundleVersion(inputStream: InputStream): String {
+    val header = ByteArray(RUNTIME_BUNDLE_VERSION_BYTES)
+    var read = 0
+    while (read < header.size) {
+      val count = inputStream.read(header, read, header.size - read)
+      if (count < 0) {
+        throw IOException("Runtime bundle header is truncated")
+      }
+      read += count
     }
+    val version = ByteBuffer.wrap(header, 16, 8).order(ByteOrder.LITTLE_ENDIAN).long
+    return String.format("%016x", version)
   }
-}
\ No newline at end of file
+}
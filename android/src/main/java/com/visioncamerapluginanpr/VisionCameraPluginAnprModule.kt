@@ -5,6 +5,7 @@ import com.facebook.react.bridge.JavaScriptContextHolder
 import com.facebook.react.bridge.ReactApplicationContext
 import com.facebook.react.bridge.ReactContextBaseJavaModule
 import com.facebook.react.bridge.ReactMethod
+import com.facebook.react.turbomodule.core.CallInvokerHolderImpl
 
 import java.io.File
 import java.io.IOException
@@ -21,12 +22,15 @@ class VisionCameraPluginAnprModule(reactContext: ReactApplicationContext) : Reac
       System.loadLibrary("VisionCameraPluginAnpr")
     }
 
-    // Adds frame processor plugin to JS global variables
+    // Adds frame processor plugin to JS global variables. The CallInvoker lets native threads settle JS Promises.
     @JvmStatic
-    external fun nativeInstallPlugin(jsi: Long)
+    external fun nativeInstallPlugin(jsi: Long, jsCallInvokerHolder: CallInvokerHolderImpl)
 
     @JvmStatic
     external fun nativeAddAssetPaths(configFilePath: String, runtimeDirPath: String)
+
+    @JvmStatic
+    external fun nativeAddRuntimeBundle(bundleFilePath: String, extractDirPath: String)
   }
 
   override fun getName(): String {
@@ -38,12 +42,21 @@ class VisionCameraPluginAnprModule(reactContext: ReactApplicationContext) : Reac
 
       Log.d("ReactNative", "Starting initialization")
 
-      // Copies conf and runtime_data required by openalpr
-      copyAssetsToDataDirectory()
+      val appDir = File(getReactApplicationContext().filesDir, "openalpr")
+      if (!appDir.exists()) {
+        appDir.mkdir()
+      }
+
+      // The packed conf and runtime_data are copied out and extracted natively while the engines load, and only
+      // when they changed since the last extraction into appDir
+      val bundle = AssetUtils.copyRuntimeBundle(getReactApplicationContext(), File(getReactApplicationContext().filesDir, "openalpr-runtime.bundle"), appDir)
+      if (bundle != null) {
+        nativeAddRuntimeBundle(bundle.absolutePath, appDir.absolutePath)
+      }
 
       // Calculate the paths
-      val configFilePath = File(getReactApplicationContext().filesDir, "openalpr/openalpr.conf").absolutePath
-      val runtimeDirPath = File(getReactApplicationContext().filesDir, "openalpr/runtime_data").absolutePath
+      val configFilePath = File(appDir, "openalpr.conf").absolutePath
+      val runtimeDirPath = File(appDir, "runtime_data").absolutePath
       
       // Call the native method to pass the paths
       nativeAddAssetPaths(configFilePath, runtimeDirPath)
@@ -52,21 +65,13 @@ class VisionCameraPluginAnprModule(reactContext: ReactApplicationContext) : Reac
   }
 
 
-  private fun copyAssetsToDataDirectory() {
-    val appDir = File(getReactApplicationContext().filesDir, "openalpr")
-    if (!appDir.exists()) {
-      appDir.mkdir()
-    }
-    
-    AssetUtils.copyAssets(getReactApplicationContext(), appDir)
-  }
-
   @ReactMethod(isBlockingSynchronousMethod = true)
   fun installPlugin() {
     val jsContext: JavaScriptContextHolder? = getReactApplicationContext().javaScriptContextHolder
+    val jsCallInvokerHolder = getReactApplicationContext().jsCallInvokerHolder as? CallInvokerHolderImpl
 
-    if (jsContext != null && jsContext.get() != 0L) {
-      nativeInstallPlugin(jsContext.get())
+    if (jsContext != null && jsContext.get() != 0L && jsCallInvokerHolder != null) {
+      nativeInstallPlugin(jsContext.get(), jsCallInvokerHolder)
     } else {
       Log.e("ReactNative", "JSI Runtime is not available in debug mode")
     }
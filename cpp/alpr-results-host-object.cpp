@@ -0,0 +1,205 @@
+#include "alpr-results-host-object.h"
+
+namespace visioncamerapluginanpr {
+  using namespace facebook;
+
+  static std::vector<jsi::PropNameID> toPropNames(jsi::Runtime& runtime, std::initializer_list<const char*> names) {
+    std::vector<jsi::PropNameID> propNames;
+    propNames.reserve(names.size());
+    for (const char* name : names) {
+      propNames.push_back(jsi::PropNameID::forUtf8(runtime, name));
+    }
+    return propNames;
+  }
+
+  static jsi::Object toJsCoordinate(jsi::Runtime& runtime, const alpr::AlprCoordinate& coordinate) {
+    jsi::Object result(runtime);
+    result.setProperty(runtime, "x", coordinate.x);
+    result.setProperty(runtime, "y", coordinate.y);
+    return result;
+  }
+
+  static jsi::Array toJsCorners(jsi::Runtime& runtime, const alpr::AlprCoordinate (&corners)[4]) {
+    jsi::Array result(runtime, 4);
+    for (size_t i = 0; i < 4; ++i) {
+      result.setValueAtIndex(runtime, i, toJsCoordinate(runtime, corners[i]));
+    }
+    return result;
+  }
+
+  jsi::Object toJsStages(jsi::Runtime& runtime, const std::vector<StageTiming>& stages) {
+    jsi::Object result(runtime);
+    for (const StageTiming& stage : stages) {
+      jsi::Object timing(runtime);
+      timing.setProperty(runtime, "ms", stage.ms);
+      timing.setProperty(runtime, "runs", stage.runs);
+      result.setProperty(runtime, stage.stage.c_str(), std::move(timing));
+    }
+    return result;
+  }
+
+  static jsi::Object toJsTimings(jsi::Runtime& runtime, const RecognitionTimings& timings) {
+    jsi::Array candidates(runtime, timings.candidates.size());
+    for (size_t i = 0; i < timings.candidates.size(); ++i) {
+      const CandidateTiming& candidate = timings.candidates[i];
+      jsi::Object region(runtime);
+      region.setProperty(runtime, "x", candidate.region.x);
+      region.setProperty(runtime, "y", candidate.region.y);
+      region.setProperty(runtime, "width", candidate.region.width);
+      region.setProperty(runtime, "height", candidate.region.height);
+
+      jsi::Object entry(runtime);
+      entry.setProperty(runtime, "region", std::move(region));
+      entry.setProperty(runtime, "plateIndex", candidate.plateIndex);
+      entry.setProperty(runtime, "stages", toJsStages(runtime, candidate.stages));
+      candidates.setValueAtIndex(runtime, i, std::move(entry));
+    }
+
+    jsi::Object result(runtime);
+    result.setProperty(runtime, "totalMs", timings.totalMs);
+    result.setProperty(runtime, "stages", toJsStages(runtime, timings.stages));
+    result.setProperty(runtime, "candidates", std::move(candidates));
+    result.setProperty(runtime, "candidatesRejected", timings.candidatesRejected);
+    result.setProperty(runtime, "thresholdPasses", timings.thresholdPasses);
+    return result;
+  }
+
+  AlprResultsHostObject::AlprResultsHostObject(alpr::AlprResults results, std::shared_ptr<const RecognitionTimings> timings)
+    : results(std::make_shared<const alpr::AlprResults>(std::move(results))), timings(std::move(timings)) {}
+
+  jsi::Value AlprResultsHostObject::get(jsi::Runtime& runtime, const jsi::PropNameID& name) {
+    std::string propName = name.utf8(runtime);
+
+    if (propName == "epoch_time") {
+      return jsi::Value(static_cast<double>(results->epoch_time));
+    } else if (propName == "frame_number") {
+      return jsi::Value(static_cast<double>(results->frame_number));
+    } else if (propName == "img_width") {
+      return jsi::Value(results->img_width);
+    } else if (propName == "img_height") {
+      return jsi::Value(results->img_height);
+    } else if (propName == "total_processing_time_ms") {
+      return jsi::Value(static_cast<double>(results->total_processing_time_ms));
+    } else if (propName == "plates") {
+      jsi::Array plates(runtime, results->plates.size());
+      for (size_t i = 0; i < results->plates.size(); ++i) {
+        auto plate = std::make_shared<AlprPlateResultHostObject>(results, i);
+        plates.setValueAtIndex(runtime, i, jsi::Object::createFromHostObject(runtime, plate));
+      }
+      return plates;
+    } else if (propName == "regionsOfInterest") {
+      jsi::Array regions(runtime, results->regionsOfInterest.size());
+      for (size_t i = 0; i < results->regionsOfInterest.size(); ++i) {
+        const alpr::AlprRegionOfInterest& roi = results->regionsOfInterest[i];
+        jsi::Object region(runtime);
+        region.setProperty(runtime, "x", roi.x);
+        region.setProperty(runtime, "y", roi.y);
+        region.setProperty(runtime, "width", roi.width);
+        region.setProperty(runtime, "height", roi.height);
+        regions.setValueAtIndex(runtime, i, std::move(region));
+      }
+      return regions;
+    } else if (propName == "timing" && timings) {
+      return toJsTimings(runtime, *timings);
+    }
+
+    return jsi::Value::undefined();
+  }
+
+  std::vector<jsi::PropNameID> AlprResultsHostObject::getPropertyNames(jsi::Runtime& runtime) {
+    if (timings) {
+      return toPropNames(runtime, {
+        "epoch_time", "frame_number", "img_width", "img_height", "total_processing_time_ms", "plates", "regionsOfInterest", "timing"
+      });
+    }
+
+    return toPropNames(runtime, {
+      "epoch_time", "frame_number", "img_width", "img_height", "total_processing_time_ms", "plates", "regionsOfInterest"
+    });
+  }
+
+  AlprPlateResultHostObject::AlprPlateResultHostObject(std::shared_ptr<const alpr::AlprResults> results, size_t plateIndex)
+    : results(std::move(results)), plateIndex(plateIndex) {}
+
+  const alpr::AlprPlateResult& AlprPlateResultHostObject::plateResult() const {
+    return results->plates[plateIndex];
+  }
+
+  jsi::Value AlprPlateResultHostObject::get(jsi::Runtime& runtime, const jsi::PropNameID& name) {
+    std::string propName = name.utf8(runtime);
+    const alpr::AlprPlateResult& plateResult = this->plateResult();
+
+    if (propName == "requested_topn") {
+      return jsi::Value(plateResult.requested_topn);
+    } else if (propName == "country") {
+      return jsi::String::createFromUtf8(runtime, plateResult.country);
+    } else if (propName == "bestPlate") {
+      auto plate = std::make_shared<AlprPlateHostObject>(results, plateIndex, -1);
+      return jsi::Object::createFromHostObject(runtime, plate);
+    } else if (propName == "topNPlates") {
+      jsi::Array plates(runtime, plateResult.topNPlates.size());
+      for (size_t i = 0; i < plateResult.topNPlates.size(); ++i) {
+        auto plate = std::make_shared<AlprPlateHostObject>(results, plateIndex, static_cast<int>(i));
+        plates.setValueAtIndex(runtime, i, jsi::Object::createFromHostObject(runtime, plate));
+      }
+      return plates;
+    } else if (propName == "processing_time_ms") {
+      return jsi::Value(static_cast<double>(plateResult.processing_time_ms));
+    } else if (propName == "plate_points") {
+      return toJsCorners(runtime, plateResult.plate_points);
+    } else if (propName == "plate_index") {
+      return jsi::Value(plateResult.plate_index);
+    } else if (propName == "regionConfidence") {
+      return jsi::Value(plateResult.regionConfidence);
+    } else if (propName == "region") {
+      return jsi::String::createFromUtf8(runtime, plateResult.region);
+    }
+
+    return jsi::Value::undefined();
+  }
+
+  std::vector<jsi::PropNameID> AlprPlateResultHostObject::getPropertyNames(jsi::Runtime& runtime) {
+    return toPropNames(runtime, {
+      "requested_topn", "country", "bestPlate", "topNPlates", "processing_time_ms", "plate_points", "plate_index",
+      "regionConfidence", "region"
+    });
+  }
+
+  AlprPlateHostObject::AlprPlateHostObject(std::shared_ptr<const alpr::AlprResults> results, size_t plateIndex, int candidateIndex)
+    : results(std::move(results)), plateIndex(plateIndex), candidateIndex(candidateIndex) {}
+
+  const alpr::AlprPlate& AlprPlateHostObject::plate() const {
+    const alpr::AlprPlateResult& plateResult = results->plates[plateIndex];
+    return candidateIndex < 0 ? plateResult.bestPlate : plateResult.topNPlates[candidateIndex];
+  }
+
+  jsi::Value AlprPlateHostObject::get(jsi::Runtime& runtime, const jsi::PropNameID& name) {
+    std::string propName = name.utf8(runtime);
+    const alpr::AlprPlate& plate = this->plate();
+
+    if (propName == "characters") {
+      return jsi::String::createFromUtf8(runtime, plate.characters);
+    } else if (propName == "overall_confidence") {
+      return jsi::Value(static_cast<double>(plate.overall_confidence));
+    } else if (propName == "matches_template") {
+      return jsi::Value(plate.matches_template);
+    } else if (propName == "character_details") {
+      jsi::Array details(runtime, plate.character_details.size());
+      for (size_t i = 0; i < plate.character_details.size(); ++i) {
+        const alpr::AlprChar& character = plate.character_details[i];
+        jsi::Object detail(runtime);
+        detail.setProperty(runtime, "character", jsi::String::createFromUtf8(runtime, character.character));
+        detail.setProperty(runtime, "confidence", static_cast<double>(character.confidence));
+        detail.setProperty(runtime, "corners", toJsCorners(runtime, character.corners));
+        details.setValueAtIndex(runtime, i, std::move(detail));
+      }
+      return details;
+    }
+
+    return jsi::Value::undefined();
+  }
+
+  std::vector<jsi::PropNameID> AlprPlateHostObject::getPropertyNames(jsi::Runtime& runtime) {
+    return toPropNames(runtime, { "characters", "overall_confidence", "matches_template", "character_details" });
+  }
+}
@@ -0,0 +1,63 @@
+#ifndef VISIONCAMERAPLUGINANPR_ALPRRESULTSHOSTOBJECT_H
+#define VISIONCAMERAPLUGINANPR_ALPRRESULTSHOSTOBJECT_H
+
+#include <jsi/jsi.h>
+#include "alpr.h"
+#include "stage-timing.h"
+
+#include <memory>
+#include <vector>
+
+namespace visioncamerapluginanpr {
+  // Stages as an object keyed by stage name, each holding its ms and runs, as in a result's timing breakdown
+  facebook::jsi::Object toJsStages(facebook::jsi::Runtime& runtime, const std::vector<StageTiming>& stages);
+
+  // Exposes AlprResults to JS without serializing it. Properties are materialized only when JS reads
+  // them, so reading bestPlate.characters never builds the candidates or character details of other plates.
+  // Nested values are rebuilt on every read, so keep a reference in a local rather than reading repeatedly.
+  class AlprResultsHostObject : public facebook::jsi::HostObject {
+    public:
+      explicit AlprResultsHostObject(alpr::AlprResults results, std::shared_ptr<const RecognitionTimings> timings = nullptr);
+
+      facebook::jsi::Value get(facebook::jsi::Runtime& runtime, const facebook::jsi::PropNameID& name) override;
+      std::vector<facebook::jsi::PropNameID> getPropertyNames(facebook::jsi::Runtime& runtime) override;
+
+    private:
+      std::shared_ptr<const alpr::AlprResults> results;
+      // Exposed as `timing` when the caller asked for it
+      std::shared_ptr<const RecognitionTimings> timings;
+  };
+
+  // A single plate of an AlprResults, sharing ownership of the results it came from
+  class AlprPlateResultHostObject : public facebook::jsi::HostObject {
+    public:
+      AlprPlateResultHostObject(std::shared_ptr<const alpr::AlprResults> results, size_t plateIndex);
+
+      facebook::jsi::Value get(facebook::jsi::Runtime& runtime, const facebook::jsi::PropNameID& name) override;
+      std::vector<facebook::jsi::PropNameID> getPropertyNames(facebook::jsi::Runtime& runtime) override;
+
+    private:
+      const alpr::AlprPlateResult& plateResult() const;
+
+      std::shared_ptr<const alpr::AlprResults> results;
+      size_t plateIndex;
+  };
+
+  // A plate candidate; candidateIndex < 0 selects the best plate rather than one of topNPlates
+  class AlprPlateHostObject : public facebook::jsi::HostObject {
+    public:
+      AlprPlateHostObject(std::shared_ptr<const alpr::AlprResults> results, size_t plateIndex, int candidateIndex);
+
+      facebook::jsi::Value get(facebook::jsi::Runtime& runtime, const facebook::jsi::PropNameID& name) override;
+      std::vector<facebook::jsi::PropNameID> getPropertyNames(facebook::jsi::Runtime& runtime) override;
+
+    private:
+      const alpr::AlprPlate& plate() const;
+
+      std::shared_ptr<const alpr::AlprResults> results;
+      size_t plateIndex;
+      int candidateIndex;
+  };
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_ALPRRESULTSHOSTOBJECT_H */
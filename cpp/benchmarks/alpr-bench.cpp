@@ -0,0 +1,418 @@
+// End-to-end recognition benchmark: throughput, and latency percentiles for decoding and each OpenALPR stage.
+//
+//   cmake -S cpp -B build/host -DANPR_HOST_PREFIX=/opt/anpr-host && cmake --build build/host --target alpr-bench
+//   ./build/host/benchmarks/alpr-bench <input dir> --config openalpr.conf --runtime runtime_data --threads 4 --json bench.json
+//
+// The input directory holds images in any format OpenCV decodes, and raw 8-bit Y-plane dumps named *.y, *.gray or
+// *.raw. Raw dumps carry their size in their name, e.g. frame-0001-1920x1080.y, or take it from --raw-size.
+//
+// Each thread owns its own engine and takes the next image from a shared queue. Stage timings come from OpenALPR's
+// debugTiming output, captured per thread; stages that run more than once per image (character analysis runs before
+// and after deskewing, OCR once per plate candidate) are summed per image.
+
+#include "image-decoder.h"
+#include "stage-timing.h"
+#include "alpr_impl.h"
+#include "opencv2/core.hpp"
+#include "opencv2/imgcodecs.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace visioncamerapluginanpr;
+
+namespace {
+  struct Options {
+    std::string inputDir;
+    std::string country = "us";
+    std::string configFile;
+    std::string runtimeDir;
+    int threads = 1;
+    int iterations = 3;
+    int warmup = 1;
+    int rawWidth = 0;
+    int rawHeight = 0;
+    std::string jsonPath;
+  };
+
+  struct Input {
+    std::string name;
+    std::vector<unsigned char> bytes;
+    // Raw Y planes are wrapped rather than decoded
+    bool raw = false;
+    int width = 0;
+    int height = 0;
+  };
+
+  // One recognition of one input
+  struct Sample {
+    double decodeMs = 0;
+    double recognizeMs = 0;
+    double totalMs = 0;
+    size_t plates = 0;
+    std::vector<StageTiming> stages;
+  };
+
+  struct Percentiles {
+    size_t count = 0;
+    double mean = 0;
+    double p50 = 0;
+    double p95 = 0;
+    double p99 = 0;
+    double max = 0;
+  };
+
+  // Stages reported first, in pipeline order; any other stage OpenALPR reports follows them
+  const char* const kStageOrder[] = {
+    "decode", "detection", "characterAnalysis", "thresholds", "plateLines", "plateCorners", "deskew",
+    "segmentation", "ocr", "postProcess", "recognize", "total"
+  };
+
+  void printUsage() {
+    std::fprintf(stderr,
+      "usage: alpr-bench <input dir> [--country us] [--config openalpr.conf] [--runtime runtime_data]\n"
+      "                  [--threads 1] [--iterations 3] [--warmup 1] [--raw-size WxH] [--json file|-]\n");
+  }
+
+  bool parseSize(const std::string& text, int& width, int& height) {
+    static const std::regex kSize("(\\d+)x(\\d+)");
+    std::smatch match;
+    if (!std::regex_search(text, match, kSize)) {
+      return false;
+    }
+
+    width = std::atoi(match[1].str().c_str());
+    height = std::atoi(match[2].str().c_str());
+    return width > 0 && height > 0;
+  }
+
+  bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      bool hasValue = i + 1 < argc;
+
+      if (arg[0] != '-' && options.inputDir.empty()) {
+        options.inputDir = arg;
+      } else if (arg == "--country" && hasValue) {
+        options.country = argv[++i];
+      } else if (arg == "--config" && hasValue) {
+        options.configFile = argv[++i];
+      } else if (arg == "--runtime" && hasValue) {
+        options.runtimeDir = argv[++i];
+      } else if (arg == "--threads" && hasValue) {
+        options.threads = std::max(1, std::atoi(argv[++i]));
+      } else if (arg == "--iterations" && hasValue) {
+        options.iterations = std::max(1, std::atoi(argv[++i]));
+      } else if (arg == "--warmup" && hasValue) {
+        options.warmup = std::max(0, std::atoi(argv[++i]));
+      } else if (arg == "--raw-size" && hasValue) {
+        if (!parseSize(argv[++i], options.rawWidth, options.rawHeight)) {
+          return false;
+        }
+      } else if (arg == "--json" && hasValue) {
+        options.jsonPath = argv[++i];
+      } else {
+        return false;
+      }
+    }
+
+    return !options.inputDir.empty();
+  }
+
+  bool isRawPlane(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    return extension == ".y" || extension == ".gray" || extension == ".raw";
+  }
+
+  // Reads every input into memory up front, so disk reads are not part of any timing
+  std::vector<Input> loadInputs(const Options& options) {
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(options.inputDir)) {
+      if (entry.is_regular_file()) {
+        paths.push_back(entry.path());
+      }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<Input> inputs;
+    for (const std::filesystem::path& path : paths) {
+      Input input;
+      input.name = path.filename().string();
+      input.raw = isRawPlane(path);
+
+      std::ifstream file(path, std::ios::binary);
+      input.bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+      if (input.raw) {
+        if (!parseSize(input.name, input.width, input.height)) {
+          input.width = options.rawWidth;
+          input.height = options.rawHeight;
+        }
+
+        if (input.width <= 0 || static_cast<size_t>(input.width) * input.height != input.bytes.size()) {
+          std::fprintf(stderr, "Skipping %s: size unknown or does not match its length\n", input.name.c_str());
+          continue;
+        }
+      } else if (cv::imdecode(input.bytes, cv::IMREAD_UNCHANGED).empty()) {
+        continue;
+      }
+
+      inputs.push_back(std::move(input));
+    }
+
+    return inputs;
+  }
+
+  double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  Sample recognizeInput(alpr::AlprImpl& engine, const Input& input) {
+    Sample sample;
+    auto start = std::chrono::steady_clock::now();
+
+    // Decoded the way recognise decodes ArrayBuffers, into an image each worker reuses
+    static thread_local cv::Mat t_decodedImage;
+    cv::Mat image;
+    if (input.raw) {
+      image = cv::Mat(input.height, input.width, CV_8UC1, const_cast<unsigned char*>(input.bytes.data()));
+    } else {
+      decodeImage(input.bytes.data(), input.bytes.size(), t_decodedImage);
+      image = t_decodedImage;
+    }
+    sample.decodeMs = elapsedMs(start);
+
+    auto recognizeStart = std::chrono::steady_clock::now();
+    {
+      StageTimingCapture capture;
+      sample.plates = engine.recognize(image).plates.size();
+      sample.stages = capture.timings();
+    }
+    sample.recognizeMs = elapsedMs(recognizeStart);
+    sample.totalMs = elapsedMs(start);
+    return sample;
+  }
+
+  // Nearest-rank percentiles
+  Percentiles percentiles(std::vector<double> values) {
+    Percentiles result;
+    if (values.empty()) {
+      return result;
+    }
+
+    std::sort(values.begin(), values.end());
+    auto rank = [&values](double p) {
+      size_t index = static_cast<size_t>(p * values.size() + 0.999999);
+      return values[std::min(values.size(), std::max<size_t>(index, 1)) - 1];
+    };
+
+    double sum = 0;
+    for (double value : values) {
+      sum += value;
+    }
+
+    result.count = values.size();
+    result.mean = sum / values.size();
+    result.p50 = rank(0.50);
+    result.p95 = rank(0.95);
+    result.p99 = rank(0.99);
+    result.max = values.back();
+    return result;
+  }
+
+  // Per-image latencies of every stage, keyed by stage. A stage only has samples for the images it ran on.
+  std::map<std::string, std::vector<double>> stageSamples(const std::vector<Sample>& samples) {
+    std::map<std::string, std::vector<double>> stages;
+    for (const Sample& sample : samples) {
+      stages["decode"].push_back(sample.decodeMs);
+      stages["recognize"].push_back(sample.recognizeMs);
+      stages["total"].push_back(sample.totalMs);
+      for (const StageTiming& timing : sample.stages) {
+        stages[timing.stage].push_back(timing.ms);
+      }
+    }
+    return stages;
+  }
+
+  std::vector<std::string> orderedStages(const std::map<std::string, std::vector<double>>& stages) {
+    std::vector<std::string> order;
+    for (const char* stage : kStageOrder) {
+      if (stages.count(stage)) {
+        order.push_back(stage);
+      }
+    }
+    for (const auto& stage : stages) {
+      if (std::find(order.begin(), order.end(), stage.first) == order.end()) {
+        order.insert(order.end() - 2, stage.first);  // Before recognize and total
+      }
+    }
+    return order;
+  }
+
+  void writeJson(std::FILE* out, const Options& options, size_t inputCount, const std::vector<Sample>& samples,
+                 double wallMs, double engineLoadMs) {
+    size_t plates = 0;
+    for (const Sample& sample : samples) {
+      plates += sample.plates;
+    }
+
+    std::map<std::string, std::vector<double>> stages = stageSamples(samples);
+
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"timestamp\": %lld,\n", static_cast<long long>(std::time(nullptr)));
+    std::fprintf(out, "  \"openalprVersion\": \"%s\",\n", alpr::AlprImpl::getVersion().c_str());
+    std::fprintf(out, "  \"country\": \"%s\",\n", options.country.c_str());
+    std::fprintf(out, "  \"threads\": %d,\n", options.threads);
+    std::fprintf(out, "  \"iterations\": %d,\n", options.iterations);
+    std::fprintf(out, "  \"inputs\": %zu,\n", inputCount);
+    std::fprintf(out, "  \"samples\": %zu,\n", samples.size());
+    std::fprintf(out, "  \"platesFound\": %zu,\n", plates);
+    std::fprintf(out, "  \"engineLoadMs\": %.3f,\n", engineLoadMs);
+    std::fprintf(out, "  \"wallMs\": %.3f,\n", wallMs);
+    std::fprintf(out, "  \"imagesPerSecond\": %.3f,\n", wallMs > 0 ? samples.size() * 1000.0 / wallMs : 0.0);
+    std::fprintf(out, "  \"stages\": {");
+
+    const char* separator = "\n";
+    for (const std::string& stage : orderedStages(stages)) {
+      Percentiles p = percentiles(stages[stage]);
+      std::fprintf(out, "%s    \"%s\": { \"count\": %zu, \"mean\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f }",
+                   separator, stage.c_str(), p.count, p.mean, p.p50, p.p95, p.p99, p.max);
+      separator = ",\n";
+    }
+
+    std::fprintf(out, "\n  }\n}\n");
+  }
+
+  void printTable(std::FILE* out, const std::vector<Sample>& samples, double wallMs) {
+    std::map<std::string, std::vector<double>> stages = stageSamples(samples);
+
+    std::fprintf(out, "%-20s %8s %10s %10s %10s %10s\n", "stage", "count", "mean ms", "p50 ms", "p95 ms", "p99 ms");
+    for (const std::string& stage : orderedStages(stages)) {
+      Percentiles p = percentiles(stages[stage]);
+      std::fprintf(out, "%-20s %8zu %10.3f %10.3f %10.3f %10.3f\n", stage.c_str(), p.count, p.mean, p.p50, p.p95, p.p99);
+    }
+
+    std::fprintf(out, "\n%zu images in %.1f ms: %.2f images/s\n", samples.size(), wallMs,
+                wallMs > 0 ? samples.size() * 1000.0 / wallMs : 0.0);
+  }
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage();
+    return 2;
+  }
+
+  std::vector<Input> inputs = loadInputs(options);
+  if (inputs.empty()) {
+    std::fprintf(stderr, "No images or raw planes in %s\n", options.inputDir.c_str());
+    return 1;
+  }
+
+  const size_t jobCount = inputs.size() * options.iterations;
+  std::atomic<size_t> nextJob{0};
+  std::atomic<bool> loadFailed{false};
+  std::vector<std::vector<Sample>> threadSamples(options.threads);
+  std::vector<double> loadMs(options.threads, 0);
+
+  // Timing starts once every engine is loaded and warmed up
+  std::mutex readyMutex;
+  std::condition_variable readyChanged;
+  int ready = 0;
+  bool started = false;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < options.threads; ++t) {
+    threads.emplace_back([&, t]() {
+      auto loadStart = std::chrono::steady_clock::now();
+      alpr::AlprImpl engine(options.country, options.configFile, options.runtimeDir);
+      loadMs[t] = elapsedMs(loadStart);
+
+      if (!engine.isLoaded()) {
+        loadFailed = true;
+      } else {
+        engine.config->debugTiming = true;
+        for (int i = 0; i < options.warmup; ++i) {
+          recognizeInput(engine, inputs[i % inputs.size()]);
+        }
+      }
+
+      {
+        std::unique_lock<std::mutex> lock(readyMutex);
+        ++ready;
+        readyChanged.notify_all();
+        readyChanged.wait(lock, [&started]() { return started; });
+      }
+
+      if (loadFailed) {
+        return;
+      }
+
+      for (size_t job = nextJob++; job < jobCount; job = nextJob++) {
+        threadSamples[t].push_back(recognizeInput(engine, inputs[job % inputs.size()]));
+      }
+    });
+  }
+
+  std::chrono::steady_clock::time_point wallStart;
+  {
+    std::unique_lock<std::mutex> lock(readyMutex);
+    readyChanged.wait(lock, [&]() { return ready == options.threads; });
+    started = true;
+    wallStart = std::chrono::steady_clock::now();
+    readyChanged.notify_all();
+  }
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  const double wallMs = elapsedMs(wallStart);
+
+  if (loadFailed) {
+    std::fprintf(stderr, "Error loading OpenALPR for country %s\n", options.country.c_str());
+    return 1;
+  }
+
+  std::vector<Sample> samples;
+  for (std::vector<Sample>& perThread : threadSamples) {
+    samples.insert(samples.end(), perThread.begin(), perThread.end());
+  }
+
+  double engineLoadMs = 0;
+  for (double ms : loadMs) {
+    engineLoadMs += ms / options.threads;
+  }
+
+  // Keep stdout clean for the JSON report when it goes there
+  printTable(options.jsonPath == "-" ? stderr : stdout, samples, wallMs);
+
+  if (!options.jsonPath.empty()) {
+    std::FILE* out = options.jsonPath == "-" ? stdout : std::fopen(options.jsonPath.c_str(), "w");
+    if (!out) {
+      std::fprintf(stderr, "Cannot write %s\n", options.jsonPath.c_str());
+      return 1;
+    }
+
+    writeJson(out, options, inputs.size(), samples, wallMs, engineLoadMs);
+    if (out != stdout) {
+      std::fclose(out);
+    }
+  }
+
+  return 0;
+}
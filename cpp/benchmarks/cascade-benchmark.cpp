@@ -0,0 +1,177 @@
+// Plate cascade detection: cv::CascadeClassifier against the plugin's own LBP cascade scan, with the scalar and
+// vectorized evaluators, serial and parallel.
+//
+//   cmake -S cpp -B build/host -DANPR_HOST_PREFIX=/opt/anpr-host && cmake --build build/host --target cascade-benchmark
+//   ./build/host/benchmarks/cascade-benchmark runtime_data/region/us.xml <image dir> [--scale 1.1] [--neighbors 3] [--iterations 5]
+//
+// Every image is equalized as DetectorCPU does, and each scan's plates are checked against cv::CascadeClassifier
+// before it is timed. Exits with 1 if any of them differ.
+
+#include "cascade-detector.h"
+#include "opencv2/core.hpp"
+#include "opencv2/imgcodecs.hpp"
+#include "opencv2/imgproc.hpp"
+#include "opencv2/objdetect.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace visioncamerapluginanpr;
+
+namespace {
+  struct Options {
+    std::string cascadePath;
+    std::string inputDir;
+    double scaleFactor = 1.1;
+    int minNeighbors = 3;
+    int iterations = 5;
+  };
+
+  struct Variant {
+    const char* name;
+    std::function<std::vector<cv::Rect>(const cv::Mat&)> detect;
+    double totalMs = 0;
+    int mismatches = 0;
+  };
+
+  void printUsage() {
+    std::fprintf(stderr,
+      "usage: cascade-benchmark <cascade.xml> <image dir> [--scale 1.1] [--neighbors 3] [--iterations 5]\n");
+  }
+
+  bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      bool hasValue = i + 1 < argc;
+
+      if (arg[0] != '-' && options.cascadePath.empty()) {
+        options.cascadePath = arg;
+      } else if (arg[0] != '-' && options.inputDir.empty()) {
+        options.inputDir = arg;
+      } else if (arg == "--scale" && hasValue) {
+        options.scaleFactor = std::atof(argv[++i]);
+      } else if (arg == "--neighbors" && hasValue) {
+        options.minNeighbors = std::max(0, std::atoi(argv[++i]));
+      } else if (arg == "--iterations" && hasValue) {
+        options.iterations = std::max(1, std::atoi(argv[++i]));
+      } else {
+        return false;
+      }
+    }
+
+    return !options.cascadePath.empty() && !options.inputDir.empty() && options.scaleFactor > 1;
+  }
+
+  std::vector<cv::Mat> loadImages(const std::string& directory) {
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+      if (entry.is_regular_file()) {
+        paths.push_back(entry.path());
+      }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<cv::Mat> images;
+    for (const auto& path : paths) {
+      cv::Mat gray = cv::imread(path.string(), cv::IMREAD_GRAYSCALE);
+      if (!gray.empty()) {
+        cv::equalizeHist(gray, gray);
+        images.push_back(gray);
+      }
+    }
+    return images;
+  }
+
+  bool samePlates(std::vector<cv::Rect> a, std::vector<cv::Rect> b) {
+    auto byPosition = [](const cv::Rect& l, const cv::Rect& r) {
+      return std::tie(l.y, l.x, l.height, l.width) < std::tie(r.y, r.x, r.height, r.width);
+    };
+    std::sort(a.begin(), a.end(), byPosition);
+    std::sort(b.begin(), b.end(), byPosition);
+    return a == b;
+  }
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage();
+    return 2;
+  }
+
+  cv::CascadeClassifier classifier;
+  if (!classifier.load(options.cascadePath)) {
+    std::fprintf(stderr, "Unable to load %s\n", options.cascadePath.c_str());
+    return 1;
+  }
+  const LbpCascade cascade = readLbpCascadeXml(options.cascadePath);
+
+  const std::vector<cv::Mat> images = loadImages(options.inputDir);
+  if (images.empty()) {
+    std::fprintf(stderr, "No images in %s\n", options.inputDir.c_str());
+    return 1;
+  }
+
+  LbpScanBuffers buffers;
+  std::vector<Variant> variants = {
+    { "opencv", [&](const cv::Mat& gray) {
+      std::vector<cv::Rect> plates;
+      classifier.detectMultiScale(gray, plates, options.scaleFactor, options.minNeighbors);
+      return plates;
+    } },
+    { "serial", [&](const cv::Mat& gray) {
+      return detectLbpCascade(cascade, gray, options.scaleFactor, options.minNeighbors, cv::Size(), cv::Size(), buffers,
+                              LbpEvaluator::Scalar, false);
+    } },
+    { "parallel", [&](const cv::Mat& gray) {
+      return detectLbpCascade(cascade, gray, options.scaleFactor, options.minNeighbors, cv::Size(), cv::Size(), buffers,
+                              LbpEvaluator::Scalar, true);
+    } },
+    { "vector", [&](const cv::Mat& gray) {
+      return detectLbpCascade(cascade, gray, options.scaleFactor, options.minNeighbors, cv::Size(), cv::Size(), buffers,
+                              LbpEvaluator::Vector, false);
+    } },
+    { "vector-par", [&](const cv::Mat& gray) {
+      return detectLbpCascade(cascade, gray, options.scaleFactor, options.minNeighbors, cv::Size(), cv::Size(), buffers,
+                              LbpEvaluator::Vector, true);
+    } }
+  };
+
+  for (const cv::Mat& gray : images) {
+    const std::vector<cv::Rect> expected = variants[0].detect(gray);
+    for (size_t v = 1; v < variants.size(); ++v) {
+      if (!samePlates(variants[v].detect(gray), expected)) {
+        ++variants[v].mismatches;
+      }
+    }
+  }
+
+  for (int iteration = 0; iteration < options.iterations; ++iteration) {
+    for (Variant& variant : variants) {
+      for (const cv::Mat& gray : images) {
+        const auto start = std::chrono::steady_clock::now();
+        variant.detect(gray);
+        variant.totalMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      }
+    }
+  }
+
+  const size_t runs = images.size() * options.iterations;
+  std::printf("%zu images, %d threads\n", images.size(), cv::getNumThreads());
+  std::printf("%-10s %10s %10s %10s\n", "variant", "mean ms", "speedup", "mismatches");
+  int mismatches = 0;
+  for (const Variant& variant : variants) {
+    std::printf("%-10s %10.2f %9.2fx %10d\n", variant.name, variant.totalMs / runs, variants[0].totalMs / variant.totalMs,
+                variant.mismatches);
+    mismatches += variant.mismatches;
+  }
+
+  return mismatches > 0 ? 1 : 0;
+}
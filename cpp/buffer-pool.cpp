@@ -0,0 +1,117 @@
+#include "buffer-pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace visioncamerapluginanpr {
+  BufferPool::Buffer::Buffer(Buffer&& other) noexcept : pool(other.pool), ptr(other.ptr), capacity(other.capacity) {
+    other.pool = nullptr;
+    other.ptr = nullptr;
+    other.capacity = 0;
+  }
+
+  BufferPool::Buffer& BufferPool::Buffer::operator=(Buffer&& other) noexcept {
+    if (this != &other) {
+      if (ptr) {
+        pool->release(ptr, capacity);
+      }
+
+      pool = other.pool;
+      ptr = other.ptr;
+      capacity = other.capacity;
+
+      other.pool = nullptr;
+      other.ptr = nullptr;
+      other.capacity = 0;
+    }
+    return *this;
+  }
+
+  BufferPool::Buffer::~Buffer() {
+    if (ptr) {
+      pool->release(ptr, capacity);
+    }
+  }
+
+  BufferPool::BufferPool(size_t maxCachedBytes)
+    : maxCachedBytes(maxCachedBytes), bytesInUse(0), bytesCached(0), highWaterMark(0), allocations(0), reuses(0) {}
+
+  BufferPool::~BufferPool() {
+    trim();
+  }
+
+  BufferPool::Buffer BufferPool::acquire(size_t size) {
+    const size_t capacity = std::max<size_t>(1, (size + kGranularity - 1) / kGranularity) * kGranularity;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto bucket = idleBuffers.find(capacity);
+
+      if (bucket != idleBuffers.end() && !bucket->second.empty()) {
+        uint8_t* ptr = bucket->second.back();
+        bucket->second.pop_back();
+
+        bytesCached -= capacity;
+        bytesInUse += capacity;
+        ++reuses;
+        return Buffer(this, ptr, capacity);
+      }
+    }
+
+    // Allocate outside the lock; a miss is the slow path anyway
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, kAlignment, capacity) != 0) {
+      throw std::bad_alloc();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    bytesInUse += capacity;
+    highWaterMark = std::max(highWaterMark, bytesInUse + bytesCached);
+    ++allocations;
+    return Buffer(this, static_cast<uint8_t*>(ptr), capacity);
+  }
+
+  void BufferPool::release(uint8_t* ptr, size_t capacity) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      bytesInUse -= capacity;
+
+      if (bytesCached + capacity <= maxCachedBytes) {
+        idleBuffers[capacity].push_back(ptr);
+        bytesCached += capacity;
+        return;
+      }
+    }
+
+    free(ptr);
+  }
+
+  void BufferPool::trim() {
+    std::unordered_map<size_t, std::vector<uint8_t*>> released;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      released.swap(idleBuffers);
+      bytesCached = 0;
+    }
+
+    for (auto& bucket : released) {
+      for (uint8_t* ptr : bucket.second) {
+        free(ptr);
+      }
+    }
+  }
+
+  BufferPoolStats BufferPool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return BufferPoolStats{ bytesInUse, bytesCached, highWaterMark, allocations, reuses };
+  }
+
+  void BufferPool::resetStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    highWaterMark = bytesInUse + bytesCached;
+    allocations = 0;
+    reuses = 0;
+  }
+}
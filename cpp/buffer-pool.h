@@ -0,0 +1,87 @@
+#ifndef VISIONCAMERAPLUGINANPR_BUFFERPOOL_H
+#define VISIONCAMERAPLUGINANPR_BUFFERPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace visioncamerapluginanpr {
+  struct BufferPoolStats {
+    // Bytes currently handed out to callers
+    size_t bytesInUse;
+    // Bytes held idle, ready to be reused
+    size_t bytesCached;
+    // Peak of bytesInUse + bytesCached since the pool was created or last reset
+    size_t highWaterMark;
+    // Buffers that had to be allocated, versus ones served from the cache
+    uint64_t allocations;
+    uint64_t reuses;
+  };
+
+  // Size-keyed pool of aligned scratch buffers for per-frame work (rotation, downscaling, crops).
+  // Requests are rounded up to whole pages, so frames of the same size always hit the same bucket.
+  class BufferPool {
+    public:
+      static const size_t kAlignment = 64;
+      static const size_t kGranularity = 4096;
+
+      // Move-only lease on a pooled buffer. The buffer returns to the pool when the lease is destroyed,
+      // so the pool must outlive every lease it hands out.
+      class Buffer {
+        public:
+          Buffer() : pool(nullptr), ptr(nullptr), capacity(0) {}
+          Buffer(Buffer&& other) noexcept;
+          Buffer& operator=(Buffer&& other) noexcept;
+          ~Buffer();
+
+          Buffer(const Buffer&) = delete;
+          Buffer& operator=(const Buffer&) = delete;
+
+          uint8_t* data() const { return ptr; }
+          size_t size() const { return capacity; }
+          explicit operator bool() const { return ptr != nullptr; }
+
+        private:
+          friend class BufferPool;
+          Buffer(BufferPool* pool, uint8_t* ptr, size_t capacity) : pool(pool), ptr(ptr), capacity(capacity) {}
+
+          BufferPool* pool;
+          uint8_t* ptr;
+          size_t capacity;
+      };
+
+      // Idle buffers beyond maxCachedBytes are freed rather than cached
+      explicit BufferPool(size_t maxCachedBytes = 64 * 1024 * 1024);
+      ~BufferPool();
+
+      BufferPool(const BufferPool&) = delete;
+      BufferPool& operator=(const BufferPool&) = delete;
+
+      // Returns a buffer of at least `size` bytes, aligned to kAlignment
+      Buffer acquire(size_t size);
+
+      // Frees every idle buffer
+      void trim();
+
+      BufferPoolStats stats() const;
+
+      // Restarts the high-water mark and counters from the current footprint
+      void resetStats();
+
+    private:
+      void release(uint8_t* ptr, size_t capacity);
+
+      mutable std::mutex mutex;
+      std::unordered_map<size_t, std::vector<uint8_t*>> idleBuffers;
+      size_t maxCachedBytes;
+      size_t bytesInUse;
+      size_t bytesCached;
+      size_t highWaterMark;
+      uint64_t allocations;
+      uint64_t reuses;
+  };
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_BUFFERPOOL_H */
@@ -0,0 +1,369 @@
+#include "cascade-detector.h"
+#include "lbp-vector-evaluator.h"
+#include "logging.h"
+#include "config.h"
+#include "detection/detectorfactory.h"
+#include "opencv2/core/utility.hpp"
+#include "opencv2/imgproc.hpp"
+#include "opencv2/objdetect.hpp"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+
+namespace visioncamerapluginanpr {
+  // Subtracted from every stage threshold by cv::CascadeClassifier when it reads a cascade
+  static const float kThresholdEps = 1e-5f;
+  // cv::groupRectangles eps used by detectMultiScale
+  static const double kGroupEps = 0.2;
+
+  LbpCascade readLbpCascadeXml(const std::string& path) {
+    cv::FileStorage storage(path, cv::FileStorage::READ);
+    if (!storage.isOpened()) {
+      throw std::runtime_error("Unable to open cascade " + path);
+    }
+
+    const cv::FileNode root = storage["cascade"];
+    if (root.empty() || static_cast<std::string>(root["stageType"]) != "BOOST" ||
+        static_cast<std::string>(root["featureType"]) != "LBP") {
+      throw std::runtime_error("Cascade " + path + " is not a boosted LBP cascade");
+    }
+    if (static_cast<int>(root["featureParams"]["maxCatCount"]) != 256) {
+      throw std::runtime_error("Cascade " + path + " does not use 8-bit LBP codes");
+    }
+
+    LbpCascade cascade;
+    cascade.windowWidth = static_cast<int>(root["width"]);
+    cascade.windowHeight = static_cast<int>(root["height"]);
+
+    for (const cv::FileNode& stageNode : root["stages"]) {
+      LbpCascade::Stage stage;
+      stage.threshold = static_cast<float>(stageNode["stageThreshold"]) - kThresholdEps;
+      stage.firstWeak = static_cast<uint32_t>(cascade.weaks.size());
+
+      for (const cv::FileNode& weakNode : stageNode["weakClassifiers"]) {
+        std::vector<int> internalNodes;
+        std::vector<float> leafValues;
+        weakNode["internalNodes"] >> internalNodes;
+        weakNode["leafValues"] >> leafValues;
+        // left, right, feature index and the 8 words of the category subset of a single split
+        if (internalNodes.size() != 11 || leafValues.size() != 2) {
+          throw std::runtime_error("Cascade " + path + " has weak classifiers that are not stumps");
+        }
+
+        LbpCascade::Weak weak;
+        weak.feature = static_cast<uint32_t>(internalNodes[2]);
+        for (size_t i = 0; i < weak.subset.size(); ++i) {
+          weak.subset[i] = static_cast<uint32_t>(internalNodes[3 + i]);
+        }
+        weak.leaves = { leafValues[0], leafValues[1] };
+        cascade.weaks.push_back(weak);
+      }
+
+      stage.weakCount = static_cast<uint32_t>(cascade.weaks.size()) - stage.firstWeak;
+      cascade.stages.push_back(stage);
+    }
+
+    for (const cv::FileNode& featureNode : root["features"]) {
+      std::vector<int> rect;
+      featureNode["rect"] >> rect;
+      if (rect.size() != 4) {
+        throw std::runtime_error("Cascade " + path + " has a malformed feature");
+      }
+      cascade.features.push_back({ rect[0], rect[1], rect[2], rect[3] });
+    }
+
+    // Validated the same way as a packed cascade, so both loaders accept exactly the same cascades
+    const std::vector<uint8_t> packed = serializeLbpCascade(cascade);
+    return parseLbpCascade(packed.data(), packed.size());
+  }
+
+  std::string packedCascadePath(const std::string& xmlPath) {
+    static const std::string kXml = ".xml";
+    if (xmlPath.size() >= kXml.size() && xmlPath.compare(xmlPath.size() - kXml.size(), kXml.size(), kXml) == 0) {
+      return xmlPath.substr(0, xmlPath.size() - kXml.size()) + ".lbpc";
+    }
+    return xmlPath + ".lbpc";
+  }
+
+  // A packed file older than its XML was written for an earlier version of the cascade
+  static bool packedIsCurrent(const std::string& packedPath, const std::string& xmlPath) {
+    struct stat packed;
+    struct stat xml;
+    if (stat(packedPath.c_str(), &packed) != 0) {
+      return false;
+    }
+    return stat(xmlPath.c_str(), &xml) != 0 || packed.st_mtime >= xml.st_mtime;
+  }
+
+  // Writes the packed form beside the XML, through a temporary file so a reader never sees half of it. Failing to
+  // write, e.g. to a read-only directory, only means the XML is parsed again next time.
+  static void writePackedCascade(const std::string& packedPath, const LbpCascade& cascade) {
+    const std::vector<uint8_t> packed = serializeLbpCascade(cascade);
+    const std::string partialPath = packedPath + ".partial";
+    {
+      std::ofstream file(partialPath, std::ios::binary | std::ios::trunc);
+      file.write(reinterpret_cast<const char*>(packed.data()), static_cast<std::streamsize>(packed.size()));
+      if (!file) {
+        LOGI("Unable to write packed cascade %s", packedPath.c_str());
+        std::remove(partialPath.c_str());
+        return;
+      }
+    }
+
+    if (std::rename(partialPath.c_str(), packedPath.c_str()) != 0) {
+      LOGI("Unable to write packed cascade %s", packedPath.c_str());
+      std::remove(partialPath.c_str());
+    }
+  }
+
+  static std::shared_ptr<const LbpCascade> loadLbpCascade(const std::string& xmlPath) {
+    const std::string packedPath = packedCascadePath(xmlPath);
+    std::ifstream packedFile;
+    if (packedIsCurrent(packedPath, xmlPath)) {
+      packedFile.open(packedPath, std::ios::binary);
+    }
+    if (packedFile) {
+      const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(packedFile)), std::istreambuf_iterator<char>());
+      try {
+        return std::make_shared<const LbpCascade>(parseLbpCascade(bytes.data(), bytes.size()));
+      } catch (const std::exception& e) {
+        LOGE("Ignoring packed cascade %s: %s", packedPath.c_str(), e.what());
+      }
+    }
+
+    std::shared_ptr<const LbpCascade> cascade;
+    try {
+      cascade = std::make_shared<const LbpCascade>(readLbpCascadeXml(xmlPath));
+    } catch (const std::exception& e) {
+      LOGE("Unable to load cascade: %s", e.what());
+      return nullptr;
+    }
+
+    // Later loads, in this process and the next, read it back instead of parsing the XML
+    writePackedCascade(packedPath, *cascade);
+    return cascade;
+  }
+
+  std::shared_ptr<const LbpCascade> loadSharedLbpCascade(const std::string& xmlPath) {
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<const LbpCascade>> loaded;
+
+    // Held while loading, so engines built at the same time wait for one load instead of each doing their own
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const LbpCascade> cascade = loaded[xmlPath].lock();
+    if (!cascade) {
+      cascade = loadLbpCascade(xmlPath);
+      if (cascade) {
+        loaded[xmlPath] = cascade;
+      } else {
+        loaded.erase(xmlPath);
+      }
+    }
+    return cascade;
+  }
+
+  // Scale factors of the cascade window searched by detectMultiScale, smallest first
+  static std::vector<float> searchScales(const LbpCascade& cascade, const cv::Size& imageSize, double scaleFactor,
+                                         const cv::Size& minSize, cv::Size maxSize) {
+    std::vector<float> scales;
+    if (maxSize.width == 0 || maxSize.height == 0) {
+      maxSize = imageSize;
+    }
+    if (imageSize.width < cascade.windowWidth || imageSize.height < cascade.windowHeight) {
+      return scales;
+    }
+
+    // Accumulated in double but compared as float, as OpenCV does, so the windows tried are the same ones
+    for (double factor = 1; ; factor *= scaleFactor) {
+      if (cvRound(cascade.windowWidth * factor) > imageSize.width || cvRound(cascade.windowHeight * factor) > imageSize.height) {
+        break;
+      }
+
+      const float scale = static_cast<float>(factor);
+      const cv::Size window(cvRound(cascade.windowWidth * scale), cvRound(cascade.windowHeight * scale));
+      if (window.width > maxSize.width || window.height > maxSize.height) {
+        break;
+      }
+      if (window.width >= minSize.width && window.height >= minSize.height) {
+        scales.push_back(scale);
+      }
+    }
+    return scales;
+  }
+
+  std::unique_ptr<LbpScanBuffers::Planes> LbpScanBuffers::acquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (idle.empty()) {
+      return std::make_unique<Planes>();
+    }
+
+    std::unique_ptr<Planes> planes = std::move(idle.back());
+    idle.pop_back();
+    return planes;
+  }
+
+  void LbpScanBuffers::release(std::unique_ptr<Planes> planes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    idle.push_back(std::move(planes));
+  }
+
+  // What every scale of one scan shares. All scales use the same integral image row step, wide enough for the
+  // largest scale plus the vector evaluator's padding, so the cascade is laid out for it only once.
+  struct ScanContext {
+    const LbpCascade& cascade;
+    size_t integralStep;
+    std::vector<LbpFeatureOffsets> offsets;
+    std::unique_ptr<LbpVectorEvaluator> vectorEvaluator;
+  };
+
+  // Integral image of `scaled` in `planes`, with ScanContext::integralStep elements per row
+  static cv::Mat integralOf(const cv::Mat& scaled, const cv::Size& graySize, size_t integralStep, LbpScanBuffers::Planes& planes) {
+    const cv::Size storageSize(static_cast<int>(integralStep), graySize.height + 1);
+    if (planes.integral.size() != storageSize) {
+      planes.integral.create(storageSize, CV_32S);
+      // Only ever read by lanes past the end of a row, whose results are dropped
+      planes.integral.setTo(0);
+    }
+
+    // cv::integral writes straight into a destination that already has the right size and type
+    cv::Mat integral = planes.integral(cv::Rect(0, 0, scaled.cols + 1, scaled.rows + 1));
+    cv::integral(scaled, integral, CV_32S);
+    return integral;
+  }
+
+  // Slides the cascade window over the image reduced by `scale`, appending every accepted window in image coordinates
+  static void scanScale(const ScanContext& context, const cv::Mat& gray, float scale, LbpScanBuffers::Planes& planes,
+                        std::vector<cv::Rect>& found) {
+    const LbpCascade& cascade = context.cascade;
+    const cv::Size scaledSize(cvRound(gray.cols / scale), cvRound(gray.rows / scale));
+    cv::resize(gray, planes.scaled, scaledSize, 0, 0, cv::INTER_LINEAR_EXACT);
+    const cv::Mat integral = integralOf(planes.scaled, gray.size(), context.integralStep, planes);
+
+    const cv::Size window(cvRound(cascade.windowWidth * scale), cvRound(cascade.windowHeight * scale));
+    const int workingWidth = std::max(scaledSize.width + 1 - cascade.windowWidth, 0);
+    const int workingHeight = std::max(scaledSize.height + 1 - cascade.windowHeight, 0);
+    const int step = scale >= 2 ? 1 : 2;
+
+    for (int y = 0; y < workingHeight; y += step) {
+      const int* row = integral.ptr<int>(y);
+      if (context.vectorEvaluator) {
+        // Lanes are the windows at x, x + step, ..., but the serial walk below still decides which of them count, so
+        // a window it would skip after a first-stage rejection is skipped here too
+        for (int x = 0; x < workingWidth; ) {
+          int results[LbpVectorEvaluator::kLanes];
+          context.vectorEvaluator->evaluate(row + x, step, results);
+
+          int lane = 0;
+          while (lane < LbpVectorEvaluator::kLanes && x + lane * step < workingWidth) {
+            if (results[lane] > 0) {
+              found.push_back(cv::Rect(cvRound((x + lane * step) * scale), cvRound(y * scale), window.width, window.height));
+            }
+            lane += results[lane] == 0 ? 2 : 1;
+          }
+          x += lane * step;
+        }
+        continue;
+      }
+
+      for (int x = 0; x < workingWidth; x += step) {
+        const int result = evaluateLbpCascade(cascade, context.offsets, row + x);
+        if (result > 0) {
+          found.push_back(cv::Rect(cvRound(x * scale), cvRound(y * scale), window.width, window.height));
+        } else if (result == 0) {
+          // Rejected by the very first stage, so the next window along is very likely to be too
+          x += step;
+        }
+      }
+    }
+  }
+
+  std::vector<cv::Rect> detectLbpCascade(const LbpCascade& cascade, const cv::Mat& gray, double scaleFactor, int minNeighbors,
+                                         cv::Size minSize, cv::Size maxSize, LbpScanBuffers& buffers, LbpEvaluator evaluator,
+                                         bool parallel, int maxThreads) {
+    CV_Assert(gray.type() == CV_8UC1 && scaleFactor > 1);
+
+    const std::vector<float> scales = searchScales(cascade, gray.size(), scaleFactor, minSize, maxSize);
+    if (scales.empty()) {
+      return {};
+    }
+
+    ScanContext context{ cascade, static_cast<size_t>(gray.cols + 1 + LbpVectorEvaluator::kPadding), {}, nullptr };
+    if (evaluator == LbpEvaluator::Vector) {
+      context.vectorEvaluator = std::make_unique<LbpVectorEvaluator>(cascade, context.integralStep);
+    } else {
+      context.offsets = lbpFeatureOffsets(cascade, context.integralStep);
+    }
+
+    std::vector<std::vector<cv::Rect>> foundPerScale(scales.size());
+    auto scan = [&](const cv::Range& range) {
+      std::unique_ptr<LbpScanBuffers::Planes> planes = buffers.acquire();
+      for (int i = range.start; i < range.end; ++i) {
+        scanScale(context, gray, scales[i], *planes, foundPerScale[i]);
+      }
+      buffers.release(std::move(planes));
+    };
+
+    const cv::Range all(0, static_cast<int>(scales.size()));
+    const int stripes = maxThreads > 0 ? std::min(maxThreads, all.end) : all.end;
+    if (parallel && stripes > 1) {
+      // One stripe per scale, or per run of scales when capped; the largest scales cost the most and are handed out first
+      cv::parallel_for_(all, scan, static_cast<double>(stripes));
+    } else {
+      scan(all);
+    }
+
+    // groupRectangles depends on the order it is given windows in, so they are merged in the serial scan's order
+    std::vector<cv::Rect> found;
+    for (const std::vector<cv::Rect>& scaleFound : foundPerScale) {
+      found.insert(found.end(), scaleFound.begin(), scaleFound.end());
+    }
+
+    cv::groupRectangles(found, minNeighbors, kGroupEps);
+    return found;
+  }
+
+  SharedCascadeDetector::SharedCascadeDetector(alpr::Config* config, alpr::PreWarp* prewarp, LbpEvaluator evaluator,
+                                               int scanThreads)
+    : alpr::Detector(config, prewarp), evaluator(evaluator), scanThreads(scanThreads) {
+    cascade = loadSharedLbpCascade(get_detector_file());
+    loaded = cascade != nullptr;
+  }
+
+  std::vector<cv::Rect> SharedCascadeDetector::find_plates(cv::Mat frame, cv::Size min_plate_size, cv::Size max_plate_size) {
+    const auto start = std::chrono::steady_clock::now();
+
+    cv::equalizeHist(frame, equalized);
+    std::vector<cv::Rect> plates = detectLbpCascade(*cascade, equalized, config->detection_iteration_increase,
+                                                    config->detectionStrictness, min_plate_size, max_plate_size, buffers, evaluator,
+                                                    scanThreads != 1, scanThreads);
+
+    // Printed like DetectorCPU's, so StageTimingCapture still records detection
+    if (config->debugTiming) {
+      const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      std::cout << "LBP Time: " << ms << "ms." << std::endl;
+    }
+
+    return plates;
+  }
+
+  std::unique_ptr<alpr::Detector> createPlateDetector(alpr::Config* config, alpr::PreWarp* prewarp, PlateDetectorType type,
+                                                      int scanThreads) {
+    if (type != PlateDetectorType::OpenAlpr && config->detector == alpr::DETECTOR_LBP_CPU) {
+      const LbpEvaluator evaluator = type == PlateDetectorType::VectorCascade ? LbpEvaluator::Vector : LbpEvaluator::Scalar;
+      std::unique_ptr<alpr::Detector> detector = std::make_unique<SharedCascadeDetector>(config, prewarp, evaluator, scanThreads);
+      if (detector->isLoaded()) {
+        return detector;
+      }
+    }
+
+    return std::unique_ptr<alpr::Detector>(alpr::createDetector(config, prewarp));
+  }
+}
@@ -0,0 +1,99 @@
+#ifndef VISIONCAMERAPLUGINANPR_CASCADEDETECTOR_H
+#define VISIONCAMERAPLUGINANPR_CASCADEDETECTOR_H
+
+#include "lbp-cascade.h"
+#include "detection/detector.h"
+#include "opencv2/core.hpp"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace visioncamerapluginanpr {
+  // Reads a cascade XML written by opencv_traincascade. Throws std::runtime_error unless it is an LBP cascade of
+  // decision stumps, which every cascade in runtime_data/region is.
+  LbpCascade readLbpCascadeXml(const std::string& path);
+
+  // Where the packed form of a cascade XML is kept, next to it: "us.xml" -> "us.lbpc"
+  std::string packedCascadePath(const std::string& xmlPath);
+
+  // The cascade of a detector file, loaded once and shared by every detector that uses it for as long as any of
+  // them is alive. The packed file beside the XML is read when there is a valid one at least as new as the XML;
+  // otherwise the XML itself is, and its packed form is written for next time. Returns nullptr, after logging why,
+  // if neither can be loaded.
+  std::shared_ptr<const LbpCascade> loadSharedLbpCascade(const std::string& xmlPath);
+
+  // Planes reused from one scan to the next. Scales scanned at the same time each lease their own pair, so a
+  // worker that picks up another scale while it waits inside OpenCV never shares planes with itself.
+  class LbpScanBuffers {
+    public:
+      struct Planes {
+        cv::Mat scaled;
+        cv::Mat integral;
+      };
+
+      std::unique_ptr<Planes> acquire();
+      void release(std::unique_ptr<Planes> planes);
+
+    private:
+      std::mutex mutex;
+      std::vector<std::unique_ptr<Planes>> idle;
+  };
+
+  // How a scan evaluates the cascade on each window. Both give the same result for every window.
+  enum class LbpEvaluator {
+    // One window at a time, with evaluateLbpCascade
+    Scalar,
+    // LbpVectorEvaluator::kLanes windows of a row at a time, with LbpVectorEvaluator
+    Vector
+  };
+
+  // Finds objects in a grayscale image the way cv::CascadeClassifier::detectMultiScale does for an LBP cascade:
+  // the same scales, window positions and grouping, so the same rectangles come back. An empty `maxSize` allows
+  // objects as large as the image.
+  //
+  // With `parallel`, the scales of the pyramid are scanned as work items on OpenCV's thread pool: one per scale, or
+  // at most `maxThreads` runs of neighbouring scales if it is set, so that no more threads than that scan at once.
+  // Windows are still grouped in scale order, so the result is identical to a serial scan.
+  std::vector<cv::Rect> detectLbpCascade(const LbpCascade& cascade, const cv::Mat& gray, double scaleFactor, int minNeighbors,
+                                         cv::Size minSize, cv::Size maxSize, LbpScanBuffers& buffers,
+                                         LbpEvaluator evaluator = LbpEvaluator::Scalar, bool parallel = true, int maxThreads = 0);
+
+  // Stands in for OpenALPR's DetectorCPU, which parses the cascade XML again for every detector it builds. Finds
+  // the same plates, using the cascade shared through loadSharedLbpCascade, so building one is cheap. Each scan uses at
+  // most `scanThreads` of OpenCV's threads, or all of them if it is 0.
+  class SharedCascadeDetector : public alpr::Detector {
+    public:
+      SharedCascadeDetector(alpr::Config* config, alpr::PreWarp* prewarp, LbpEvaluator evaluator = LbpEvaluator::Scalar,
+                            int scanThreads = 0);
+
+      std::vector<cv::Rect> find_plates(cv::Mat frame, cv::Size min_plate_size, cv::Size max_plate_size) override;
+
+    private:
+      std::shared_ptr<const LbpCascade> cascade;
+      LbpEvaluator evaluator;
+      int scanThreads;
+      cv::Mat equalized;
+      LbpScanBuffers buffers;
+  };
+
+  // Plate detectors the plugin can build. OpenALPR's DETECTOR_TYPE cannot be extended from outside the prebuilt
+  // library, so these are chosen here, in front of alpr::createDetector.
+  enum class PlateDetectorType {
+    // Whatever alpr::createDetector builds for the config, i.e. DetectorCPU for lbpcpu
+    OpenAlpr,
+    // SharedCascadeDetector, evaluating one window at a time
+    SharedCascade,
+    // SharedCascadeDetector with the vectorized evaluator
+    VectorCascade
+  };
+
+  // Builds a plate detector of `type`. The shared cascade types only replace lbpcpu detection; other detectors in
+  // the config, and cascades that fail to load, fall back to alpr::createDetector. `scanThreads` bounds the threads
+  // a shared cascade scan uses, as for SharedCascadeDetector.
+  std::unique_ptr<alpr::Detector> createPlateDetector(alpr::Config* config, alpr::PreWarp* prewarp, PlateDetectorType type,
+                                                      int scanThreads = 0);
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_CASCADEDETECTOR_H */
@@ -0,0 +1,116 @@
+#include "engine-pool.h"
+
+#include "alpr_impl.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace visioncamerapluginanpr {
+  EnginePool::EnginePool(size_t size, EngineFactory factory) : stopping(false) {
+    std::mutex readyMutex;
+    std::condition_variable allReady;
+    size_t readyCount = 0;
+    std::exception_ptr loadError;
+
+    for (size_t i = 0; i < std::max<size_t>(size, 1); ++i) {
+      workers.emplace_back(new Worker());
+    }
+
+    for (auto& worker : workers) {
+      Worker* self = worker.get();
+
+      self->thread = std::thread([this, self, &factory, &readyMutex, &allReady, &readyCount, &loadError]() {
+        // Each engine is built on the thread that will own it, so engines load in parallel
+        try {
+          self->engine = factory();
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(readyMutex);
+          loadError = std::current_exception();
+        }
+
+        {
+          // Notify under the lock: the constructor's locals go away as soon as it sees the last engine
+          std::lock_guard<std::mutex> lock(readyMutex);
+          ++readyCount;
+          allReady.notify_one();
+        }
+
+        workerLoop(*self);
+      });
+    }
+
+    std::unique_lock<std::mutex> lock(readyMutex);
+    allReady.wait(lock, [this, &readyCount]() { return readyCount == workers.size(); });
+
+    if (loadError) {
+      lock.unlock();
+      {
+        std::lock_guard<std::mutex> queueLock(queueMutex);
+        stopping = true;
+      }
+      taskAvailable.notify_all();
+      for (auto& worker : workers) {
+        worker->thread.join();
+      }
+      std::rethrow_exception(loadError);
+    }
+  }
+
+  EnginePool::~EnginePool() {
+    {
+      std::lock_guard<std::mutex> lock(queueMutex);
+      stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (auto& worker : workers) {
+      worker->thread.join();
+    }
+  }
+
+  bool EnginePool::isLoaded() const {
+    for (const auto& worker : workers) {
+      if (!worker->engine || !worker->engine->isLoaded()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void EnginePool::configureAll(const std::function<void(alpr::AlprImpl&)>& configure) {
+    for (auto& worker : workers) {
+      std::lock_guard<std::mutex> lock(worker->engineMutex);
+      configure(*worker->engine);
+    }
+  }
+
+  void EnginePool::enqueue(std::function<void(alpr::AlprImpl&)> task) {
+    {
+      std::lock_guard<std::mutex> lock(queueMutex);
+      tasks.push_back(std::move(task));
+    }
+    taskAvailable.notify_one();
+  }
+
+  void EnginePool::workerLoop(Worker& worker) {
+    while (true) {
+      std::function<void(alpr::AlprImpl&)> task;
+
+      {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        taskAvailable.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+        // Queued tasks are drained before shutting down, so no caller is left waiting on a future
+        if (tasks.empty()) {
+          return;
+        }
+
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+
+      std::lock_guard<std::mutex> lock(worker.engineMutex);
+      task(*worker.engine);
+    }
+  }
+}
@@ -0,0 +1,71 @@
+#ifndef VISIONCAMERAPLUGINANPR_ENGINEPOOL_H
+#define VISIONCAMERAPLUGINANPR_ENGINEPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace alpr {
+  class AlprImpl;
+}
+
+namespace visioncamerapluginanpr {
+  // A fixed set of independent OpenALPR engines, each owned by its own worker thread.
+  // AlprImpl is not reentrant, so instead of sharing one engine behind a lock, requests are queued
+  // and picked up by whichever engine is free first.
+  class EnginePool {
+    public:
+      using EngineFactory = std::function<std::unique_ptr<alpr::AlprImpl>()>;
+
+      // Builds `size` engines in parallel, one on each worker thread, and waits until all are loaded
+      EnginePool(size_t size, EngineFactory factory);
+      ~EnginePool();
+
+      EnginePool(const EnginePool&) = delete;
+      EnginePool& operator=(const EnginePool&) = delete;
+
+      size_t size() const { return workers.size(); }
+
+      // True if every engine loaded its configuration and runtime data
+      bool isLoaded() const;
+
+      // Queues `task` for the first free engine. The returned future carries its result or exception.
+      template <typename Task>
+      auto run(Task task) -> std::future<decltype(task(std::declval<alpr::AlprImpl&>()))> {
+        using Result = decltype(task(std::declval<alpr::AlprImpl&>()));
+
+        auto packaged = std::make_shared<std::packaged_task<Result(alpr::AlprImpl&)>>(std::move(task));
+        std::future<Result> future = packaged->get_future();
+        enqueue([packaged](alpr::AlprImpl& engine) { (*packaged)(engine); });
+        return future;
+      }
+
+      // Applies a configuration change (e.g. setTopN) to every engine before it runs its next task
+      void configureAll(const std::function<void(alpr::AlprImpl&)>& configure);
+
+    private:
+      struct Worker {
+        std::unique_ptr<alpr::AlprImpl> engine;
+        // Held while the engine runs a task, so configuration never interleaves with recognition
+        std::mutex engineMutex;
+        std::thread thread;
+      };
+
+      void enqueue(std::function<void(alpr::AlprImpl&)> task);
+      void workerLoop(Worker& worker);
+
+      std::vector<std::unique_ptr<Worker>> workers;
+
+      std::mutex queueMutex;
+      std::condition_variable taskAvailable;
+      std::deque<std::function<void(alpr::AlprImpl&)>> tasks;
+      bool stopping;
+  };
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_ENGINEPOOL_H */
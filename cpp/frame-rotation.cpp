@@ -0,0 +1,255 @@
+#include "frame-rotation.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+  #include <arm_neon.h>
+  #define ANPR_ROTATION_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define ANPR_ROTATION_SSE2 1
+#endif
+
+namespace visioncamerapluginanpr {
+  // Transposed tiles are walked in blocks of this many destination pixels per side, so that the
+  // source rows and destination rows touched by a block stay resident in L1
+  static const int kBlockSize = 64;
+  static const int kTileSize = 8;
+
+  // Every rotation/mirror combination is an affine walk over the source plane:
+  // src(x, y) = src + base + x * stepX + y * stepY, where (x, y) are destination coordinates.
+  struct PlaneMapping {
+    ptrdiff_t base;
+    ptrdiff_t stepX;
+    ptrdiff_t stepY;
+  };
+
+  static PlaneMapping getPlaneMapping(int width, int height, ptrdiff_t stride, FrameRotation rotation, bool mirrored) {
+    const ptrdiff_t lastColumn = width - 1;
+    const ptrdiff_t lastRow = (height - 1) * stride;
+
+    switch (rotation) {
+      case FrameRotation::Clockwise90:
+        return mirrored ? PlaneMapping{ 0, stride, 1 } : PlaneMapping{ lastRow, -stride, 1 };
+      case FrameRotation::Rotate180:
+        return mirrored ? PlaneMapping{ lastRow, 1, -stride } : PlaneMapping{ lastRow + lastColumn, -1, -stride };
+      case FrameRotation::CounterClockwise90:
+        return mirrored ? PlaneMapping{ lastRow + lastColumn, -stride, -1 } : PlaneMapping{ lastColumn, stride, -1 };
+      case FrameRotation::None:
+      default:
+        return mirrored ? PlaneMapping{ lastColumn, -1, stride } : PlaneMapping{ 0, 1, stride };
+    }
+  }
+
+  static void mapRegionScalar(const uint8_t* src, const PlaneMapping& mapping, uint8_t* dst, size_t dstStride,
+                              int x0, int y0, int x1, int y1) {
+    for (int y = y0; y < y1; ++y) {
+      const uint8_t* srcRow = src + mapping.base + y * mapping.stepY;
+      uint8_t* dstRow = dst + y * dstStride;
+
+      for (int x = x0; x < x1; ++x) {
+        dstRow[x] = srcRow[x * mapping.stepX];
+      }
+    }
+  }
+
+  // Transposes an 8x8 block: byte k of source row j becomes byte j of destination row k.
+  // Steps may be negative to walk rows bottom-up.
+  static inline void transpose8x8(const uint8_t* src, ptrdiff_t srcStep, uint8_t* dst, ptrdiff_t dstStep) {
+#if defined(ANPR_ROTATION_NEON)
+    uint8x8x2_t t01 = vtrn_u8(vld1_u8(src), vld1_u8(src + srcStep));
+    uint8x8x2_t t23 = vtrn_u8(vld1_u8(src + 2 * srcStep), vld1_u8(src + 3 * srcStep));
+    uint8x8x2_t t45 = vtrn_u8(vld1_u8(src + 4 * srcStep), vld1_u8(src + 5 * srcStep));
+    uint8x8x2_t t67 = vtrn_u8(vld1_u8(src + 6 * srcStep), vld1_u8(src + 7 * srcStep));
+
+    uint16x4x2_t u02 = vtrn_u16(vreinterpret_u16_u8(t01.val[0]), vreinterpret_u16_u8(t23.val[0]));
+    uint16x4x2_t u13 = vtrn_u16(vreinterpret_u16_u8(t01.val[1]), vreinterpret_u16_u8(t23.val[1]));
+    uint16x4x2_t u46 = vtrn_u16(vreinterpret_u16_u8(t45.val[0]), vreinterpret_u16_u8(t67.val[0]));
+    uint16x4x2_t u57 = vtrn_u16(vreinterpret_u16_u8(t45.val[1]), vreinterpret_u16_u8(t67.val[1]));
+
+    uint32x2x2_t w04 = vtrn_u32(vreinterpret_u32_u16(u02.val[0]), vreinterpret_u32_u16(u46.val[0]));
+    uint32x2x2_t w26 = vtrn_u32(vreinterpret_u32_u16(u02.val[1]), vreinterpret_u32_u16(u46.val[1]));
+    uint32x2x2_t w15 = vtrn_u32(vreinterpret_u32_u16(u13.val[0]), vreinterpret_u32_u16(u57.val[0]));
+    uint32x2x2_t w37 = vtrn_u32(vreinterpret_u32_u16(u13.val[1]), vreinterpret_u32_u16(u57.val[1]));
+
+    vst1_u8(dst, vreinterpret_u8_u32(w04.val[0]));
+    vst1_u8(dst + dstStep, vreinterpret_u8_u32(w15.val[0]));
+    vst1_u8(dst + 2 * dstStep, vreinterpret_u8_u32(w26.val[0]));
+    vst1_u8(dst + 3 * dstStep, vreinterpret_u8_u32(w37.val[0]));
+    vst1_u8(dst + 4 * dstStep, vreinterpret_u8_u32(w04.val[1]));
+    vst1_u8(dst + 5 * dstStep, vreinterpret_u8_u32(w15.val[1]));
+    vst1_u8(dst + 6 * dstStep, vreinterpret_u8_u32(w26.val[1]));
+    vst1_u8(dst + 7 * dstStep, vreinterpret_u8_u32(w37.val[1]));
+#elif defined(ANPR_ROTATION_SSE2)
+    __m128i t0 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)),
+                                   _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + srcStep)));
+    __m128i t1 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 2 * srcStep)),
+                                   _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 3 * srcStep)));
+    __m128i t2 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 4 * srcStep)),
+                                   _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 5 * srcStep)));
+    __m128i t3 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 6 * srcStep)),
+                                   _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 7 * srcStep)));
+
+    __m128i u0 = _mm_unpacklo_epi16(t0, t1);
+    __m128i u1 = _mm_unpackhi_epi16(t0, t1);
+    __m128i u2 = _mm_unpacklo_epi16(t2, t3);
+    __m128i u3 = _mm_unpackhi_epi16(t2, t3);
+
+    __m128i v01 = _mm_unpacklo_epi32(u0, u2);
+    __m128i v23 = _mm_unpackhi_epi32(u0, u2);
+    __m128i v45 = _mm_unpacklo_epi32(u1, u3);
+    __m128i v67 = _mm_unpackhi_epi32(u1, u3);
+
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), v01);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + dstStep), _mm_srli_si128(v01, 8));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 2 * dstStep), v23);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 3 * dstStep), _mm_srli_si128(v23, 8));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 4 * dstStep), v45);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 5 * dstStep), _mm_srli_si128(v45, 8));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 6 * dstStep), v67);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 7 * dstStep), _mm_srli_si128(v67, 8));
+#else
+    for (int k = 0; k < kTileSize; ++k) {
+      for (int j = 0; j < kTileSize; ++j) {
+        dst[k * dstStep + j] = src[j * srcStep + k];
+      }
+    }
+#endif
+  }
+
+  // Copies a row whose source runs backwards in memory, starting at srcEnd and moving left
+  static inline void reverseRow(const uint8_t* srcEnd, uint8_t* dst, int width) {
+    int x = 0;
+#if defined(ANPR_ROTATION_NEON)
+    for (; x + 16 <= width; x += 16) {
+      uint8x16_t v = vrev64q_u8(vld1q_u8(srcEnd - x - 15));
+      vst1q_u8(dst + x, vcombine_u8(vget_high_u8(v), vget_low_u8(v)));
+    }
+#elif defined(ANPR_ROTATION_SSE2)
+    for (; x + 16 <= width; x += 16) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcEnd - x - 15));
+      v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+      v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+      v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+      v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), v);
+    }
+#endif
+    for (; x < width; ++x) {
+      dst[x] = *(srcEnd - x);
+    }
+  }
+
+  static void rotateRows(const uint8_t* src, const PlaneMapping& mapping, uint8_t* dst, size_t dstStride,
+                         int dstWidth, int dstHeight) {
+    for (int y = 0; y < dstHeight; ++y) {
+      const uint8_t* srcRow = src + mapping.base + y * mapping.stepY;
+      uint8_t* dstRow = dst + y * dstStride;
+
+      if (mapping.stepX > 0) {
+        std::memcpy(dstRow, srcRow, dstWidth);
+      } else {
+        reverseRow(srcRow, dstRow, dstWidth);
+      }
+    }
+  }
+
+  static void transposeTiles(const uint8_t* src, const PlaneMapping& mapping, uint8_t* dst, size_t dstStride,
+                             int dstWidth, int dstHeight) {
+    const int tiledWidth = dstWidth - dstWidth % kTileSize;
+    const int tiledHeight = dstHeight - dstHeight % kTileSize;
+
+    // Tiles read kTileSize contiguous source bytes per destination column; when the source runs
+    // backwards along a destination column the tile is stored bottom-up instead
+    const bool bottomUp = mapping.stepY < 0;
+    const ptrdiff_t dstStep = bottomUp ? -static_cast<ptrdiff_t>(dstStride) : static_cast<ptrdiff_t>(dstStride);
+
+    for (int blockY = 0; blockY < tiledHeight; blockY += kBlockSize) {
+      const int blockBottom = std::min(blockY + kBlockSize, tiledHeight);
+
+      for (int blockX = 0; blockX < tiledWidth; blockX += kBlockSize) {
+        const int blockRight = std::min(blockX + kBlockSize, tiledWidth);
+
+        for (int y0 = blockY; y0 < blockBottom; y0 += kTileSize) {
+          const int firstRow = bottomUp ? y0 + kTileSize - 1 : y0;
+
+          for (int x0 = blockX; x0 < blockRight; x0 += kTileSize) {
+            const uint8_t* tileSrc = src + mapping.base + x0 * mapping.stepX + firstRow * mapping.stepY;
+            uint8_t* tileDst = dst + firstRow * dstStride + x0;
+            transpose8x8(tileSrc, mapping.stepX, tileDst, dstStep);
+          }
+        }
+      }
+    }
+
+    // Right and bottom edges that do not fill a whole tile
+    mapRegionScalar(src, mapping, dst, dstStride, tiledWidth, 0, dstWidth, tiledHeight);
+    mapRegionScalar(src, mapping, dst, dstStride, 0, tiledHeight, dstWidth, dstHeight);
+  }
+
+  void rotatePlane(const uint8_t* src, int width, int height, size_t srcStride,
+                   uint8_t* dst, size_t dstStride, FrameRotation rotation, bool mirrored) {
+    const PlaneMapping mapping = getPlaneMapping(width, height, static_cast<ptrdiff_t>(srcStride), rotation, mirrored);
+
+    if (isTransposed(rotation)) {
+      transposeTiles(src, mapping, dst, dstStride, height, width);
+    } else {
+      rotateRows(src, mapping, dst, dstStride, width, height);
+    }
+  }
+
+  PlaneRect rotateRect(const PlaneRect& rect, int width, int height, FrameRotation rotation, bool mirrored) {
+    PlaneRect rotated;
+    switch (rotation) {
+      case FrameRotation::Clockwise90:
+        rotated = PlaneRect{ height - rect.y - rect.height, rect.x, rect.height, rect.width };
+        break;
+      case FrameRotation::Rotate180:
+        rotated = PlaneRect{ width - rect.x - rect.width, height - rect.y - rect.height, rect.width, rect.height };
+        break;
+      case FrameRotation::CounterClockwise90:
+        rotated = PlaneRect{ rect.y, width - rect.x - rect.width, rect.height, rect.width };
+        break;
+      case FrameRotation::None:
+      default:
+        rotated = rect;
+        break;
+    }
+
+    // Mirroring happens after rotation, across the rotated plane's width
+    if (mirrored) {
+      rotated.x = (isTransposed(rotation) ? height : width) - rotated.x - rotated.width;
+    }
+
+    return rotated;
+  }
+
+  PlaneRect unrotateRect(const PlaneRect& rect, int width, int height, FrameRotation rotation, bool mirrored) {
+    const int rotatedWidth = isTransposed(rotation) ? height : width;
+    const int rotatedHeight = isTransposed(rotation) ? width : height;
+
+    PlaneRect unmirrored = rect;
+    if (mirrored) {
+      unmirrored.x = rotatedWidth - rect.x - rect.width;
+    }
+
+    FrameRotation inverse = rotation;
+    if (rotation == FrameRotation::Clockwise90) {
+      inverse = FrameRotation::CounterClockwise90;
+    } else if (rotation == FrameRotation::CounterClockwise90) {
+      inverse = FrameRotation::Clockwise90;
+    }
+
+    return rotateRect(unmirrored, rotatedWidth, rotatedHeight, inverse, false);
+  }
+
+  void rotatePlaneReference(const uint8_t* src, int width, int height, size_t srcStride,
+                            uint8_t* dst, size_t dstStride, FrameRotation rotation, bool mirrored) {
+    const PlaneMapping mapping = getPlaneMapping(width, height, static_cast<ptrdiff_t>(srcStride), rotation, mirrored);
+    const int dstWidth = isTransposed(rotation) ? height : width;
+    const int dstHeight = isTransposed(rotation) ? width : height;
+
+    mapRegionScalar(src, mapping, dst, dstStride, 0, 0, dstWidth, dstHeight);
+  }
+}
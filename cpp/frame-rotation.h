@@ -0,0 +1,47 @@
+#ifndef VISIONCAMERAPLUGINANPR_FRAMEROTATION_H
+#define VISIONCAMERAPLUGINANPR_FRAMEROTATION_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace visioncamerapluginanpr {
+  // Rotation required to bring a frame upright, derived from VisionCamera's frame orientation
+  enum class FrameRotation {
+    None,
+    Clockwise90,
+    Rotate180,
+    CounterClockwise90
+  };
+
+  // Whether a rotation swaps the width and height of the plane
+  inline bool isTransposed(FrameRotation rotation) {
+    return rotation == FrameRotation::Clockwise90 || rotation == FrameRotation::CounterClockwise90;
+  }
+
+  // An axis-aligned rectangle within a plane, in pixels
+  struct PlaneRect {
+    int x;
+    int y;
+    int width;
+    int height;
+  };
+
+  // Where rotatePlane moves the pixels of `rect`, for a source plane of the given width and height
+  PlaneRect rotateRect(const PlaneRect& rect, int width, int height, FrameRotation rotation, bool mirrored);
+
+  // The inverse of rotateRect: where the pixels of a rectangle of the rotated plane come from.
+  // `width` and `height` are still those of the source plane.
+  PlaneRect unrotateRect(const PlaneRect& rect, int width, int height, FrameRotation rotation, bool mirrored);
+
+  // Rotates (and optionally mirrors horizontally, after rotating) a single 8-bit plane.
+  // The destination must be sized for the rotated plane, i.e. height x width for 90 degree rotations.
+  // Uses cache-blocked 8x8 byte transposes with NEON or SSE2 kernels where available.
+  void rotatePlane(const uint8_t* src, int width, int height, size_t srcStride,
+                   uint8_t* dst, size_t dstStride, FrameRotation rotation, bool mirrored);
+
+  // Straightforward per-pixel reference implementation, used to validate and benchmark the kernels
+  void rotatePlaneReference(const uint8_t* src, int width, int height, size_t srcStride,
+                            uint8_t* dst, size_t dstStride, FrameRotation rotation, bool mirrored);
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_FRAMEROTATION_H */
@@ -0,0 +1,125 @@
+#include "frame-scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace visioncamerapluginanpr {
+  void FrameScheduler::configure(const FrameSchedulerConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex);
+    settings = config;
+    settings.maxFps = std::max(0.0, config.maxFps);
+    settings.maxDutyCycle = std::isfinite(config.maxDutyCycle) && config.maxDutyCycle > 0
+      ? std::min(1.0, config.maxDutyCycle)
+      : 1.0;
+    settings.targetLatencyMs = std::max(0.0, config.targetLatencyMs);
+  }
+
+  FrameSchedulerConfig FrameScheduler::config() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return settings;
+  }
+
+  ScheduleDecision FrameScheduler::schedule(double now) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    ScheduleDecision decision = ScheduleDecision::Process;
+
+    if (hasProcessed) {
+      const double elapsed = now - lastProcessed;
+
+      // Without any latency samples yet, only the frame rate limit applies
+      const double p50 = percentile(0.5);
+      const double dutyInterval = p50 / settings.maxDutyCycle;
+
+      if (settings.maxFps > 0 && elapsed < 1000.0 / settings.maxFps) {
+        decision = ScheduleDecision::SkipFrameRate;
+      } else if (settings.maxDutyCycle < 1 && elapsed < dutyInterval) {
+        decision = ScheduleDecision::SkipDutyCycle;
+      } else if (settings.targetLatencyMs > 0) {
+        const double p95 = percentile(0.95);
+        if (p95 > settings.targetLatencyMs && elapsed < dutyInterval * (p95 / settings.targetLatencyMs)) {
+          decision = ScheduleDecision::SkipLatency;
+        }
+      }
+    }
+
+    switch (decision) {
+      case ScheduleDecision::Process:
+        previousHasProcessed = hasProcessed;
+        previousLastProcessed = lastProcessed;
+        hasProcessed = true;
+        lastProcessed = now;
+        ++processed;
+        break;
+      case ScheduleDecision::SkipFrameRate:
+        ++skippedFrameRate;
+        break;
+      case ScheduleDecision::SkipDutyCycle:
+        ++skippedDutyCycle;
+        break;
+      case ScheduleDecision::SkipLatency:
+        ++skippedLatency;
+        break;
+    }
+
+    return decision;
+  }
+
+  void FrameScheduler::revoke() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (processed > 0) {
+      --processed;
+    }
+    hasProcessed = previousHasProcessed;
+    lastProcessed = previousLastProcessed;
+  }
+
+  void FrameScheduler::recordLatency(double latencyMs) {
+    std::lock_guard<std::mutex> lock(mutex);
+    latencies[nextLatency] = latencyMs;
+    nextLatency = (nextLatency + 1) % kLatencyWindow;
+    latencyCount = std::min(latencyCount + 1, kLatencyWindow);
+  }
+
+  // Nearest-rank percentile of the latency window; 0 while there are no samples. Caller holds the mutex.
+  double FrameScheduler::percentile(double fraction) const {
+    if (latencyCount == 0) {
+      return 0;
+    }
+
+    std::array<double, kLatencyWindow> sorted;
+    std::copy(latencies.begin(), latencies.begin() + latencyCount, sorted.begin());
+
+    size_t rank = static_cast<size_t>(std::ceil(fraction * latencyCount));
+    size_t index = std::min(latencyCount - 1, rank > 0 ? rank - 1 : 0);
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.begin() + latencyCount);
+    return sorted[index];
+  }
+
+  FrameSchedulerStats FrameScheduler::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return FrameSchedulerStats{
+      processed,
+      skippedFrameRate,
+      skippedDutyCycle,
+      skippedLatency,
+      percentile(0.5),
+      percentile(0.95),
+      latencyCount
+    };
+  }
+
+  void FrameScheduler::resetStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    processed = 0;
+    skippedFrameRate = 0;
+    skippedDutyCycle = 0;
+    skippedLatency = 0;
+  }
+
+  double FrameScheduler::nowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+  }
+}
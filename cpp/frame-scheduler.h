@@ -0,0 +1,87 @@
+#ifndef VISIONCAMERAPLUGINANPR_FRAMESCHEDULER_H
+#define VISIONCAMERAPLUGINANPR_FRAMESCHEDULER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace visioncamerapluginanpr {
+  struct FrameSchedulerConfig {
+    // Upper bound on frames started per second; 0 disables the limit
+    double maxFps = 0;
+    // Fraction of wall-clock time recognition may occupy, in (0, 1]. With a median latency of 100ms,
+    // 0.25 admits at most one frame every 400ms. 1 disables the limit.
+    double maxDutyCycle = 1;
+    // When p95 latency rises above this (e.g. under thermal throttling), the admission interval is
+    // stretched by p95 / targetLatencyMs until latency recovers; 0 disables it
+    double targetLatencyMs = 0;
+  };
+
+  enum class ScheduleDecision {
+    Process,
+    SkipFrameRate,
+    SkipDutyCycle,
+    SkipLatency
+  };
+
+  struct FrameSchedulerStats {
+    uint64_t processed;
+    uint64_t skippedFrameRate;
+    uint64_t skippedDutyCycle;
+    uint64_t skippedLatency;
+    double p50LatencyMs;
+    double p95LatencyMs;
+    size_t latencySamples;
+  };
+
+  // Decides which camera frames are worth recognising, based on the latency of recent recognitions.
+  // Times are in milliseconds on any monotonic clock; see nowMs().
+  class FrameScheduler {
+    public:
+      static constexpr size_t kLatencyWindow = 64;
+
+      FrameScheduler() = default;
+
+      void configure(const FrameSchedulerConfig& config);
+      FrameSchedulerConfig config() const;
+
+      // Decides whether the frame arriving at `now` should be recognised. A Process decision starts its admission interval.
+      ScheduleDecision schedule(double now);
+
+      // Takes back the latest Process decision, for a frame that turned out not to need reading (e.g. the motion
+      // gate found it static): it is no longer counted as processed and the previous admission interval applies again.
+      void revoke();
+
+      // Records how long a recognition admitted by schedule() took
+      void recordLatency(double latencyMs);
+
+      FrameSchedulerStats stats() const;
+      void resetStats();
+
+      static double nowMs();
+
+    private:
+      double percentile(double fraction) const;
+
+      mutable std::mutex mutex;
+      FrameSchedulerConfig settings;
+
+      std::array<double, kLatencyWindow> latencies{};
+      size_t latencyCount = 0;
+      size_t nextLatency = 0;
+
+      bool hasProcessed = false;
+      double lastProcessed = 0;
+      // State before the latest Process decision, restored by revoke()
+      bool previousHasProcessed = false;
+      double previousLastProcessed = 0;
+
+      uint64_t processed = 0;
+      uint64_t skippedFrameRate = 0;
+      uint64_t skippedDutyCycle = 0;
+      uint64_t skippedLatency = 0;
+  };
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_FRAMESCHEDULER_H */
@@ -0,0 +1,26 @@
+#include "frame-source.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace visioncamerapluginanpr {
+  cv::Mat FrameSource::luma() const {
+    FramePlane yPlane = plane(0);
+    if (yPlane.pixelStride != 1) {
+      throw std::runtime_error("Luma plane is not tightly packed");
+    }
+
+    return cv::Mat(height(), width(), CV_8UC1, const_cast<uint8_t*>(yPlane.data), yPlane.rowStride);
+  }
+
+  MemoryFrameSource::MemoryFrameSource(int width, int height, PixelFormat format, std::vector<FramePlane> planes,
+                                       FrameRotation rotation, bool mirrored)
+    : frameWidth(width), frameHeight(height), format(format), planes(std::move(planes)), frameRotation(rotation), mirrored(mirrored) {}
+
+  FramePlane MemoryFrameSource::plane(int index) const {
+    if (index < 0 || static_cast<size_t>(index) >= planes.size()) {
+      throw std::out_of_range("Frame has no plane " + std::to_string(index));
+    }
+    return planes[index];
+  }
+}
@@ -0,0 +1,91 @@
+#ifndef VISIONCAMERAPLUGINANPR_FRAMESOURCE_H
+#define VISIONCAMERAPLUGINANPR_FRAMESOURCE_H
+
+#include "frame-rotation.h"
+#include "opencv2/core.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace visioncamerapluginanpr {
+  enum class PixelFormat {
+    // Y plane followed by U and V planes at half resolution, in any chroma layout
+    Yuv420,
+    // A single 8-bit luma plane
+    Gray8
+  };
+
+  struct FramePlane {
+    const uint8_t* data;
+    size_t rowStride;
+    // Distance between neighbouring pixels of a row, in bytes
+    size_t pixelStride;
+  };
+
+  // A camera frame as the recognition core sees it, independent of where it came from. Planes can only be
+  // read between lock() and unlock(); use FrameSourceLock to pair them.
+  class FrameSource {
+    public:
+      virtual ~FrameSource() = default;
+
+      virtual int width() const = 0;
+      virtual int height() const = 0;
+      // Rotation that brings the frame upright, and whether it is mirrored after rotating
+      virtual FrameRotation rotation() const = 0;
+      virtual bool isMirrored() const = 0;
+      virtual PixelFormat pixelFormat() const = 0;
+
+      virtual void lock() = 0;
+      virtual void unlock() = 0;
+      virtual FramePlane plane(int index) const = 0;
+
+      // Wraps the locked luma plane in place, without copying. Throws if it is not tightly packed.
+      cv::Mat luma() const;
+  };
+
+  class FrameSourceLock {
+    public:
+      explicit FrameSourceLock(FrameSource& source) : source(source) {
+        source.lock();
+      }
+
+      ~FrameSourceLock() {
+        source.unlock();
+      }
+
+      FrameSourceLock(const FrameSourceLock&) = delete;
+      FrameSourceLock& operator=(const FrameSourceLock&) = delete;
+
+    private:
+      FrameSource& source;
+  };
+
+  // A frame whose planes are already in memory, such as a raw Y-plane dump read on the host.
+  // The planes are borrowed and must outlive the source.
+  class MemoryFrameSource : public FrameSource {
+    public:
+      MemoryFrameSource(int width, int height, PixelFormat format, std::vector<FramePlane> planes,
+                        FrameRotation rotation = FrameRotation::None, bool mirrored = false);
+
+      int width() const override { return frameWidth; }
+      int height() const override { return frameHeight; }
+      FrameRotation rotation() const override { return frameRotation; }
+      bool isMirrored() const override { return mirrored; }
+      PixelFormat pixelFormat() const override { return format; }
+
+      void lock() override {}
+      void unlock() override {}
+      FramePlane plane(int index) const override;
+
+    private:
+      int frameWidth;
+      int frameHeight;
+      PixelFormat format;
+      std::vector<FramePlane> planes;
+      FrameRotation frameRotation;
+      bool mirrored;
+  };
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_FRAMESOURCE_H */
@@ -0,0 +1,72 @@
+#include "frame-window.h"
+
+#include <stdexcept>
+
+namespace visioncamerapluginanpr {
+  FrameWindow computeFrameWindow(const cv::Size& planeSize, FrameRotation rotation, bool mirrored,
+                                 const std::vector<cv::Rect>& regionsOfInterest) {
+    const cv::Rect planeRect(cv::Point(), planeSize);
+
+    std::vector<cv::Rect> planeRegions;
+    for (const cv::Rect& region : regionsOfInterest) {
+      cv::Rect clipped = region & planeRect;
+      if (!clipped.empty()) {
+        planeRegions.push_back(clipped);
+      }
+    }
+
+    if (!regionsOfInterest.empty() && planeRegions.empty()) {
+      throw std::invalid_argument("Regions of interest lie outside the frame");
+    }
+
+    FrameWindow window;
+    window.source = planeRect;
+    if (!planeRegions.empty()) {
+      window.source = planeRegions.front();
+      for (const cv::Rect& region : planeRegions) {
+        window.source |= region;
+      }
+    }
+
+    window.upright = toCvRect(rotateRect(toPlaneRect(window.source), planeSize.width, planeSize.height, rotation, mirrored));
+    window.frameSize = isTransposed(rotation) ? cv::Size(planeSize.height, planeSize.width) : planeSize;
+
+    // A single region covering the whole window needs no regions of interest at all
+    if (planeRegions.size() > 1) {
+      for (const cv::Rect& region : planeRegions) {
+        cv::Rect upright = toCvRect(rotateRect(toPlaneRect(region), planeSize.width, planeSize.height, rotation, mirrored));
+        window.regionsOfInterest.push_back(upright - window.upright.tl());
+      }
+    }
+
+    return window;
+  }
+
+  bool restrictToMotion(FrameWindow& window, const cv::Rect& motion) {
+    // Motion outside the regions of interest does not count
+    cv::Rect localMotion = (motion & window.upright) - window.upright.tl();
+    if (localMotion.empty()) {
+      return false;
+    }
+
+    if (window.regionsOfInterest.empty()) {
+      window.regionsOfInterest.push_back(localMotion);
+      return true;
+    }
+
+    std::vector<cv::Rect> moving;
+    for (const cv::Rect& region : window.regionsOfInterest) {
+      cv::Rect overlap = region & localMotion;
+      if (!overlap.empty()) {
+        moving.push_back(overlap);
+      }
+    }
+
+    if (moving.empty()) {
+      return false;
+    }
+
+    window.regionsOfInterest = std::move(moving);
+    return true;
+  }
+}
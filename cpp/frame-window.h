@@ -0,0 +1,39 @@
+#ifndef VISIONCAMERAPLUGINANPR_FRAMEWINDOW_H
+#define VISIONCAMERAPLUGINANPR_FRAMEWINDOW_H
+
+#include "frame-rotation.h"
+#include "opencv2/core.hpp"
+
+#include <vector>
+
+namespace visioncamerapluginanpr {
+  inline cv::Rect toCvRect(const PlaneRect& rect) {
+    return cv::Rect(rect.x, rect.y, rect.width, rect.height);
+  }
+
+  inline PlaneRect toPlaneRect(const cv::Rect& rect) {
+    return PlaneRect{ rect.x, rect.y, rect.width, rect.height };
+  }
+
+  // The part of a frame that needs reading: where it lies in the camera plane and in the upright frame
+  struct FrameWindow {
+    // Area of the camera plane to rotate; the whole plane unless regions of interest were given
+    cv::Rect source;
+    // The same area once rotated upright, in upright frame coordinates
+    cv::Rect upright;
+    cv::Size frameSize;
+    // Regions to search, relative to the upright window; empty searches all of it
+    std::vector<cv::Rect> regionsOfInterest;
+  };
+
+  // Bounds the regions of interest, given in camera plane coordinates, and maps them into the upright window.
+  // No regions covers the whole frame. Throws std::invalid_argument if every region lies outside the frame.
+  FrameWindow computeFrameWindow(const cv::Size& planeSize, FrameRotation rotation, bool mirrored,
+                                 const std::vector<cv::Rect>& regionsOfInterest);
+
+  // Narrows the window's search to a moving region given in upright frame coordinates.
+  // Returns false if nothing inside the window moved.
+  bool restrictToMotion(FrameWindow& window, const cv::Rect& motion);
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_FRAMEWINDOW_H */
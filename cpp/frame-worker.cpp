@@ -0,0 +1,96 @@
+#include "frame-worker.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace visioncamerapluginanpr {
+  FrameWorker::FrameWorker(ProcessFunction process, size_t concurrency, std::function<void()> onDropped)
+    : process(std::move(process)), onDropped(std::move(onDropped)), nextFrameId(1), lastPublishedFrameId(0), stopping(false) {
+    for (size_t i = 0; i < std::max<size_t>(concurrency, 1); ++i) {
+      threads.emplace_back(&FrameWorker::run, this);
+    }
+  }
+
+  FrameWorker::~FrameWorker() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    frameAvailable.notify_all();
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+
+  uint64_t FrameWorker::submit(PendingFrame frame) {
+    // The replaced frame (if any) is released outside the lock
+    std::unique_ptr<PendingFrame> replaced;
+    uint64_t frameId;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      frameId = nextFrameId++;
+      frame.id = frameId;
+
+      replaced = std::move(mailbox);
+      mailbox.reset(new PendingFrame(std::move(frame)));
+    }
+
+    frameAvailable.notify_one();
+    if (replaced && onDropped) {
+      onDropped();
+    }
+    return frameId;
+  }
+
+  bool FrameWorker::takeResult(FrameResult& result) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!latestResult) {
+      return false;
+    }
+
+    result = std::move(*latestResult);
+    latestResult.reset();
+    return true;
+  }
+
+  void FrameWorker::run() {
+    while (true) {
+      std::unique_ptr<PendingFrame> frame;
+
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        frameAvailable.wait(lock, [this]() { return stopping || mailbox; });
+
+        if (stopping) {
+          return;
+        }
+
+        frame = std::move(mailbox);
+      }
+
+      std::unique_ptr<FrameResult> result(new FrameResult());
+      result->frameId = frame->id;
+
+      try {
+        result->results = process(*frame);
+      } catch (const std::exception& e) {
+        result->error = e.what();
+      }
+      result->timings = std::move(frame->timings);
+
+      // Hand the pixels back to the pool before publishing, so the next frame can reuse them
+      frame.reset();
+
+      std::lock_guard<std::mutex> lock(mutex);
+
+      // Frames finish out of order when several are in flight; never publish one older than the last
+      if (result->frameId > lastPublishedFrameId) {
+        lastPublishedFrameId = result->frameId;
+        latestResult = std::move(result);
+      }
+    }
+  }
+}
@@ -0,0 +1,86 @@
+#ifndef VISIONCAMERAPLUGINANPR_FRAMEWORKER_H
+#define VISIONCAMERAPLUGINANPR_FRAMEWORKER_H
+
+#include "alpr.h"
+#include "buffer-pool.h"
+#include "stage-timing.h"
+#include "opencv2/core.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace visioncamerapluginanpr {
+  // An upright 8-bit luma frame, or the window of one that needs reading, that owns its pixels so it
+  // can outlive the camera buffer it came from
+  struct PendingFrame {
+    uint64_t id;
+    BufferPool::Buffer pixels;
+    int width;
+    int height;
+    size_t stride;
+    // Where the pixels lie in the upright frame, whose coordinates results are reported in
+    cv::Point offset;
+    cv::Size frameSize;
+    // Regions of the pixels to search; empty searches all of them
+    std::vector<cv::Rect> regionsOfInterest;
+    // Whether the frame goes through the plate tracker, and when it was captured
+    bool track;
+    double timestamp;
+    // Filled in while the frame is read when its caller asked for timings
+    std::shared_ptr<RecognitionTimings> timings;
+  };
+
+  struct FrameResult {
+    uint64_t frameId;
+    alpr::AlprResults results;
+    // Set instead of results when recognition threw
+    std::string error;
+    // The frame's timings, when they were asked for
+    std::shared_ptr<RecognitionTimings> timings;
+  };
+
+  // Runs recognition on dedicated threads fed by a single-slot mailbox. Submitting a frame while
+  // another is still waiting replaces it (latest frame wins), so capture never waits on recognition.
+  // With a concurrency above one, several frames can be in flight, e.g. one per pooled engine.
+  class FrameWorker {
+    public:
+      using ProcessFunction = std::function<alpr::AlprResults(const PendingFrame&)>;
+
+      // `onDropped` runs on the submitting thread whenever a waiting frame is replaced by a newer one
+      explicit FrameWorker(ProcessFunction process, size_t concurrency = 1, std::function<void()> onDropped = nullptr);
+      ~FrameWorker();
+
+      FrameWorker(const FrameWorker&) = delete;
+      FrameWorker& operator=(const FrameWorker&) = delete;
+
+      // Queues a frame and returns immediately. Returns the id assigned to the frame.
+      uint64_t submit(PendingFrame frame);
+
+      // Moves the newest unread result into `result`. Returns false if nothing new has completed.
+      bool takeResult(FrameResult& result);
+
+    private:
+      void run();
+
+      ProcessFunction process;
+      std::function<void()> onDropped;
+
+      std::mutex mutex;
+      std::condition_variable frameAvailable;
+      std::unique_ptr<PendingFrame> mailbox;
+      std::unique_ptr<FrameResult> latestResult;
+      uint64_t nextFrameId;
+      uint64_t lastPublishedFrameId;
+      bool stopping;
+
+      std::vector<std::thread> threads;
+  };
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_FRAMEWORKER_H */
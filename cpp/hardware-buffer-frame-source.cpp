@@ -0,0 +1,45 @@
+#include "hardware-buffer-frame-source.h"
+#include "logging.h"
+
+#include <stdexcept>
+
+namespace visioncamerapluginanpr {
+  HardwareBufferFrameSource::HardwareBufferFrameSource(AHardwareBuffer* hardwareBuffer, int width, int height,
+                                                       FrameRotation rotation, bool mirrored)
+    : hardwareBuffer(hardwareBuffer), planes(), locked(false), frameWidth(width), frameHeight(height),
+      frameRotation(rotation), mirrored(mirrored) {}
+
+  HardwareBufferFrameSource::~HardwareBufferFrameSource() {
+    unlock();
+  }
+
+  void HardwareBufferFrameSource::lock() {
+    if (locked) {
+      return;
+    }
+
+    int result = AHardwareBuffer_lockPlanes(hardwareBuffer, AHARDWAREBUFFER_USAGE_CPU_READ_RARELY, -1, nullptr, &planes);
+    if (result != 0) {
+      LOGE("Failed to lock HardwareBuffer planes for reading! Error code: %d", result);
+      throw std::runtime_error("Failed to lock HardwareBuffer planes for reading!");
+    }
+
+    locked = true;
+  }
+
+  void HardwareBufferFrameSource::unlock() {
+    if (locked) {
+      AHardwareBuffer_unlock(hardwareBuffer, nullptr);
+      locked = false;
+    }
+  }
+
+  FramePlane HardwareBufferFrameSource::plane(int index) const {
+    if (!locked || index < 0 || static_cast<uint32_t>(index) >= planes.planeCount) {
+      throw std::out_of_range("HardwareBuffer plane is not available");
+    }
+
+    const AHardwareBuffer_Plane& hardwarePlane = planes.planes[index];
+    return FramePlane{ static_cast<const uint8_t*>(hardwarePlane.data), hardwarePlane.rowStride, hardwarePlane.pixelStride };
+  }
+}
@@ -0,0 +1,39 @@
+#ifndef VISIONCAMERAPLUGINANPR_HARDWAREBUFFERFRAMESOURCE_H
+#define VISIONCAMERAPLUGINANPR_HARDWAREBUFFERFRAMESOURCE_H
+
+#include "frame-source.h"
+
+#include <android/hardware_buffer.h>
+
+namespace visioncamerapluginanpr {
+  // A VisionCamera frame backed by an AHardwareBuffer. Locking maps its planes for CPU reads.
+  class HardwareBufferFrameSource : public FrameSource {
+    public:
+      HardwareBufferFrameSource(AHardwareBuffer* hardwareBuffer, int width, int height, FrameRotation rotation, bool mirrored);
+      ~HardwareBufferFrameSource() override;
+
+      HardwareBufferFrameSource(const HardwareBufferFrameSource&) = delete;
+      HardwareBufferFrameSource& operator=(const HardwareBufferFrameSource&) = delete;
+
+      int width() const override { return frameWidth; }
+      int height() const override { return frameHeight; }
+      FrameRotation rotation() const override { return frameRotation; }
+      bool isMirrored() const override { return mirrored; }
+      PixelFormat pixelFormat() const override { return PixelFormat::Yuv420; }
+
+      void lock() override;
+      void unlock() override;
+      FramePlane plane(int index) const override;
+
+    private:
+      AHardwareBuffer* hardwareBuffer;
+      AHardwareBuffer_Planes planes;
+      bool locked;
+      int frameWidth;
+      int frameHeight;
+      FrameRotation frameRotation;
+      bool mirrored;
+  };
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_HARDWAREBUFFERFRAMESOURCE_H */
@@ -0,0 +1,43 @@
+#include "image-decoder.h"
+
+#include "opencv2/imgcodecs.hpp"
+
+#include <climits>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace visioncamerapluginanpr {
+  static int decodeFlags(int reduction, bool grayscale) {
+    switch (reduction) {
+      case 2: return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_2 : cv::IMREAD_REDUCED_COLOR_2;
+      case 4: return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_4 : cv::IMREAD_REDUCED_COLOR_4;
+      case 8: return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_8 : cv::IMREAD_REDUCED_COLOR_8;
+      default: return grayscale ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR;
+    }
+  }
+
+  bool decodeImage(const uint8_t* bytes, size_t size, cv::Mat& image, int reduction, bool grayscale) {
+    if (!bytes || size == 0 || size > static_cast<size_t>(INT_MAX)) {
+      image.release();
+      return false;
+    }
+
+    // A header over the caller's bytes; imdecode only reads them
+    const cv::Mat encoded(1, static_cast<int>(size), CV_8UC1, const_cast<uint8_t*>(bytes));
+    // On failure imdecode returns an empty Mat but may leave the previous image in `image`
+    if (cv::imdecode(encoded, decodeFlags(reduction, grayscale), &image).empty()) {
+      image.release();
+      return false;
+    }
+    return true;
+  }
+
+  std::vector<uint8_t> readImageFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+      throw std::runtime_error("Unable to read image at " + path);
+    }
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  }
+}
@@ -0,0 +1,25 @@
+#ifndef VISIONCAMERAPLUGINANPR_IMAGEDECODER_H
+#define VISIONCAMERAPLUGINANPR_IMAGEDECODER_H
+
+#include "opencv2/core.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace visioncamerapluginanpr {
+  // Decodes an encoded image (JPEG, PNG, ...) to BGR straight from bytes the caller owns, such as a JS
+  // ArrayBuffer, so they are never copied. This is what Alpr::recognize(std::vector<char>) does after
+  // taking two copies of the bytes. `image` keeps its allocation when the next image has the same size
+  // and type, so a caller decoding photos in a loop can reuse one Mat. Returns false if the bytes do not decode.
+  // A `reduction` of 2, 4 or 8 decodes a JPEG at that fraction of its size, which libjpeg does by scaling in the
+  // DCT domain instead of decoding every pixel; other formats are decoded in full and then resized. With `grayscale`,
+  // a single luma plane is decoded instead of BGR.
+  bool decodeImage(const uint8_t* bytes, size_t size, cv::Mat& image, int reduction = 1, bool grayscale = false);
+
+  // Reads an encoded image file whole, so it can be decoded like image bytes. Throws std::runtime_error if it cannot be read.
+  std::vector<uint8_t> readImageFile(const std::string& path);
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_IMAGEDECODER_H */
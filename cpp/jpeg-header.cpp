@@ -0,0 +1,87 @@
+#include "jpeg-header.h"
+
+#include <algorithm>
+
+namespace visioncamerapluginanpr {
+  static uint16_t readBigEndian16(const uint8_t* bytes) {
+    return static_cast<uint16_t>((bytes[0] << 8) | bytes[1]);
+  }
+
+  bool readJpegSize(const uint8_t* bytes, size_t size, cv::Size& imageSize) {
+    if (!bytes || size < 4 || bytes[0] != 0xFF || bytes[1] != 0xD8) {
+      return false;
+    }
+
+    size_t offset = 2;
+    while (offset + 4 <= size) {
+      if (bytes[offset] != 0xFF) {
+        return false;
+      }
+
+      // Any number of 0xFF fill bytes may precede a marker
+      const uint8_t marker = bytes[offset + 1];
+      if (marker == 0xFF) {
+        ++offset;
+        continue;
+      }
+
+      // Markers without a length: TEM and RST0-7
+      if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+        offset += 2;
+        continue;
+      }
+
+      // Entropy-coded data follows SOS, so a frame header can no longer appear; EOI ends the image
+      if (marker == 0xDA || marker == 0xD9) {
+        return false;
+      }
+
+      const uint16_t length = readBigEndian16(bytes + offset + 2);
+      if (length < 2) {
+        return false;
+      }
+
+      // SOF0-SOF15, except DHT (C4), JPG (C8) and DAC (CC), which share the range
+      const bool frameHeader = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+      if (frameHeader) {
+        // Length, precision, height, width
+        if (length < 7 || offset + 9 > size) {
+          return false;
+        }
+
+        const int height = readBigEndian16(bytes + offset + 5);
+        const int width = readBigEndian16(bytes + offset + 7);
+        if (width == 0 || height == 0) {
+          return false;
+        }
+
+        imageSize = cv::Size(width, height);
+        return true;
+      }
+
+      offset += 2 + length;
+    }
+
+    return false;
+  }
+
+  int jpegReduction(const cv::Size& searchSize, const cv::Size& maxDetectionSize) {
+    if (searchSize.width <= 0 || searchSize.height <= 0 || maxDetectionSize.width <= 0 || maxDetectionSize.height <= 0) {
+      return 1;
+    }
+
+    // Scale the detector reduces to, whichever way round the image turns out to be
+    auto fit = [&maxDetectionSize](int width, int height) {
+      return std::min({ 1.0,
+        static_cast<double>(maxDetectionSize.width) / width,
+        static_cast<double>(maxDetectionSize.height) / height });
+    };
+    const double scale = std::max(fit(searchSize.width, searchSize.height), fit(searchSize.height, searchSize.width));
+
+    int reduction = 1;
+    while (reduction < 8 && scale * reduction * 2 <= 1.0) {
+      reduction *= 2;
+    }
+    return reduction;
+  }
+}
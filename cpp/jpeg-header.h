@@ -0,0 +1,22 @@
+#ifndef VISIONCAMERAPLUGINANPR_JPEGHEADER_H
+#define VISIONCAMERAPLUGINANPR_JPEGHEADER_H
+
+#include "opencv2/core.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace visioncamerapluginanpr {
+  // Reads the stored width and height from a JPEG's frame (SOFn) header without decoding anything.
+  // Returns false if the bytes are not a JPEG or end before the frame header. The size is as stored,
+  // before any EXIF orientation is applied.
+  bool readJpegSize(const uint8_t* bytes, size_t size, cv::Size& imageSize);
+
+  // Largest reduction libjpeg can decode at directly (1, 2, 4 or 8) that still leaves the detector as many pixels
+  // as it would keep itself after fitting the searched area within `maxDetectionSize`. `searchSize` is the
+  // bounding size of the regions of interest, or the whole image. The size may be either way round,
+  // since EXIF orientation is applied after decoding.
+  int jpegReduction(const cv::Size& searchSize, const cv::Size& maxDetectionSize);
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_JPEGHEADER_H */
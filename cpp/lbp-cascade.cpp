@@ -0,0 +1,166 @@
+#include "lbp-cascade.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// Fields are copied in host byte order; every ABI the plugin ships for is little-endian
+namespace visioncamerapluginanpr {
+  static const char kMagic[8] = { 'A', 'N', 'P', 'R', 'L', 'B', 'P', 'C' };
+  static const size_t kStageSize = 12;
+  static const size_t kWeakSize = 44;
+  static const size_t kFeatureSize = 16;
+
+  template <typename T>
+  static inline uint8_t* put(uint8_t* dst, T value) {
+    std::memcpy(dst, &value, sizeof(T));
+    return dst + sizeof(T);
+  }
+
+  template <typename T>
+  static inline T get(const uint8_t*& src) {
+    T value;
+    std::memcpy(&value, src, sizeof(T));
+    src += sizeof(T);
+    return value;
+  }
+
+  std::vector<uint8_t> serializeLbpCascade(const LbpCascade& cascade) {
+    std::vector<uint8_t> bytes(LbpCascade::kHeaderSize + cascade.stages.size() * kStageSize +
+                               cascade.weaks.size() * kWeakSize + cascade.features.size() * kFeatureSize);
+
+    uint8_t* out = bytes.data();
+    std::memcpy(out, kMagic, sizeof(kMagic));
+    out += sizeof(kMagic);
+    out = put<uint32_t>(out, LbpCascade::kFormatVersion);
+    out = put<int32_t>(out, cascade.windowWidth);
+    out = put<int32_t>(out, cascade.windowHeight);
+    out = put<uint32_t>(out, static_cast<uint32_t>(cascade.stages.size()));
+    out = put<uint32_t>(out, static_cast<uint32_t>(cascade.weaks.size()));
+    out = put<uint32_t>(out, static_cast<uint32_t>(cascade.features.size()));
+
+    for (const LbpCascade::Stage& stage : cascade.stages) {
+      out = put<float>(out, stage.threshold);
+      out = put<uint32_t>(out, stage.firstWeak);
+      out = put<uint32_t>(out, stage.weakCount);
+    }
+
+    for (const LbpCascade::Weak& weak : cascade.weaks) {
+      out = put<uint32_t>(out, weak.feature);
+      for (uint32_t word : weak.subset) {
+        out = put<uint32_t>(out, word);
+      }
+      out = put<float>(out, weak.leaves[0]);
+      out = put<float>(out, weak.leaves[1]);
+    }
+
+    for (const LbpCascade::Feature& feature : cascade.features) {
+      out = put<int32_t>(out, feature.x);
+      out = put<int32_t>(out, feature.y);
+      out = put<int32_t>(out, feature.width);
+      out = put<int32_t>(out, feature.height);
+    }
+
+    return bytes;
+  }
+
+  LbpCascade parseLbpCascade(const uint8_t* bytes, size_t size) {
+    if (!bytes || size < LbpCascade::kHeaderSize || std::memcmp(bytes, kMagic, sizeof(kMagic)) != 0) {
+      throw std::runtime_error("Not a packed LBP cascade");
+    }
+
+    const uint8_t* in = bytes + sizeof(kMagic);
+    const uint32_t version = get<uint32_t>(in);
+    if (version != LbpCascade::kFormatVersion) {
+      throw std::runtime_error("Unsupported LBP cascade version " + std::to_string(version));
+    }
+
+    LbpCascade cascade;
+    cascade.windowWidth = get<int32_t>(in);
+    cascade.windowHeight = get<int32_t>(in);
+    const uint32_t stageCount = get<uint32_t>(in);
+    const uint32_t weakCount = get<uint32_t>(in);
+    const uint32_t featureCount = get<uint32_t>(in);
+
+    const uint64_t expectedSize = LbpCascade::kHeaderSize + static_cast<uint64_t>(stageCount) * kStageSize +
+                                  static_cast<uint64_t>(weakCount) * kWeakSize + static_cast<uint64_t>(featureCount) * kFeatureSize;
+    if (expectedSize != size) {
+      throw std::runtime_error("Packed LBP cascade has the wrong size");
+    }
+    if (cascade.windowWidth <= 0 || cascade.windowHeight <= 0) {
+      throw std::runtime_error("Packed LBP cascade has no window size");
+    }
+
+    cascade.stages.resize(stageCount);
+    for (LbpCascade::Stage& stage : cascade.stages) {
+      stage.threshold = get<float>(in);
+      stage.firstWeak = get<uint32_t>(in);
+      stage.weakCount = get<uint32_t>(in);
+      if (stage.firstWeak > weakCount || stage.weakCount > weakCount - stage.firstWeak) {
+        throw std::runtime_error("Packed LBP cascade stage is out of range");
+      }
+    }
+
+    cascade.weaks.resize(weakCount);
+    for (LbpCascade::Weak& weak : cascade.weaks) {
+      weak.feature = get<uint32_t>(in);
+      for (uint32_t& word : weak.subset) {
+        word = get<uint32_t>(in);
+      }
+      weak.leaves[0] = get<float>(in);
+      weak.leaves[1] = get<float>(in);
+      if (weak.feature >= featureCount) {
+        throw std::runtime_error("Packed LBP cascade feature is out of range");
+      }
+    }
+
+    cascade.features.resize(featureCount);
+    for (LbpCascade::Feature& feature : cascade.features) {
+      feature.x = get<int32_t>(in);
+      feature.y = get<int32_t>(in);
+      feature.width = get<int32_t>(in);
+      feature.height = get<int32_t>(in);
+      // Every cell corner has to fall inside the window, or evaluation would read outside the integral image
+      if (feature.x < 0 || feature.y < 0 || feature.width <= 0 || feature.height <= 0 ||
+          feature.x + 3 * static_cast<int64_t>(feature.width) > cascade.windowWidth ||
+          feature.y + 3 * static_cast<int64_t>(feature.height) > cascade.windowHeight) {
+        throw std::runtime_error("Packed LBP cascade feature lies outside the window");
+      }
+    }
+
+    return cascade;
+  }
+
+  std::vector<LbpFeatureOffsets> lbpFeatureOffsets(const LbpCascade& cascade, size_t integralStep) {
+    std::vector<LbpFeatureOffsets> offsets(cascade.features.size());
+    for (size_t i = 0; i < cascade.features.size(); ++i) {
+      const LbpCascade::Feature& feature = cascade.features[i];
+      for (int row = 0; row < 4; ++row) {
+        for (int column = 0; column < 4; ++column) {
+          offsets[i][row * 4 + column] = static_cast<int>((feature.y + row * feature.height) * integralStep +
+                                                          feature.x + column * feature.width);
+        }
+      }
+    }
+    return offsets;
+  }
+
+  int evaluateLbpCascade(const LbpCascade& cascade, const std::vector<LbpFeatureOffsets>& offsets, const int* window) {
+    const LbpCascade::Weak* weaks = cascade.weaks.data();
+    for (size_t stageIndex = 0; stageIndex < cascade.stages.size(); ++stageIndex) {
+      const LbpCascade::Stage& stage = cascade.stages[stageIndex];
+      // Summed in double, as OpenCV does, so borderline windows are decided the same way
+      double sum = 0;
+      for (uint32_t i = stage.firstWeak; i < stage.firstWeak + stage.weakCount; ++i) {
+        const LbpCascade::Weak& weak = weaks[i];
+        const int code = lbpCode(window, offsets[weak.feature]);
+        sum += weak.leaves[(weak.subset[code >> 5] & (1u << (code & 31))) ? 0 : 1];
+      }
+
+      if (sum < stage.threshold) {
+        return -static_cast<int>(stageIndex);
+      }
+    }
+    return 1;
+  }
+}
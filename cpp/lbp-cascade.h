@@ -0,0 +1,87 @@
+#ifndef VISIONCAMERAPLUGINANPR_LBPCASCADE_H
+#define VISIONCAMERAPLUGINANPR_LBPCASCADE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace visioncamerapluginanpr {
+  // A boosted cascade of LBP stumps, as trained by opencv_traincascade and stored in runtime_data/region/<country>.xml.
+  // Immutable once loaded, so one instance is shared by every engine's detector.
+  struct LbpCascade {
+    // Of the packed form read by parseLbpCascade
+    static constexpr uint32_t kFormatVersion = 1;
+    static constexpr size_t kHeaderSize = 32;
+
+    struct Stage {
+      // Already lowered by OpenCV's THRESHOLD_EPS, so a window passes when its sum is not below it
+      float threshold;
+      uint32_t firstWeak;
+      uint32_t weakCount;
+    };
+
+    // One decision stump: LBP codes in `subset` score leaves[0], all others leaves[1]
+    struct Weak {
+      uint32_t feature;
+      std::array<uint32_t, 8> subset;
+      std::array<float, 2> leaves;
+    };
+
+    // A 3x3 grid of cells, each `width` x `height`, with its top-left corner at (x, y) in the window
+    struct Feature {
+      int32_t x;
+      int32_t y;
+      int32_t width;
+      int32_t height;
+    };
+
+    int32_t windowWidth = 0;
+    int32_t windowHeight = 0;
+    std::vector<Stage> stages;
+    std::vector<Weak> weaks;
+    std::vector<Feature> features;
+  };
+
+  // Packed little-endian form of an LbpCascade, stored next to the XML as <country>.lbpc. loadSharedLbpCascade writes
+  // it the first time it reads the XML; tools/lbp-cascade-convert writes it ahead of time on a host:
+  //
+  //   header    8 byte magic "ANPRLBPC", uint32 version, int32 windowWidth, int32 windowHeight,
+  //             uint32 stageCount, uint32 weakCount, uint32 featureCount
+  //   stages    stageCount   x 12 bytes  float32 threshold, uint32 firstWeak, uint32 weakCount
+  //   weaks     weakCount    x 44 bytes  uint32 feature, uint32 subset[8], float32 leaves[2]
+  //   features  featureCount x 16 bytes  int32 x, y, width, height
+  //
+  // Loading it is a bounds check and three copies, where the XML takes a full parse per detector.
+  std::vector<uint8_t> serializeLbpCascade(const LbpCascade& cascade);
+
+  // Throws std::runtime_error if the bytes are not a valid cascade of this version
+  LbpCascade parseLbpCascade(const uint8_t* bytes, size_t size);
+
+  // Offsets of the 4x4 cell corners of one feature from a window's top-left corner in an integral image, row-major
+  using LbpFeatureOffsets = std::array<int, 16>;
+
+  // Corner offsets of every feature for an int32 integral image with `integralStep` elements per row
+  std::vector<LbpFeatureOffsets> lbpFeatureOffsets(const LbpCascade& cascade, size_t integralStep);
+
+  // 8-bit LBP code of a feature: one bit per outer cell whose sum is at least the centre cell's, clockwise from the
+  // top-left cell starting at the most significant bit, as OpenCV's LBPEvaluator computes it
+  inline int lbpCode(const int* window, const LbpFeatureOffsets& o) {
+    auto cell = [window, &o](int a, int b, int c, int d) { return window[o[a]] - window[o[b]] - window[o[c]] + window[o[d]]; };
+    const int centre = cell(5, 6, 9, 10);
+    return (cell(0, 1, 4, 5) >= centre ? 128 : 0) |
+           (cell(1, 2, 5, 6) >= centre ? 64 : 0) |
+           (cell(2, 3, 6, 7) >= centre ? 32 : 0) |
+           (cell(6, 7, 10, 11) >= centre ? 16 : 0) |
+           (cell(10, 11, 14, 15) >= centre ? 8 : 0) |
+           (cell(9, 10, 13, 14) >= centre ? 4 : 0) |
+           (cell(8, 9, 12, 13) >= centre ? 2 : 0) |
+           (cell(4, 5, 8, 9) >= centre ? 1 : 0);
+  }
+
+  // Runs the cascade on the window whose top-left corner is at `window` in the integral image. Returns 1 if every
+  // stage accepts it, otherwise minus the index of the stage that rejected it (so 0 for the first stage).
+  int evaluateLbpCascade(const LbpCascade& cascade, const std::vector<LbpFeatureOffsets>& offsets, const int* window);
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_LBPCASCADE_H */
@@ -0,0 +1,86 @@
+#include "lbp-vector-evaluator.h"
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace visioncamerapluginanpr {
+  static_assert(LbpVectorEvaluator::kLanes == cv::v_int32x4::nlanes, "one lane per 32-bit integral value");
+
+  LbpVectorEvaluator::LbpVectorEvaluator(const LbpCascade& cascade, size_t integralStep) : step(integralStep) {
+    const std::vector<LbpFeatureOffsets> offsets = lbpFeatureOffsets(cascade, integralStep);
+
+    stumps.reserve(cascade.weaks.size());
+    for (const LbpCascade::Stage& stage : cascade.stages) {
+      for (uint32_t i = stage.firstWeak; i < stage.firstWeak + stage.weakCount; ++i) {
+        const LbpCascade::Weak& weak = cascade.weaks[i];
+        stumps.push_back({ offsets[weak.feature], weak.subset, weak.leaves });
+      }
+      stages.push_back({ stage.threshold, static_cast<uint32_t>(stumps.size()) });
+    }
+  }
+
+  // The value at `offset` from each lane's window. With a stride of 2, the odd columns loaded alongside are dropped.
+  static inline cv::v_int32x4 loadLanes(const int* window, int offset, int stride) {
+    if (stride == 1) {
+      return cv::v_load(window + offset);
+    }
+
+    cv::v_int32x4 even, odd;
+    cv::v_load_deinterleave(window + offset, even, odd);
+    return even;
+  }
+
+  void LbpVectorEvaluator::evaluate(const int* window, int stride, int* results) const {
+    const cv::v_int32x4 zero = cv::v_setzero_s32();
+    std::array<double, kLanes> sums;
+    int alive = (1 << kLanes) - 1;
+    alignas(16) int codes[kLanes];
+
+    const Stump* stump = stumps.data();
+    for (size_t stageIndex = 0; stageIndex < stages.size(); ++stageIndex) {
+      const Stage& stage = stages[stageIndex];
+      sums.fill(0);
+
+      for (; stump != stumps.data() + stage.end; ++stump) {
+        const LbpFeatureOffsets& o = stump->offsets;
+        cv::v_int32x4 corners[16];
+        for (int k = 0; k < 16; ++k) {
+          corners[k] = loadLanes(window, o[k], stride);
+        }
+
+        auto cell = [&corners](int a, int b, int c, int d) { return corners[a] - corners[b] - corners[c] + corners[d]; };
+        auto bit = [&zero](const cv::v_int32x4& set, int value) { return cv::v_select(set, cv::v_setall_s32(value), zero); };
+        const cv::v_int32x4 centre = cell(5, 6, 9, 10);
+        // Same neighbour order and bits as lbpCode
+        const cv::v_int32x4 code = bit(cell(0, 1, 4, 5) >= centre, 128) |
+                                   bit(cell(1, 2, 5, 6) >= centre, 64) |
+                                   bit(cell(2, 3, 6, 7) >= centre, 32) |
+                                   bit(cell(6, 7, 10, 11) >= centre, 16) |
+                                   bit(cell(10, 11, 14, 15) >= centre, 8) |
+                                   bit(cell(9, 10, 13, 14) >= centre, 4) |
+                                   bit(cell(8, 9, 12, 13) >= centre, 2) |
+                                   bit(cell(4, 5, 8, 9) >= centre, 1);
+        cv::v_store_aligned(codes, code);
+
+        for (int lane = 0; lane < kLanes; ++lane) {
+          const int c = codes[lane];
+          sums[lane] += stump->leaves[(stump->subset[c >> 5] & (1u << (c & 31))) ? 0 : 1];
+        }
+      }
+
+      for (int lane = 0; lane < kLanes; ++lane) {
+        if ((alive & (1 << lane)) && sums[lane] < stage.threshold) {
+          results[lane] = -static_cast<int>(stageIndex);
+          alive &= ~(1 << lane);
+        }
+      }
+      if (!alive) {
+        return;
+      }
+    }
+
+    for (int lane = 0; lane < kLanes; ++lane) {
+      if (alive & (1 << lane)) {
+        results[lane] = 1;
+      }
+    }
+  }
+}
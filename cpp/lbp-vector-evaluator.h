@@ -0,0 +1,52 @@
+#ifndef VISIONCAMERAPLUGINANPR_LBPVECTOREVALUATOR_H
+#define VISIONCAMERAPLUGINANPR_LBPVECTOREVALUATOR_H
+
+#include "lbp-cascade.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace visioncamerapluginanpr {
+  // Evaluates an LbpCascade on several neighbouring windows at once, with OpenCV's universal intrinsics (NEON on
+  // Android, SSE on x86). The LBP codes of all lanes are computed together; the leaf sums stay per lane, in double
+  // and in the same order as evaluateLbpCascade, so every window gets exactly the result it would get on its own.
+  //
+  // The cascade is flattened for one integral image row step: each stump carries its feature's corner offsets next
+  // to its subset and leaves, and stumps are stored in stage order, so a stage reads one contiguous run of memory.
+  class LbpVectorEvaluator {
+    public:
+      // Windows evaluated per call
+      static constexpr int kLanes = 4;
+      // Columns the integral image must have past the right edge of the last window, as a lane beyond it may read them
+      static constexpr int kPadding = 2 * kLanes;
+
+      LbpVectorEvaluator(const LbpCascade& cascade, size_t integralStep);
+
+      size_t integralStep() const { return step; }
+
+      // Evaluates the windows whose top-left corners are at window + lane * stride, for a stride of 1 or 2, and writes
+      // each one's evaluateLbpCascade result to results[lane]. Lanes past the end of a row return garbage.
+      void evaluate(const int* window, int stride, int* results) const;
+
+    private:
+      struct Stump {
+        LbpFeatureOffsets offsets;
+        std::array<uint32_t, 8> subset;
+        std::array<float, 2> leaves;
+      };
+
+      struct Stage {
+        float threshold;
+        // One past the stage's last stump
+        uint32_t end;
+      };
+
+      size_t step;
+      std::vector<Stump> stumps;
+      std::vector<Stage> stages;
+  };
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_LBPVECTOREVALUATOR_H */
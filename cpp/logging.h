@@ -0,0 +1,18 @@
+#ifndef VISIONCAMERAPLUGINANPR_LOGGING_H
+#define VISIONCAMERAPLUGINANPR_LOGGING_H
+
+// Logs to logcat on Android and to stderr everywhere else, so the core builds on the host unchanged
+#if defined(__ANDROID__)
+  #include <android/log.h>
+
+  #define LOG_TAG "ReactNative"
+  #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+  #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#else
+  #include <cstdio>
+
+  #define LOGI(...) (std::fprintf(stderr, "I/anpr: " __VA_ARGS__), std::fputc('\n', stderr))
+  #define LOGE(...) (std::fprintf(stderr, "E/anpr: " __VA_ARGS__), std::fputc('\n', stderr))
+#endif
+
+#endif /* VISIONCAMERAPLUGINANPR_LOGGING_H */
@@ -0,0 +1,69 @@
+#include "motion-gate.h"
+#include "motiondetector.h"
+#include "opencv2/imgproc.hpp"
+
+#include <algorithm>
+
+namespace visioncamerapluginanpr {
+  // Margin added around the motion box, as a fraction of its size, so plates on its edge are not clipped
+  static const double kRegionPadding = 0.1;
+
+  MotionGate::MotionGate(int analysisSize)
+    : analysisSize(std::max(16, analysisSize)), framesChecked(0), framesStatic(0) {}
+
+  MotionGate::~MotionGate() = default;
+
+  bool MotionGate::detect(const cv::Mat& luma, FrameRotation rotation, bool mirrored, cv::Rect& region) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const int longSide = std::max(luma.cols, luma.rows);
+    const double scale = std::min(1.0, static_cast<double>(analysisSize) / longSide);
+    cv::Size reducedSize(std::max(1, cvRound(luma.cols * scale)), std::max(1, cvRound(luma.rows * scale)));
+
+    // Reduce first and rotate the small copy, so a static frame never touches the full-size plane again
+    cv::resize(luma, reduced, reducedSize, 0, 0, cv::INTER_AREA);
+
+    const bool transposed = isTransposed(rotation);
+    reducedUpright.create(transposed ? reduced.cols : reduced.rows, transposed ? reduced.rows : reduced.cols, CV_8UC1);
+    rotatePlane(reduced.data, reduced.cols, reduced.rows, reduced.step, reducedUpright.data, reducedUpright.step, rotation, mirrored);
+
+    // The background model only makes sense for one frame geometry
+    if (!detector || detectorSize != reducedUpright.size()) {
+      detector = std::make_unique<alpr::MotionDetector>();
+      detectorSize = reducedUpright.size();
+    }
+
+    ++framesChecked;
+    cv::Rect motion = detector->MotionDetect(&reducedUpright);
+
+    if (motion.area() == 0) {
+      ++framesStatic;
+      return false;
+    }
+
+    const int uprightWidth = transposed ? luma.rows : luma.cols;
+    const int uprightHeight = transposed ? luma.cols : luma.rows;
+    const double scaleX = static_cast<double>(uprightWidth) / reducedUpright.cols;
+    const double scaleY = static_cast<double>(uprightHeight) / reducedUpright.rows;
+
+    const double padX = motion.width * kRegionPadding + 1;
+    const double padY = motion.height * kRegionPadding + 1;
+    const int left = cvFloor((motion.x - padX) * scaleX);
+    const int top = cvFloor((motion.y - padY) * scaleY);
+    const int right = cvCeil((motion.x + motion.width + padX) * scaleX);
+    const int bottom = cvCeil((motion.y + motion.height + padY) * scaleY);
+
+    region = cv::Rect(cv::Point(left, top), cv::Point(right, bottom)) & cv::Rect(0, 0, uprightWidth, uprightHeight);
+    return true;
+  }
+
+  void MotionGate::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    detector.reset();
+  }
+
+  MotionGateStats MotionGate::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return MotionGateStats{ framesChecked, framesStatic };
+  }
+}
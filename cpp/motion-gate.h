@@ -0,0 +1,56 @@
+#ifndef VISIONCAMERAPLUGINANPR_MOTIONGATE_H
+#define VISIONCAMERAPLUGINANPR_MOTIONGATE_H
+
+#include "frame-rotation.h"
+#include "opencv2/core.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace alpr {
+  class MotionDetector;
+}
+
+namespace visioncamerapluginanpr {
+  struct MotionGateStats {
+    uint64_t framesChecked;
+    // Frames in which nothing moved, so recognition was skipped
+    uint64_t framesStatic;
+  };
+
+  // Runs OpenALPR's MOG2 motion detector on a heavily downscaled copy of each frame, so fixed cameras
+  // only pay for recognition when something moves, and then only inside the moving region.
+  class MotionGate {
+    public:
+      // Frames are reduced until their longer side is at most `analysisSize` pixels
+      explicit MotionGate(int analysisSize = 160);
+      ~MotionGate();
+
+      MotionGate(const MotionGate&) = delete;
+      MotionGate& operator=(const MotionGate&) = delete;
+
+      // `luma` is the frame as it comes off the sensor; rotation and mirroring describe how it is turned upright.
+      // Returns false if nothing moved. Otherwise sets `region` to the padded motion bounding box in upright frame coordinates.
+      bool detect(const cv::Mat& luma, FrameRotation rotation, bool mirrored, cv::Rect& region);
+
+      // Drops the learned background, e.g. when the camera moves
+      void reset();
+
+      MotionGateStats stats() const;
+
+    private:
+      int analysisSize;
+
+      mutable std::mutex mutex;
+      std::unique_ptr<alpr::MotionDetector> detector;
+      cv::Size detectorSize;
+      cv::Mat reduced;
+      cv::Mat reducedUpright;
+
+      uint64_t framesChecked;
+      uint64_t framesStatic;
+  };
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_MOTIONGATE_H */
@@ -0,0 +1,303 @@
+#include "plate-regions.h"
+#include "frame-window.h"
+#include "alpr_impl.h"
+#include "opencv2/core/utility.hpp"
+#include "opencv2/imgproc.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace visioncamerapluginanpr {
+  // Sets a Config flag for the duration of a scope, restoring it even if recognition throws
+  class ConfigFlagScope {
+    public:
+      explicit ConfigFlagScope(bool& flag) : flag(flag), previous(flag) {
+        flag = true;
+      }
+
+      ~ConfigFlagScope() {
+        flag = previous;
+      }
+
+    private:
+      bool& flag;
+      bool previous;
+  };
+
+  // Context kept around each plate read from full resolution, as a fraction of the plate's size
+  static const double kPlateCropPadding = 0.25;
+
+  alpr::AlprResults emptyResults(const cv::Size& imageSize) {
+    alpr::AlprResults results;
+    results.epoch_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+    results.img_width = imageSize.width;
+    results.img_height = imageSize.height;
+    results.total_processing_time_ms = 0;
+    return results;
+  }
+
+  // Scales a rectangle outwards, so it still covers everything it covered before
+  static cv::Rect scaleRect(const cv::Rect& rect, double scaleX, double scaleY) {
+    return cv::Rect(cv::Point(cvFloor(rect.x * scaleX), cvFloor(rect.y * scaleY)),
+                    cv::Point(cvCeil(rect.br().x * scaleX), cvCeil(rect.br().y * scaleY)));
+  }
+
+  PlateRegionDetectors::PlateRegionDetectors() = default;
+  PlateRegionDetectors::~PlateRegionDetectors() = default;
+
+  PlateRegionDetectors::EngineDetector& PlateRegionDetectors::detectorFor(alpr::AlprImpl& engine) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<EngineDetector>& entry = detectors[&engine];
+    if (!entry) {
+      entry = std::make_unique<EngineDetector>();
+      entry->prewarp = std::make_unique<alpr::PreWarp>(engine.config);
+      // Every engine may scan at the same time, so each gets its share of OpenCV's threads
+      const int scanThreads = std::max(1, cv::getNumThreads() / engineCount);
+      entry->detector = createPlateDetector(engine.config, entry->prewarp.get(), detectorType, scanThreads);
+    }
+    return *entry;
+  }
+
+  std::vector<cv::Rect> PlateRegionDetectors::detect(alpr::AlprImpl& engine, const cv::Mat& image, const std::vector<cv::Rect>& regionsOfInterest) {
+    EngineDetector& engineDetector = detectorFor(engine);
+
+    cv::Mat gray = image;
+    if (image.channels() == 3) {
+      cv::cvtColor(image, engineDetector.gray, cv::COLOR_BGR2GRAY);
+      gray = engineDetector.gray;
+    }
+
+    std::vector<cv::Rect> searchRegions = regionsOfInterest;
+    if (searchRegions.empty()) {
+      searchRegions.push_back(cv::Rect(0, 0, gray.cols, gray.rows));
+    }
+
+    std::vector<cv::Rect> plateRegions;
+    for (const alpr::PlateRegion& region : engineDetector.detector->detect(gray, searchRegions)) {
+      plateRegions.push_back(region.rect);
+    }
+
+    return plateRegions;
+  }
+
+  std::vector<cv::Rect> PlateRegionDetectors::detectReduced(alpr::AlprImpl& engine, const cv::Mat& source, FrameRotation rotation,
+                                                            bool mirrored, const std::vector<cv::Rect>& regionsOfInterest) {
+    EngineDetector& engineDetector = detectorFor(engine);
+
+    const bool transposed = isTransposed(rotation);
+    const cv::Size uprightSize = transposed ? cv::Size(source.rows, source.cols) : source.size();
+    const double scale = std::min({ 1.0,
+      static_cast<double>(engine.config->maxDetectionInputWidth) / uprightSize.width,
+      static_cast<double>(engine.config->maxDetectionInputHeight) / uprightSize.height });
+
+    // Reduce first and rotate the small copy; Detector would otherwise scale the rotated full-size plane down itself
+    cv::Mat reduced = source;
+    if (scale < 1.0) {
+      cv::Size reducedSize(std::max(1, cvRound(source.cols * scale)), std::max(1, cvRound(source.rows * scale)));
+      cv::resize(source, engineDetector.reduced, reducedSize, 0, 0, cv::INTER_AREA);
+      reduced = engineDetector.reduced;
+    }
+
+    engineDetector.reducedUpright.create(transposed ? reduced.cols : reduced.rows, transposed ? reduced.rows : reduced.cols, CV_8UC1);
+    cv::Mat& upright = engineDetector.reducedUpright;
+    rotatePlane(reduced.data, reduced.cols, reduced.rows, reduced.step, upright.data, upright.step, rotation, mirrored);
+
+    return detectInReduced(engineDetector, upright, uprightSize, regionsOfInterest);
+  }
+
+  std::vector<cv::Rect> PlateRegionDetectors::detectScaled(alpr::AlprImpl& engine, const cv::Mat& reduced, const cv::Size& fullSize,
+                                                           const std::vector<cv::Rect>& regionsOfInterest) {
+    return detectInReduced(detectorFor(engine), reduced, fullSize, regionsOfInterest);
+  }
+
+  std::vector<cv::Rect> PlateRegionDetectors::detectInReduced(EngineDetector& engineDetector, const cv::Mat& reduced,
+                                                              const cv::Size& fullSize, const std::vector<cv::Rect>& regionsOfInterest) {
+    const double scaleX = static_cast<double>(reduced.cols) / fullSize.width;
+    const double scaleY = static_cast<double>(reduced.rows) / fullSize.height;
+    const cv::Rect reducedBounds(0, 0, reduced.cols, reduced.rows);
+    const cv::Rect fullBounds(cv::Point(), fullSize);
+
+    std::vector<cv::Rect> searchRegions;
+    for (const cv::Rect& region : regionsOfInterest) {
+      cv::Rect reducedRegion = scaleRect(region, scaleX, scaleY) & reducedBounds;
+      if (!reducedRegion.empty()) {
+        searchRegions.push_back(reducedRegion);
+      }
+    }
+    if (searchRegions.empty()) {
+      searchRegions.push_back(reducedBounds);
+    }
+
+    std::vector<cv::Rect> plateRegions;
+    for (const alpr::PlateRegion& region : engineDetector.detector->detect(reduced, searchRegions)) {
+      cv::Rect fullRegion = scaleRect(region.rect, 1.0 / scaleX, 1.0 / scaleY) & fullBounds;
+      if (!fullRegion.empty()) {
+        plateRegions.push_back(fullRegion);
+      }
+    }
+
+    return plateRegions;
+  }
+
+  void PlateRegionDetectors::invalidate(alpr::AlprImpl& engine) {
+    std::lock_guard<std::mutex> lock(mutex);
+    detectors.erase(&engine);
+  }
+
+  void PlateRegionDetectors::setDetectorType(PlateDetectorType type) {
+    std::lock_guard<std::mutex> lock(mutex);
+    detectorType = type;
+  }
+
+  PlateDetectorType PlateRegionDetectors::getDetectorType() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return detectorType;
+  }
+
+  void PlateRegionDetectors::setEngineCount(int count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    engineCount = std::max(1, count);
+  }
+
+  // Adds the plates and regions read from one part of an image to the results for all of it
+  static void appendResults(alpr::AlprResults& combined, alpr::AlprResults results) {
+    for (alpr::AlprPlateResult& plate : results.plates) {
+      plate.plate_index = static_cast<int>(combined.plates.size());
+      combined.plates.push_back(std::move(plate));
+    }
+    combined.regionsOfInterest.insert(combined.regionsOfInterest.end(), results.regionsOfInterest.begin(), results.regionsOfInterest.end());
+    combined.total_processing_time_ms += results.total_processing_time_ms;
+  }
+
+  alpr::AlprResults recognizePlateRegions(alpr::AlprImpl& engine, const cv::Mat& image, const std::vector<cv::Rect>& plateRegions,
+                                          RecognitionTimings* timings) {
+    if (plateRegions.empty()) {
+      return emptyResults(image.size());
+    }
+
+    // With detection skipped, OpenALPR treats every region of interest as a plate region
+    ConfigFlagScope skipDetection(engine.config->skipDetection);
+    if (!timings) {
+      return engine.recognize(image, plateRegions);
+    }
+
+    ConfigFlagScope debugTiming(engine.config->debugTiming);
+    alpr::AlprResults combined = emptyResults(image.size());
+    for (const cv::Rect& region : plateRegions) {
+      CandidateTiming candidate;
+      candidate.region = region;
+
+      alpr::AlprResults results;
+      {
+        StageTimingCapture capture;
+        results = engine.recognize(image, std::vector<cv::Rect>{ region });
+        candidate.stages = capture.timings();
+      }
+
+      if (!results.plates.empty()) {
+        candidate.plateIndex = static_cast<int>(combined.plates.size());
+      }
+      appendResults(combined, std::move(results));
+      addCandidateTiming(*timings, std::move(candidate));
+    }
+
+    return combined;
+  }
+
+  alpr::AlprResults recognizeTimed(alpr::AlprImpl& engine, const cv::Mat& image, const std::vector<cv::Rect>& regionsOfInterest,
+                                   RecognitionTimings& timings) {
+    ConfigFlagScope debugTiming(engine.config->debugTiming);
+    alpr::AlprResults results;
+    std::vector<StageTiming> stages;
+    {
+      StageTimingCapture capture;
+      results = regionsOfInterest.empty() ? engine.recognize(image) : engine.recognize(image, regionsOfInterest);
+      stages = capture.timings();
+    }
+
+    for (const StageTiming& stage : stages) {
+      addStageTiming(timings.stages, stage.stage, stage.ms, stage.runs);
+      if (stage.stage == "thresholds") {
+        timings.thresholdPasses += stage.runs;
+      }
+    }
+    return results;
+  }
+
+  alpr::AlprResults recognizeSourceRegions(alpr::AlprImpl& engine, const cv::Mat& source, FrameRotation rotation, bool mirrored,
+                                           const std::vector<cv::Rect>& plateRegions, RecognitionTimings* timings) {
+    const cv::Size uprightSize = isTransposed(rotation) ? cv::Size(source.rows, source.cols) : source.size();
+    const cv::Rect uprightBounds(cv::Point(), uprightSize);
+    alpr::AlprResults combined = emptyResults(uprightSize);
+
+    for (const cv::Rect& region : plateRegions) {
+      const int padX = cvCeil(region.width * kPlateCropPadding);
+      const int padY = cvCeil(region.height * kPlateCropPadding);
+      const cv::Rect crop = cv::Rect(region.x - padX, region.y - padY, region.width + 2 * padX, region.height + 2 * padY) & uprightBounds;
+      if (crop.empty()) {
+        continue;
+      }
+
+      cv::Mat sourceCrop = source(toCvRect(unrotateRect(toPlaneRect(crop), source.cols, source.rows, rotation, mirrored)));
+      cv::Mat upright;
+      if (rotation != FrameRotation::None || mirrored) {
+        upright.create(crop.height, crop.width, CV_8UC1);
+        rotatePlane(sourceCrop.data, sourceCrop.cols, sourceCrop.rows, sourceCrop.step, upright.data, upright.step, rotation, mirrored);
+      } else {
+        upright = sourceCrop;
+      }
+
+      RecognitionTimings cropTimings;
+      alpr::AlprResults results = recognizePlateRegions(engine, upright, { (region & crop) - crop.tl() },
+                                                        timings ? &cropTimings : nullptr);
+      offsetResults(results, crop.tl());
+
+      if (timings) {
+        // A crop holds a single candidate; its plate, if any, is appended next
+        for (CandidateTiming& candidate : cropTimings.candidates) {
+          candidate.region += crop.tl();
+          if (candidate.plateIndex >= 0) {
+            candidate.plateIndex = static_cast<int>(combined.plates.size());
+          }
+          addCandidateTiming(*timings, std::move(candidate));
+        }
+      }
+
+      appendResults(combined, std::move(results));
+    }
+
+    return combined;
+  }
+
+  void offsetResults(alpr::AlprResults& results, const cv::Point& offset) {
+    if (offset == cv::Point()) {
+      return;
+    }
+
+    auto movePlate = [&offset](alpr::AlprPlate& plate) {
+      for (alpr::AlprChar& character : plate.character_details) {
+        for (alpr::AlprCoordinate& corner : character.corners) {
+          corner.x += offset.x;
+          corner.y += offset.y;
+        }
+      }
+    };
+
+    for (alpr::AlprPlateResult& plate : results.plates) {
+      for (alpr::AlprCoordinate& point : plate.plate_points) {
+        point.x += offset.x;
+        point.y += offset.y;
+      }
+      movePlate(plate.bestPlate);
+      for (alpr::AlprPlate& candidate : plate.topNPlates) {
+        movePlate(candidate);
+      }
+    }
+
+    for (alpr::AlprRegionOfInterest& region : results.regionsOfInterest) {
+      region.x += offset.x;
+      region.y += offset.y;
+    }
+  }
+}
@@ -0,0 +1,103 @@
+#ifndef VISIONCAMERAPLUGINANPR_PLATEREGIONS_H
+#define VISIONCAMERAPLUGINANPR_PLATEREGIONS_H
+
+#include "alpr.h"
+#include "cascade-detector.h"
+#include "frame-rotation.h"
+#include "stage-timing.h"
+#include "opencv2/core.hpp"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace alpr {
+  class AlprImpl;
+  class Detector;
+  class PreWarp;
+}
+
+namespace visioncamerapluginanpr {
+  // Plate detectors built from each engine's configuration, so detection can run on its own and OCR
+  // only on the regions that need it. A detector is only used on its engine's worker thread.
+  class PlateRegionDetectors {
+    public:
+      PlateRegionDetectors();
+      ~PlateRegionDetectors();
+
+      PlateRegionDetectors(const PlateRegionDetectors&) = delete;
+      PlateRegionDetectors& operator=(const PlateRegionDetectors&) = delete;
+
+      // Finds plate regions in an image, converting a BGR one to grayscale first as AlprImpl does. An empty list of
+      // regions of interest searches the whole image.
+      std::vector<cv::Rect> detect(alpr::AlprImpl& engine, const cv::Mat& image, const std::vector<cv::Rect>& regionsOfInterest);
+
+      // Finds plate regions in a window of a camera plane that is not upright yet. The window is reduced to fit the
+      // engine's max_detection_input_width/height before it is rotated, so its full-resolution pixels are only read
+      // once. Regions of interest and the returned regions are in full-resolution upright window coordinates.
+      std::vector<cv::Rect> detectReduced(alpr::AlprImpl& engine, const cv::Mat& source, FrameRotation rotation, bool mirrored,
+                                          const std::vector<cv::Rect>& regionsOfInterest);
+
+      // Finds plate regions in a reduced copy of an image whose full size is `fullSize`, such as a JPEG decoded at a
+      // fraction of its size. Regions of interest and the returned regions are in full-resolution coordinates.
+      std::vector<cv::Rect> detectScaled(alpr::AlprImpl& engine, const cv::Mat& reduced, const cv::Size& fullSize,
+                                         const std::vector<cv::Rect>& regionsOfInterest);
+
+      // Drops the engine's detector so the next detect() rebuilds it, e.g. after its country or mask changed.
+      // Call it while the engine is idle, such as from EnginePool::configureAll.
+      void invalidate(alpr::AlprImpl& engine);
+
+      // Kind of detector built for engines from now on; SharedCascade unless set. An engine keeps the detector it
+      // has until it is invalidated.
+      void setDetectorType(PlateDetectorType type);
+      PlateDetectorType getDetectorType();
+
+      // Number of engines detecting side by side. Detectors built from now on share OpenCV's threads out between them,
+      // so every engine scanning at once does not oversubscribe the CPU.
+      void setEngineCount(int count);
+
+    private:
+      struct EngineDetector {
+        std::unique_ptr<alpr::PreWarp> prewarp;
+        std::unique_ptr<alpr::Detector> detector;
+        // Scratch planes for detect and detectReduced, reused across frames
+        cv::Mat gray;
+        cv::Mat reduced;
+        cv::Mat reducedUpright;
+      };
+
+      EngineDetector& detectorFor(alpr::AlprImpl& engine);
+      std::vector<cv::Rect> detectInReduced(EngineDetector& engineDetector, const cv::Mat& reduced, const cv::Size& fullSize,
+                                            const std::vector<cv::Rect>& regionsOfInterest);
+
+      std::mutex mutex;
+      std::unordered_map<alpr::AlprImpl*, std::unique_ptr<EngineDetector>> detectors;
+      PlateDetectorType detectorType = PlateDetectorType::SharedCascade;
+      int engineCount = 1;
+  };
+
+  // Runs OCR on the given plate regions only, skipping the engine's own detection pass. With `timings`, each
+  // region is read on its own so the stages OpenALPR ran on it can be recorded as one candidate.
+  alpr::AlprResults recognizePlateRegions(alpr::AlprImpl& engine, const cv::Mat& image, const std::vector<cv::Rect>& plateRegions,
+                                          RecognitionTimings* timings = nullptr);
+
+  // Reads an image with engine.recognize, detection included, exactly as an untimed read does, and records the stages
+  // OpenALPR printed. One call's output cannot be told apart by plate region, so stages are summed over every
+  // candidate and no per-candidate timings are recorded.
+  alpr::AlprResults recognizeTimed(alpr::AlprImpl& engine, const cv::Mat& image, const std::vector<cv::Rect>& regionsOfInterest,
+                                   RecognitionTimings& timings);
+
+  // Fetches each plate region, with some surrounding context, from a camera plane window at full resolution, rotates
+  // just that crop upright and reads it. Regions and results are in upright window coordinates.
+  alpr::AlprResults recognizeSourceRegions(alpr::AlprImpl& engine, const cv::Mat& source, FrameRotation rotation, bool mirrored,
+                                           const std::vector<cv::Rect>& plateRegions, RecognitionTimings* timings = nullptr);
+
+  // Results of an image of the given size in which no plates were found
+  alpr::AlprResults emptyResults(const cv::Size& imageSize);
+
+  // Moves plate, character and region of interest coordinates by `offset`
+  void offsetResults(alpr::AlprResults& results, const cv::Point& offset);
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_PLATEREGIONS_H */
@@ -0,0 +1,278 @@
+#include "plate-tracker.h"
+
+#include <algorithm>
+#include <climits>
+
+// From OpenALPR's utility.h, which pulls in all of OpenCV
+namespace alpr {
+  int levenshteinDistance(const std::string& s1, const std::string& s2, int max);
+}
+
+namespace visioncamerapluginanpr {
+  static cv::Rect regionOf(const alpr::AlprPlateResult& plate) {
+    int left = INT_MAX, top = INT_MAX, right = INT_MIN, bottom = INT_MIN;
+    for (const alpr::AlprCoordinate& point : plate.plate_points) {
+      left = std::min(left, point.x);
+      top = std::min(top, point.y);
+      right = std::max(right, point.x);
+      bottom = std::max(bottom, point.y);
+    }
+    return cv::Rect(cv::Point(left, top), cv::Point(right, bottom));
+  }
+
+  static double intersectionOverUnion(const cv::Rect& a, const cv::Rect& b) {
+    const double intersection = (a & b).area();
+    const double combined = static_cast<double>(a.area()) + b.area() - intersection;
+    return combined > 0 ? intersection / combined : 0;
+  }
+
+  void PlateTracker::configure(const PlateTrackerConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex);
+    settings = config;
+    settings.topN = std::max<size_t>(1, config.topN);
+  }
+
+  PlateTrackerConfig PlateTracker::config() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return settings;
+  }
+
+  bool PlateTracker::coveredByConvergedTrack(const cv::Rect& region, double now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    expireTracks(now);
+
+    for (Track& track : tracks) {
+      if (track.converged && intersectionOverUnion(track.region, region) >= settings.minIoU) {
+        if (now >= track.lastSeenMs) {
+          track.region = region;
+          track.lastSeenMs = now;
+        }
+        ++readsSkipped;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  alpr::AlprResults PlateTracker::update(const alpr::AlprResults& results, double now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    expireTracks(now);
+
+    std::vector<bool> matched(tracks.size(), false);
+    std::vector<size_t> seen;
+
+    for (const alpr::AlprPlateResult& plate : results.plates) {
+      const cv::Rect region = regionOf(plate);
+
+      // Prefer overlap; fall back to a close reading for plates that moved far between frames
+      size_t bestTrack = tracks.size();
+      double bestScore = 0;
+      for (size_t i = 0; i < tracks.size(); ++i) {
+        if (matched[i]) {
+          continue;
+        }
+
+        double score = 0;
+        double overlap = intersectionOverUnion(tracks[i].region, region);
+        if (overlap >= settings.minIoU) {
+          score = 1 + overlap;
+        } else if (const Vote* lead = leadingVote(tracks[i])) {
+          int distance = alpr::levenshteinDistance(lead->plate.characters, plate.bestPlate.characters, settings.maxEditDistance);
+          if (distance <= settings.maxEditDistance) {
+            score = 1 - static_cast<double>(distance) / (settings.maxEditDistance + 1);
+          }
+        }
+
+        if (score > bestScore) {
+          bestScore = score;
+          bestTrack = i;
+        }
+      }
+
+      if (bestTrack == tracks.size()) {
+        Track track;
+        track.id = nextTrackId++;
+        track.region = region;
+        track.observations = 0;
+        track.converged = false;
+        track.completed = false;
+        track.firstSeenMs = now;
+        track.lastSeenMs = now;
+        tracks.push_back(std::move(track));
+        matched.push_back(false);
+        ++tracksStarted;
+      }
+
+      matched[bestTrack] = true;
+      addObservation(tracks[bestTrack], plate, region, now);
+      seen.push_back(bestTrack);
+    }
+
+    // Converged tracks kept alive by coveredByConvergedTrack for this frame are part of its results too
+    for (size_t i = 0; i < tracks.size(); ++i) {
+      if (!matched[i] && tracks[i].converged && tracks[i].lastSeenMs == now) {
+        seen.push_back(i);
+      }
+    }
+
+    alpr::AlprResults consolidated;
+    consolidated.epoch_time = results.epoch_time;
+    consolidated.frame_number = results.frame_number;
+    consolidated.img_width = results.img_width;
+    consolidated.img_height = results.img_height;
+    consolidated.total_processing_time_ms = results.total_processing_time_ms;
+    consolidated.regionsOfInterest = results.regionsOfInterest;
+
+    for (size_t i : seen) {
+      consolidated.plates.push_back(consensusOf(tracks[i]));
+      consolidated.plates.back().plate_index = static_cast<int>(consolidated.plates.size() - 1);
+    }
+
+    return consolidated;
+  }
+
+  void PlateTracker::addObservation(Track& track, const alpr::AlprPlateResult& plate, const cv::Rect& region, double now) {
+    ++track.observations;
+    if (now >= track.lastSeenMs) {
+      track.region = region;
+      track.lastSeenMs = now;
+      track.latest = plate;
+    } else if (track.observations == 1) {
+      track.latest = plate;
+    }
+
+    // Every candidate votes with its confidence, so a reading that is second best in most frames
+    // can still beat one that wins a single frame
+    const std::vector<alpr::AlprPlate>& candidates = plate.topNPlates;
+    auto vote = [&track](const alpr::AlprPlate& candidate) {
+      auto inserted = track.votes.emplace(candidate.characters, Vote{ 0, 0, candidate });
+      Vote& entry = inserted.first->second;
+      entry.scoreTotal += candidate.overall_confidence;
+      ++entry.count;
+      if (candidate.overall_confidence > entry.plate.overall_confidence) {
+        entry.plate = candidate;
+      }
+    };
+
+    if (candidates.empty()) {
+      vote(plate.bestPlate);
+    } else {
+      for (const alpr::AlprPlate& candidate : candidates) {
+        vote(candidate);
+      }
+    }
+
+    const Vote* lead = leadingVote(track);
+    if (!track.converged && lead && track.observations >= settings.minObservations &&
+        lead->scoreTotal / track.observations >= settings.convergedConfidence) {
+      track.converged = true;
+      ++tracksConverged;
+      complete(track);
+    }
+  }
+
+  const PlateTracker::Vote* PlateTracker::leadingVote(const Track& track) const {
+    const Vote* lead = nullptr;
+    for (const auto& entry : track.votes) {
+      if (!lead || entry.second.scoreTotal > lead->scoreTotal) {
+        lead = &entry.second;
+      }
+    }
+    return lead;
+  }
+
+  alpr::AlprPlateResult PlateTracker::consensusOf(const Track& track) const {
+    alpr::AlprPlateResult consensus = track.latest;
+    consensus.plate_points[0] = { track.region.x, track.region.y };
+    consensus.plate_points[1] = { track.region.x + track.region.width, track.region.y };
+    consensus.plate_points[2] = { track.region.x + track.region.width, track.region.y + track.region.height };
+    consensus.plate_points[3] = { track.region.x, track.region.y + track.region.height };
+
+    if (track.votes.empty() || track.observations == 0) {
+      return consensus;
+    }
+
+    std::vector<const Vote*> ranked;
+    for (const auto& entry : track.votes) {
+      ranked.push_back(&entry.second);
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const Vote* a, const Vote* b) {
+      return a->scoreTotal > b->scoreTotal;
+    });
+
+    // Confidence is the mean over all observations, so readings missing from some frames rank lower
+    consensus.topNPlates.clear();
+    for (size_t i = 0; i < ranked.size() && i < settings.topN; ++i) {
+      alpr::AlprPlate plate = ranked[i]->plate;
+      plate.overall_confidence = ranked[i]->scoreTotal / track.observations;
+      consensus.topNPlates.push_back(std::move(plate));
+    }
+
+    consensus.bestPlate = consensus.topNPlates.front();
+    consensus.requested_topn = static_cast<int>(settings.topN);
+    return consensus;
+  }
+
+  PlateTrack PlateTracker::snapshotOf(const Track& track) const {
+    return PlateTrack{ track.id, consensusOf(track), track.observations, track.converged, track.firstSeenMs, track.lastSeenMs };
+  }
+
+  void PlateTracker::complete(Track& track) {
+    if (!track.completed) {
+      track.completed = true;
+      if (completed.size() == kMaxCompletedTracks) {
+        completed.pop_front();
+        ++completedDropped;
+      }
+      completed.push_back(snapshotOf(track));
+    }
+  }
+
+  void PlateTracker::expireTracks(double now) {
+    for (Track& track : tracks) {
+      if (now - track.lastSeenMs > settings.trackTimeoutMs) {
+        complete(track);
+      }
+    }
+
+    tracks.erase(std::remove_if(tracks.begin(), tracks.end(), [&](const Track& track) {
+      return now - track.lastSeenMs > settings.trackTimeoutMs;
+    }), tracks.end());
+  }
+
+  std::vector<PlateTrack> PlateTracker::activeTracks(double now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    expireTracks(now);
+
+    std::vector<PlateTrack> active;
+    for (const Track& track : tracks) {
+      active.push_back(snapshotOf(track));
+    }
+    return active;
+  }
+
+  std::vector<PlateTrack> PlateTracker::takeCompletedTracks(double now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    expireTracks(now);
+
+    std::vector<PlateTrack> taken(std::make_move_iterator(completed.begin()), std::make_move_iterator(completed.end()));
+    completed.clear();
+    return taken;
+  }
+
+  PlateTrackerStats PlateTracker::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return PlateTrackerStats{ tracksStarted, tracksConverged, readsSkipped, completedDropped };
+  }
+
+  void PlateTracker::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    tracks.clear();
+    completed.clear();
+    tracksStarted = 0;
+    tracksConverged = 0;
+    readsSkipped = 0;
+    completedDropped = 0;
+  }
+}
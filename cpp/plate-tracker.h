@@ -0,0 +1,119 @@
+#ifndef VISIONCAMERAPLUGINANPR_PLATETRACKER_H
+#define VISIONCAMERAPLUGINANPR_PLATETRACKER_H
+
+#include "alpr.h"
+#include "opencv2/core.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace visioncamerapluginanpr {
+  struct PlateTrackerConfig {
+    // Plates overlapping a track by at least this much belong to it
+    double minIoU = 0.3;
+    // Plates that moved further still belong to a track if their reading is this close to its consensus
+    int maxEditDistance = 2;
+    // Consensus confidence at which a track stops being read again
+    float convergedConfidence = 90;
+    // Frames a track must be read in before it can converge
+    int minObservations = 3;
+    // Tracks not seen for this long are finished
+    double trackTimeoutMs = 1500;
+    // Candidates kept in a consolidated plate's topNPlates
+    size_t topN = 10;
+  };
+
+  struct PlateTrack {
+    uint64_t id;
+    // Highest-voted reading across all observations, with its mean confidence per observation
+    alpr::AlprPlateResult consensus;
+    int observations;
+    bool converged;
+    double firstSeenMs;
+    double lastSeenMs;
+  };
+
+  struct PlateTrackerStats {
+    uint64_t tracksStarted;
+    uint64_t tracksConverged;
+    // Plate regions that were not read again because they belong to a converged track
+    uint64_t readsSkipped;
+    // Completed tracks discarded, oldest first, because takeCompletedTracks was not called often enough
+    uint64_t completedDropped;
+  };
+
+  // Follows plates across frames by overlap and reading, and combines their candidates into one
+  // consensus per vehicle, in the spirit of ResultAggregator's MERGE_COMBINE. Times are in milliseconds
+  // on any monotonic clock. Safe to use from several recognition threads.
+  class PlateTracker {
+    public:
+      // Completed tracks held for takeCompletedTracks. Beyond this the oldest are dropped, so an app that never
+      // takes them does not grow memory for as long as the camera runs.
+      static constexpr size_t kMaxCompletedTracks = 64;
+
+      void configure(const PlateTrackerConfig& config);
+      PlateTrackerConfig config() const;
+
+      // Returns true, and keeps the track alive, if `region` belongs to a converged track and need not be read again
+      bool coveredByConvergedTrack(const cv::Rect& region, double now);
+
+      // Adds the plates read in one frame. Returns the consensus for every track seen in that frame,
+      // in the shape of the frame's results.
+      alpr::AlprResults update(const alpr::AlprResults& results, double now);
+
+      // Tracks still in view
+      std::vector<PlateTrack> activeTracks(double now);
+
+      // Each track exactly once: when it converges, or when it is finished without converging. At most the newest
+      // kMaxCompletedTracks since the last call; see PlateTrackerStats::completedDropped.
+      std::vector<PlateTrack> takeCompletedTracks(double now);
+
+      PlateTrackerStats stats() const;
+
+      void reset();
+
+    private:
+      struct Vote {
+        float scoreTotal;
+        int count;
+        // Highest-confidence reading with this text, kept for its character details
+        alpr::AlprPlate plate;
+      };
+
+      struct Track {
+        uint64_t id;
+        cv::Rect region;
+        alpr::AlprPlateResult latest;
+        std::map<std::string, Vote> votes;
+        int observations;
+        bool converged;
+        bool completed;
+        double firstSeenMs;
+        double lastSeenMs;
+      };
+
+      void expireTracks(double now);
+      void addObservation(Track& track, const alpr::AlprPlateResult& plate, const cv::Rect& region, double now);
+      const Vote* leadingVote(const Track& track) const;
+      alpr::AlprPlateResult consensusOf(const Track& track) const;
+      PlateTrack snapshotOf(const Track& track) const;
+      void complete(Track& track);
+
+      mutable std::mutex mutex;
+      PlateTrackerConfig settings;
+      std::vector<Track> tracks;
+      std::deque<PlateTrack> completed;
+      uint64_t nextTrackId = 1;
+
+      uint64_t tracksStarted = 0;
+      uint64_t tracksConverged = 0;
+      uint64_t readsSkipped = 0;
+      uint64_t completedDropped = 0;
+  };
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_PLATETRACKER_H */
@@ -0,0 +1,741 @@
+#include "recognition-pipeline.h"
+#include "image-decoder.h"
+#include "jpeg-header.h"
+#include "logging.h"
+#include "runtime-bundle.h"
+#include "alpr_impl.h"
+#include "opencv2/imgproc.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+namespace visioncamerapluginanpr {
+  // Moves results read from a window of a frame into the coordinates of the whole frame
+  static void placeInFrame(alpr::AlprResults& results, const cv::Point& offset, const cv::Size& frameSize,
+                           RecognitionTimings* timings) {
+    results.img_width = frameSize.width;
+    results.img_height = frameSize.height;
+    offsetResults(results, offset);
+    if (timings) {
+      offsetTimings(*timings, offset);
+    }
+  }
+
+  // Runs a detector and records how long it took as the detection stage
+  template <typename Detect>
+  static std::vector<cv::Rect> timeDetection(RecognitionTimings* timings, Detect detect) {
+    const double start = FrameScheduler::nowMs();
+    std::vector<cv::Rect> plateRegions = detect();
+    if (timings) {
+      addStageTiming(timings->stages, "detection", FrameScheduler::nowMs() - start);
+    }
+    return plateRegions;
+  }
+
+  // Decodes an image and records how long it took as a run of the decode stage
+  static void timeDecode(RecognitionTimings* timings, const uint8_t* bytes, size_t size, cv::Mat& image,
+                         int reduction = 1, bool grayscale = false) {
+    const double start = FrameScheduler::nowMs();
+    if (!decodeImage(bytes, size, image, reduction, grayscale)) {
+      throw std::invalid_argument("Unable to decode image bytes");
+    }
+    if (timings) {
+      addStageTiming(timings->stages, "decode", FrameScheduler::nowMs() - start);
+    }
+  }
+
+  // Full size of a JPEG as decoded, from the size stored in its header and a reduced decode of it, which
+  // shows whether EXIF orientation turned it on its side
+  static cv::Size orientedSize(const cv::Size& storedSize, const cv::Size& reducedSize) {
+    const double asStored = std::abs(static_cast<double>(reducedSize.width) * storedSize.height -
+                                     static_cast<double>(reducedSize.height) * storedSize.width);
+    const double turned = std::abs(static_cast<double>(reducedSize.width) * storedSize.width -
+                                   static_cast<double>(reducedSize.height) * storedSize.height);
+    return turned < asStored ? cv::Size(storedSize.height, storedSize.width) : storedSize;
+  }
+
+  void RecognitionPipeline::setPaths(const std::string& configPath, const std::string& runtimePath) {
+    std::lock_guard<std::mutex> lock(enginesMutex);
+    this->configPath = configPath;
+    this->runtimePath = runtimePath;
+  }
+
+  void RecognitionPipeline::setRuntimeBundle(const std::string& bundlePath, const std::string& directory) {
+    std::lock_guard<std::mutex> lock(enginesMutex);
+    this->bundlePath = bundlePath;
+    bundleDirectory = directory;
+  }
+
+  // A grey street scene with one white plate on it, so a warm-up pass runs detection and every reading stage
+  static cv::Mat syntheticFrame(cv::Rect& plate) {
+    cv::Mat frame(720, 1280, CV_8UC3, cv::Scalar(96, 96, 96));
+    plate = cv::Rect(500, 420, 280, 70);
+    cv::rectangle(frame, plate, cv::Scalar(235, 235, 235), cv::FILLED);
+    cv::rectangle(frame, plate, cv::Scalar(20, 20, 20), 3);
+    cv::putText(frame, "ABC123", cv::Point(plate.x + 22, plate.y + 54), cv::FONT_HERSHEY_DUPLEX, 1.8, cv::Scalar(20, 20, 20), 4);
+    return frame;
+  }
+
+  RecognitionPipeline::~RecognitionPipeline() {
+    std::thread running;
+    {
+      std::lock_guard<std::mutex> lock(loaderMutex);
+      running = std::move(loader);
+    }
+    // Outside the lock, which the loader takes to hand out its result
+    if (running.joinable()) {
+      running.join();
+    }
+
+    // A running batch finishes first, while the engines it waits on are still there
+    {
+      std::lock_guard<std::mutex> lock(batchMutex);
+      stoppingBatches = true;
+    }
+    batchAvailable.notify_all();
+    if (batchThread.joinable()) {
+      batchThread.join();
+    }
+
+    // The worker and engine threads read the buffers, scheduler, detectors, tracker and stats, which are
+    // declared after `engines` and so would otherwise be destroyed while those threads still run
+    std::unique_ptr<FrameWorker> stopping;
+    {
+      std::lock_guard<std::mutex> lock(workerMutex);
+      stopping = std::move(worker);
+    }
+    stopping.reset();
+
+    std::shared_ptr<EnginePool> pool;
+    {
+      std::lock_guard<std::mutex> lock(enginesMutex);
+      pool = std::move(engines);
+    }
+    pool.reset();
+  }
+
+  InitializationTimings RecognitionPipeline::initialize(const std::string& country, int topN, const std::string& region,
+                                                        int engineCount, bool warmUp) {
+    std::lock_guard<std::mutex> initializeLock(initializeMutex);
+    std::string configPath;
+    std::string runtimePath;
+    std::string bundlePath;
+    std::string bundleDirectory;
+    {
+      std::lock_guard<std::mutex> lock(enginesMutex);
+      if (engines) {
+        return coldStart;
+      }
+      configPath = this->configPath;
+      runtimePath = this->runtimePath;
+      bundlePath = this->bundlePath;
+      bundleDirectory = this->bundleDirectory;
+    }
+
+    LOGI("Initializing OpenALPR with %d engine(s)%s...", engineCount, warmUp ? " and warming them up" : "");
+
+    if(!region.empty()) {
+      LOGI("Setting region to %s", region.c_str());
+    }
+
+    const double start = FrameScheduler::nowMs();
+    double bundleMs = 0;
+    if (!bundlePath.empty()) {
+      {
+        RuntimeBundle bundle(bundlePath);
+        if (bundle.extractTo(bundleDirectory)) {
+          LOGI("Extracted runtime data bundle %016llx", static_cast<unsigned long long>(bundle.version()));
+        }
+      }
+      // The bundle is a copy taken out of the APK only to extract it; the loaders read the extracted files. A load
+      // retried after a failure finds them already in place.
+      std::remove(bundlePath.c_str());
+      {
+        std::lock_guard<std::mutex> lock(enginesMutex);
+        this->bundlePath.clear();
+      }
+      bundleMs = FrameScheduler::nowMs() - start;
+    }
+
+    std::mutex timingsMutex;
+    std::vector<EngineLoadTiming> engineTimings;
+    detectors.setEngineCount(engineCount);
+
+    // Runs on each engine's worker thread, so engines are built and warmed up in parallel
+    auto pool = std::make_shared<EnginePool>(engineCount, [&, this]() {
+      EngineLoadTiming timing;
+      const double constructStart = FrameScheduler::nowMs();
+      auto engine = std::make_unique<alpr::AlprImpl>(country, configPath, runtimePath);
+
+      if(topN > 0) {
+        engine->setTopN(topN);
+      }
+
+      if(!region.empty()) {
+        engine->setDefaultRegion(region);
+      }
+      timing.constructMs = FrameScheduler::nowMs() - constructStart;
+
+      if (warmUp && engine->isLoaded()) {
+        this->warmUp(*engine, timing);
+      }
+
+      std::lock_guard<std::mutex> lock(timingsMutex);
+      engineTimings.push_back(std::move(timing));
+      return engine;
+    });
+
+    if (!pool->isLoaded()) {
+      LOGE("Error loading OpenALPR library");
+    } else {
+      LOGI("OpenALPR initialized successfully");
+    }
+
+    std::lock_guard<std::mutex> lock(enginesMutex);
+    coldStart.bundleMs = bundleMs;
+    coldStart.engines = std::move(engineTimings);
+    coldStart.totalMs = FrameScheduler::nowMs() - start;
+    initializeStartAt = start;
+    engines = std::move(pool);
+    return coldStart;
+  }
+
+  // Faults in the pages and caches a first recognition would otherwise pay for: OpenALPR's detector, the plugin's
+  // own detector, and every reading stage, which only runs on a region OpenALPR is told is a plate
+  void RecognitionPipeline::warmUp(alpr::AlprImpl& engine, EngineLoadTiming& timing) {
+    const double start = FrameScheduler::nowMs();
+    cv::Rect plate;
+    cv::Mat frame = syntheticFrame(plate);
+
+    try {
+      double stageStart = FrameScheduler::nowMs();
+      engine.recognize(frame);
+      addStageTiming(timing.warmUpStages, "detection", FrameScheduler::nowMs() - stageStart);
+
+      // OpenALPR's own detector is what engine.recognize just ran; building another would parse its cascade again
+      if (detectors.getDetectorType() != PlateDetectorType::OpenAlpr) {
+        stageStart = FrameScheduler::nowMs();
+        cv::Mat gray;
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+        detectors.detect(engine, gray, {});
+        addStageTiming(timing.warmUpStages, "plateDetector", FrameScheduler::nowMs() - stageStart);
+      }
+
+      RecognitionTimings read;
+      recognizePlateRegions(engine, frame, { plate }, &read);
+      for (const CandidateTiming& candidate : read.candidates) {
+        for (const StageTiming& stage : candidate.stages) {
+          addStageTiming(timing.warmUpStages, stage.stage, stage.ms, stage.runs);
+        }
+      }
+    } catch (const std::exception& e) {
+      // A failed warm-up only costs the first recognition its speed; that recognition reports the error itself
+      LOGE("Error warming up OpenALPR: %s", e.what());
+    }
+
+    timing.warmUpMs = FrameScheduler::nowMs() - start;
+  }
+
+  void RecognitionPipeline::initializeAsync(const std::string& country, int topN, const std::string& region, int engineCount,
+                                            bool warmUp, std::function<void(InitializationResult)> done) {
+    std::lock_guard<std::mutex> lock(loaderMutex);
+    loadWaiters.push_back(std::move(done));
+    if (loading) {
+      return;
+    }
+
+    // A previous load has already handed out its result, so this only waits for its thread to exit
+    if (loader.joinable()) {
+      loader.join();
+    }
+
+    loading = true;
+    loader = std::thread([this, country, topN, region, engineCount, warmUp]() {
+      InitializationResult result;
+      try {
+        result.timings = initialize(country, topN, region, engineCount, warmUp);
+      } catch (const std::exception& e) {
+        result.error = e.what();
+      }
+
+      std::vector<std::function<void(InitializationResult)>> waiters;
+      {
+        std::lock_guard<std::mutex> lock(loaderMutex);
+        waiters.swap(loadWaiters);
+        loading = false;
+      }
+      for (const auto& waiter : waiters) {
+        waiter(result);
+      }
+    });
+  }
+
+  std::optional<InitializationTimings> RecognitionPipeline::initializationTimings() {
+    std::lock_guard<std::mutex> lock(enginesMutex);
+    if (!engines) {
+      return std::nullopt;
+    }
+
+    InitializationTimings timings = coldStart;
+    const double firstResult = firstResultAt.load(std::memory_order_relaxed);
+    timings.firstResultMs = firstResult > 0 ? firstResult - initializeStartAt : 0;
+    return timings;
+  }
+
+  std::shared_ptr<EnginePool> RecognitionPipeline::findEnginePool() {
+    std::lock_guard<std::mutex> lock(enginesMutex);
+    return engines;
+  }
+
+  std::shared_ptr<EnginePool> RecognitionPipeline::enginePool() {
+    std::shared_ptr<EnginePool> enginePool = findEnginePool();
+    if (!enginePool) {
+      throw std::runtime_error("OpenALPR not initialized");
+    }
+
+    return enginePool;
+  }
+
+  alpr::AlprResults RecognitionPipeline::recogniseImage(const cv::Mat& image, const std::vector<cv::Rect>& regionsOfInterest,
+                                                        RecognitionTimings* timings) {
+    const double start = FrameScheduler::nowMs();
+    alpr::AlprResults results = recogniseWith([&](alpr::AlprImpl& engine) {
+      return readImage(engine, image, regionsOfInterest, timings);
+    });
+
+    if (timings) {
+      timings->totalMs += FrameScheduler::nowMs() - start;
+    }
+    return results;
+  }
+
+  alpr::AlprResults RecognitionPipeline::recogniseEncoded(const uint8_t* bytes, size_t size, const std::vector<cv::Rect>& regionsOfInterest,
+                                                          RecognitionTimings* timings) {
+    const double start = FrameScheduler::nowMs();
+    alpr::AlprResults results = recogniseWith([&](alpr::AlprImpl& engine) {
+      return decodeAndRead(engine, bytes, size, regionsOfInterest, timings);
+    });
+
+    if (timings) {
+      timings->totalMs += FrameScheduler::nowMs() - start;
+    }
+    return results;
+  }
+
+  std::vector<ImageResult> RecognitionPipeline::recogniseBatch(const std::vector<EncodedImage>& images, bool timing) {
+    std::shared_ptr<EnginePool> pool = enginePool();
+
+    // Keep every engine busy with one image queued behind it, without flooding the queue frames share or holding
+    // more decoded images than that
+    const size_t inFlight = pool->size() * 2;
+    std::vector<std::future<ImageResult>> pending;
+    pending.reserve(images.size());
+    std::vector<ImageResult> results;
+    results.reserve(images.size());
+
+    for (size_t next = 0; results.size() < images.size();) {
+      while (next < images.size() && next - results.size() < inFlight) {
+        pending.push_back(prefetchImage(*pool, images[next++], timing));
+      }
+      results.push_back(pending[results.size()].get());
+    }
+
+    return results;
+  }
+
+  // Reads and decodes one image of a batch on the calling thread, then queues it on the first free engine. With
+  // reduced decoding on, only the file is read here, as the engine decodes the image at the scale it needs.
+  std::future<ImageResult> RecognitionPipeline::prefetchImage(EnginePool& pool, const EncodedImage& image, bool timing) {
+    const double start = FrameScheduler::nowMs();
+    std::shared_ptr<RecognitionTimings> prefetchTimings = timing ? std::make_shared<RecognitionTimings>() : nullptr;
+    auto fileBytes = std::make_shared<std::vector<uint8_t>>();
+    EncodedImage encoded = image;
+    cv::Mat decoded;
+
+    try {
+      if (!image.path.empty()) {
+        *fileBytes = readImageFile(image.path);
+        encoded.bytes = fileBytes->data();
+        encoded.size = fileBytes->size();
+      }
+      if (!reducedDecode) {
+        timeDecode(prefetchTimings.get(), encoded.bytes, encoded.size, decoded);
+      }
+    } catch (const std::exception& e) {
+      std::promise<ImageResult> failed;
+      ImageResult result;
+      result.error = e.what();
+      failed.set_value(std::move(result));
+      return failed.get_future();
+    }
+    const double prefetchMs = FrameScheduler::nowMs() - start;
+
+    return pool.run([this, timing, prefetchTimings, prefetchMs, fileBytes, encoded, decoded](alpr::AlprImpl& engine) {
+      ImageResult result = readImageResult(engine, timing, [&](RecognitionTimings* timings) {
+        return decoded.empty() ? decodeAndRead(engine, encoded.bytes, encoded.size, {}, timings)
+                               : readImage(engine, decoded, {}, timings);
+      });
+      if (result.timings) {
+        result.timings->stages.insert(result.timings->stages.begin(), prefetchTimings->stages.begin(), prefetchTimings->stages.end());
+        result.timings->totalMs += prefetchMs;
+      }
+      return result;
+    });
+  }
+
+  void RecognitionPipeline::recogniseBatchAsync(std::vector<EncodedImage> images, bool timing,
+                                                std::function<void(std::vector<ImageResult>)> done) {
+    // Fails here, rather than on the batch thread, if OpenALPR is not initialized
+    enginePool();
+
+    std::lock_guard<std::mutex> lock(batchMutex);
+    if (!batchThread.joinable()) {
+      batchThread = std::thread([this]() { runBatches(); });
+    }
+    batches.push_back([this, images = std::move(images), timing, done = std::move(done)]() {
+      std::vector<ImageResult> results;
+      try {
+        results = recogniseBatch(images, timing);
+      } catch (const std::exception& e) {
+        // Only when the engines are gone; every image gets the error
+        results.resize(images.size());
+        for (ImageResult& result : results) {
+          result.error = e.what();
+        }
+      }
+      done(std::move(results));
+    });
+    batchAvailable.notify_one();
+  }
+
+  void RecognitionPipeline::runBatches() {
+    for (;;) {
+      std::function<void()> batch;
+      {
+        std::unique_lock<std::mutex> lock(batchMutex);
+        batchAvailable.wait(lock, [this]() { return stoppingBatches || !batches.empty(); });
+        if (stoppingBatches) {
+          return;
+        }
+        batch = std::move(batches.front());
+        batches.pop_front();
+      }
+      batch();
+    }
+  }
+
+  void RecognitionPipeline::recogniseEncodedAsync(EncodedImage image, std::vector<cv::Rect> regionsOfInterest, bool timing,
+                                                  std::shared_ptr<const std::atomic<bool>> cancelled,
+                                                  std::function<void(ImageResult)> done) {
+    runAsync(timing, std::move(cancelled), std::move(done), [this, image, regionsOfInterest](alpr::AlprImpl& engine, RecognitionTimings* timings) {
+      return readEncoded(engine, image, regionsOfInterest, timings);
+    });
+  }
+
+  void RecognitionPipeline::recogniseImageAsync(cv::Mat image, std::vector<cv::Rect> regionsOfInterest, bool timing,
+                                                std::shared_ptr<const std::atomic<bool>> cancelled,
+                                                std::function<void(ImageResult)> done) {
+    runAsync(timing, std::move(cancelled), std::move(done), [this, image, regionsOfInterest](alpr::AlprImpl& engine, RecognitionTimings* timings) {
+      return readImage(engine, image, regionsOfInterest, timings);
+    });
+  }
+
+  alpr::AlprResults RecognitionPipeline::readImage(alpr::AlprImpl& engine, const cv::Mat& image, const std::vector<cv::Rect>& regionsOfInterest,
+                                                   RecognitionTimings* timings) {
+    // With the plugin's own detector selected, plates are found with it and only they are read, as on tracked frames
+    if (detectors.getDetectorType() != PlateDetectorType::OpenAlpr) {
+      return detectAndRead(engine, image, regionsOfInterest, false, cv::Point(), 0, timings);
+    }
+
+    if (!timings) {
+      return regionsOfInterest.empty() ? engine.recognize(image) : engine.recognize(image, regionsOfInterest);
+    }
+    // Read the same way as untimed, so asking for timings never changes which plates are found
+    return recognizeTimed(engine, image, regionsOfInterest, *timings);
+  }
+
+  alpr::AlprResults RecognitionPipeline::readEncoded(alpr::AlprImpl& engine, const EncodedImage& image,
+                                                     const std::vector<cv::Rect>& regionsOfInterest, RecognitionTimings* timings) {
+    if (image.path.empty()) {
+      return decodeAndRead(engine, image.bytes, image.size, regionsOfInterest, timings);
+    }
+
+    std::vector<uint8_t> bytes = readImageFile(image.path);
+    return decodeAndRead(engine, bytes.data(), bytes.size(), regionsOfInterest, timings);
+  }
+
+  // Decodes and reads an encoded image on the engine's thread, as described for recogniseEncoded
+  alpr::AlprResults RecognitionPipeline::decodeAndRead(alpr::AlprImpl& engine, const uint8_t* bytes, size_t size,
+                                                       const std::vector<cv::Rect>& regionsOfInterest, RecognitionTimings* timings) {
+    // Kept by each engine thread, so photos of the same size decode without allocating. The full-resolution
+    // image is freed after each read, so an idle engine does not hold on to tens of megabytes.
+    static thread_local cv::Mat t_reduced;
+    cv::Mat image;
+
+    cv::Size storedSize;
+    int reduction = 1;
+    if (reducedDecode && readJpegSize(bytes, size, storedSize)) {
+      cv::Rect searched(cv::Point(), storedSize);
+      if (!regionsOfInterest.empty()) {
+        searched = regionsOfInterest.front();
+        for (const cv::Rect& region : regionsOfInterest) {
+          searched |= region;
+        }
+      }
+      reduction = jpegReduction(searched.size(), cv::Size(engine.config->maxDetectionInputWidth,
+                                                          engine.config->maxDetectionInputHeight));
+    }
+
+    if (reduction == 1) {
+      timeDecode(timings, bytes, size, image);
+      return readImage(engine, image, regionsOfInterest, timings);
+    }
+
+    // Detection only needs luma at the size the detector would shrink the image to anyway
+    timeDecode(timings, bytes, size, t_reduced, reduction, true);
+    const cv::Size fullSize = orientedSize(storedSize, t_reduced.size());
+    std::vector<cv::Rect> plateRegions = timeDetection(timings, [&]() {
+      return detectors.detectScaled(engine, t_reduced, fullSize, regionsOfInterest);
+    });
+    stats.recordCandidates(plateRegions.size(), plateRegions.size());
+    if (plateRegions.empty()) {
+      return emptyResults(fullSize);
+    }
+
+    timeDecode(timings, bytes, size, image);
+    const cv::Rect bounds(0, 0, image.cols, image.rows);
+    std::vector<cv::Rect> inBounds;
+    for (const cv::Rect& region : plateRegions) {
+      if (!(region & bounds).empty()) {
+        inBounds.push_back(region & bounds);
+      }
+    }
+    return recognizePlateRegions(engine, image, inBounds, timings);
+  }
+
+  bool RecognitionPipeline::admitFrame() {
+    stats.recordFrameReceived();
+    if (scheduler.schedule(FrameScheduler::nowMs()) != ScheduleDecision::Process) {
+      stats.recordFrameDropped();
+      return false;
+    }
+    return true;
+  }
+
+  void RecognitionPipeline::withdrawFrame() {
+    scheduler.revoke();
+    stats.recordFrameDropped();
+  }
+
+  // Works out which part of the frame to rotate and search. Returns nothing when the motion gate finds
+  // nothing moving in it, handing the frame's admission back to the scheduler so a static scene does not hold
+  // back the next moving frame.
+  std::optional<FrameWindow> RecognitionPipeline::frameWindow(const cv::Mat& luma, FrameRotation rotation, bool mirrored,
+                                                              const FrameOptions& options) {
+    FrameWindow window = computeFrameWindow(luma.size(), rotation, mirrored, options.regionsOfInterest);
+
+    if (options.motionGate) {
+      cv::Rect moving;
+      if (!motion.detect(luma, rotation, mirrored, moving) || !restrictToMotion(window, moving)) {
+        withdrawFrame();
+        return std::nullopt;
+      }
+    }
+
+    return window;
+  }
+
+  // Detects plates and reads them on the engine's thread, skipping plates that belong to a converged track
+  // when tracking. `offset` places the image in the frame the tracker works in.
+  alpr::AlprResults RecognitionPipeline::detectAndRead(alpr::AlprImpl& engine, const cv::Mat& image,
+                                                       const std::vector<cv::Rect>& regionsOfInterest, bool track,
+                                                       const cv::Point& offset, double timestamp, RecognitionTimings* timings) {
+    std::vector<cv::Rect> detected = timeDetection(timings, [&]() { return detectors.detect(engine, image, regionsOfInterest); });
+    std::vector<cv::Rect> plateRegions;
+    for (const cv::Rect& region : detected) {
+      if (!track || !tracker.coveredByConvergedTrack(region + offset, timestamp)) {
+        plateRegions.push_back(region);
+      }
+    }
+    stats.recordCandidates(detected.size(), plateRegions.size());
+
+    return recognizePlateRegions(engine, image, plateRegions, timings);
+  }
+
+  // Recognises an upright window of a frame and reports plates in the coordinates of the whole frame.
+  // Tracked frames detect plates, read only those that do not belong to a converged track, and return
+  // the tracker's consensus for every plate in view instead of this frame's raw readings.
+  alpr::AlprResults RecognitionPipeline::recogniseWindow(const cv::Mat& window, const std::vector<cv::Rect>& regionsOfInterest,
+                                                         const cv::Point& offset, const cv::Size& frameSize, bool track, double timestamp,
+                                                         RecognitionTimings* timings) {
+    if (!track) {
+      alpr::AlprResults results = enginePool()->run([&](alpr::AlprImpl& engine) {
+        return readImage(engine, window, regionsOfInterest, timings);
+      }).get();
+      placeInFrame(results, offset, frameSize, timings);
+      return results;
+    }
+
+    alpr::AlprResults results = enginePool()->run([&](alpr::AlprImpl& engine) {
+      return detectAndRead(engine, window, regionsOfInterest, true, offset, timestamp, timings);
+    }).get();
+
+    placeInFrame(results, offset, frameSize, timings);
+    return tracker.update(results, timestamp);
+  }
+
+  // Detects plates on a reduced copy of a window of the camera plane, then fetches, rotates and reads only the
+  // detected plates at full resolution. The frame must stay locked until this returns.
+  alpr::AlprResults RecognitionPipeline::recogniseDecimated(const cv::Mat& source, FrameRotation rotation, bool mirrored,
+                                                            const FrameWindow& window, bool track, double timestamp,
+                                                            RecognitionTimings* timings) {
+    alpr::AlprResults results = enginePool()->run([&](alpr::AlprImpl& engine) {
+      std::vector<cv::Rect> detected = timeDetection(timings, [&]() {
+        return detectors.detectReduced(engine, source, rotation, mirrored, window.regionsOfInterest);
+      });
+      std::vector<cv::Rect> plateRegions;
+      for (const cv::Rect& region : detected) {
+        if (!track || !tracker.coveredByConvergedTrack(region + window.upright.tl(), timestamp)) {
+          plateRegions.push_back(region);
+        }
+      }
+      stats.recordCandidates(detected.size(), plateRegions.size());
+
+      return recognizeSourceRegions(engine, source, rotation, mirrored, plateRegions, timings);
+    }).get();
+
+    placeInFrame(results, window.upright.tl(), window.frameSize, timings);
+    return track ? tracker.update(results, timestamp) : results;
+  }
+
+  std::optional<alpr::AlprResults> RecognitionPipeline::recogniseFrame(FrameSource& frame, const FrameOptions& options,
+                                                                      RecognitionTimings* timings) {
+    try {
+      const double start = FrameScheduler::nowMs();
+      const FrameRotation rotation = frame.rotation();
+      const bool mirrored = frame.isMirrored();
+
+      FrameSourceLock lock(frame);
+      cv::Mat luma = frame.luma();
+
+      std::optional<FrameWindow> window = frameWindow(luma, rotation, mirrored, options);
+      if (!window) {
+        return std::nullopt;
+      }
+
+      cv::Mat source = luma(window->source);
+      std::optional<alpr::AlprResults> results;
+
+      if (options.decimatedDetection) {
+        results = recogniseDecimated(source, rotation, mirrored, *window, options.track, start, timings);
+      } else {
+        // Only the window is rotated, into pooled scratch memory that is reused across frames.
+        // Upright frames are read in place, honouring the row stride, without a copy.
+        BufferPool::Buffer scratch;
+        cv::Mat upright = source;
+        if (rotation != FrameRotation::None || mirrored) {
+          scratch = buffers.acquire(window->upright.area());
+          upright = cv::Mat(window->upright.size(), CV_8UC1, scratch.data());
+          const double rotateStart = FrameScheduler::nowMs();
+          rotatePlane(source.data, source.cols, source.rows, source.step, upright.data, upright.step, rotation, mirrored);
+          if (timings) {
+            addStageTiming(timings->stages, "rotate", FrameScheduler::nowMs() - rotateStart);
+          }
+        }
+
+        results = recogniseWindow(upright, window->regionsOfInterest, window->upright.tl(), window->frameSize, options.track, start,
+                                  timings);
+      }
+
+      const double elapsed = FrameScheduler::nowMs() - start;
+      scheduler.recordLatency(elapsed);
+      stats.recordFrameProcessed(elapsed, results->plates.size());
+      recordFirstResult();
+      if (timings) {
+        timings->totalMs = elapsed;
+      }
+      return results;
+    } catch (...) {
+      // Admitted by admitFrame, but never read
+      withdrawFrame();
+      throw;
+    }
+  }
+
+  std::optional<uint64_t> RecognitionPipeline::submitFrame(FrameSource& frame, const FrameOptions& options, bool timing) {
+    try {
+      const FrameRotation rotation = frame.rotation();
+      const bool mirrored = frame.isMirrored();
+
+      // Fails before anything is copied if OpenALPR is not initialized
+      FrameWorker& queue = frameWorker();
+
+      FrameSourceLock lock(frame);
+      cv::Mat luma = frame.luma();
+
+      std::optional<FrameWindow> window = frameWindow(luma, rotation, mirrored, options);
+      if (!window) {
+        return std::nullopt;
+      }
+
+      cv::Mat source = luma(window->source);
+      PendingFrame pending;
+      pending.id = 0;
+      pending.width = window->upright.width;
+      pending.height = window->upright.height;
+      pending.stride = pending.width;
+      pending.pixels = buffers.acquire(window->upright.area());
+      pending.offset = window->upright.tl();
+      pending.frameSize = window->frameSize;
+      pending.regionsOfInterest = std::move(window->regionsOfInterest);
+      pending.track = options.track;
+      pending.timestamp = FrameScheduler::nowMs();
+
+      rotatePlane(source.data, source.cols, source.rows, source.step, pending.pixels.data(), pending.stride, rotation, mirrored);
+      if (timing) {
+        pending.timings = std::make_shared<RecognitionTimings>();
+        const double rotateMs = FrameScheduler::nowMs() - pending.timestamp;
+        addStageTiming(pending.timings->stages, "rotate", rotateMs);
+        pending.timings->totalMs = rotateMs;
+      }
+
+      return queue.submit(std::move(pending));
+    } catch (...) {
+      // Admitted by admitFrame, but never read
+      withdrawFrame();
+      throw;
+    }
+  }
+
+  bool RecognitionPipeline::takeFrameResult(FrameResult& result) {
+    std::lock_guard<std::mutex> lock(workerMutex);
+    return worker && worker->takeResult(result);
+  }
+
+  FrameWorker& RecognitionPipeline::frameWorker() {
+    std::lock_guard<std::mutex> lock(workerMutex);
+    if (!worker) {
+      // One frame in flight per engine
+      size_t concurrency = enginePool()->size();
+      LOGI("Starting frame worker with %zu thread(s)...", concurrency);
+      worker = std::make_unique<FrameWorker>([this](const PendingFrame& frame) {
+        double start = FrameScheduler::nowMs();
+        cv::Mat upright(frame.height, frame.width, CV_8UC1, frame.pixels.data(), frame.stride);
+        alpr::AlprResults results = recogniseWindow(upright, frame.regionsOfInterest, frame.offset, frame.frameSize,
+                                                    frame.track, frame.timestamp, frame.timings.get());
+        const double elapsed = FrameScheduler::nowMs() - start;
+        scheduler.recordLatency(elapsed);
+        stats.recordFrameProcessed(elapsed, results.plates.size());
+        recordFirstResult();
+        if (frame.timings) {
+          // Time spent waiting in the mailbox is not part of the breakdown
+          frame.timings->totalMs += elapsed;
+        }
+        return results;
+      }, concurrency, [this]() { stats.recordFrameDropped(); });
+    }
+
+    return *worker;
+  }
+}
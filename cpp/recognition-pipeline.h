@@ -0,0 +1,307 @@
+#ifndef VISIONCAMERAPLUGINANPR_RECOGNITIONPIPELINE_H
+#define VISIONCAMERAPLUGINANPR_RECOGNITIONPIPELINE_H
+
+#include "alpr.h"
+#include "buffer-pool.h"
+#include "engine-pool.h"
+#include "frame-scheduler.h"
+#include "frame-source.h"
+#include "frame-window.h"
+#include "frame-worker.h"
+#include "motion-gate.h"
+#include "plate-regions.h"
+#include "plate-tracker.h"
+#include "runtime-stats.h"
+#include "stage-timing.h"
+#include "opencv2/core.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace visioncamerapluginanpr {
+  // Per-call processing options for camera frames
+  struct FrameOptions {
+    // Skip frames in which nothing moved, and only search the moving region of the rest
+    bool motionGate = false;
+    // Follow plates across frames and return their consensus readings
+    bool track = false;
+    // Areas of the camera plane to search, in the frame's own (not upright) width x height coordinates.
+    // Only these are rotated and read; empty searches the whole frame.
+    std::vector<cv::Rect> regionsOfInterest;
+    // Detect plates on a copy reduced to the engine's maximum detection input size, and only fetch and
+    // rotate the detected plates at full resolution. Applies to frames recognised synchronously.
+    bool decimatedDetection = false;
+  };
+
+  // An image to decode: encoded bytes, which must stay unchanged until they are recognised, or else a file to read
+  struct EncodedImage {
+    const uint8_t* bytes = nullptr;
+    size_t size = 0;
+    std::string path;
+  };
+
+  // Outcome of recognising one image of a batch or an asynchronous recognition
+  struct ImageResult {
+    alpr::AlprResults results;
+    // Set instead of results when the image could not be read or recognised
+    std::string error;
+    // The image's timings, when they were asked for
+    std::shared_ptr<RecognitionTimings> timings;
+  };
+
+  // Where one engine's cold start went, in milliseconds
+  struct EngineLoadTiming {
+    // Constructing the OpenALPR engine. The prebuilt library parses openalpr.conf and loads the LBP cascade,
+    // Tesseract data, postprocess patterns and, for the US, the state keypoint images all in this one constructor.
+    double constructMs = 0;
+    // The warm-up pass, when it was asked for, and its stages: OpenALPR's own detection over a synthetic frame,
+    // building and running the plugin's plate detector, and the stages OpenALPR reports reading a synthetic plate
+    double warmUpMs = 0;
+    std::vector<StageTiming> warmUpStages;
+  };
+
+  struct InitializationTimings {
+    // Mapping the runtime data bundle and extracting it, which only writes files when its version changed
+    double bundleMs = 0;
+    // One per engine. Engines load, and warm up, in parallel.
+    std::vector<EngineLoadTiming> engines;
+    // From the start of initialization until every engine was ready
+    double totalMs = 0;
+    // From the start of initialization until the first recognition returned, or 0 until one has. Warm-up does not count.
+    double firstResultMs = 0;
+  };
+
+  // Outcome of loading the engines in the background
+  struct InitializationResult {
+    InitializationTimings timings;
+    // Set instead of timings when the engines could not be loaded
+    std::string error;
+  };
+
+  // Everything between a FrameSource or image and its AlprResults: the engine pool, frame scheduling, motion
+  // gating, plate tracking and the background frame worker. Platform neutral, so it builds and runs on the
+  // host; the JSI plugin is an adapter that turns JS arguments and VisionCamera frames into calls on it.
+  class RecognitionPipeline {
+    public:
+      RecognitionPipeline() = default;
+      ~RecognitionPipeline();
+
+      RecognitionPipeline(const RecognitionPipeline&) = delete;
+      RecognitionPipeline& operator=(const RecognitionPipeline&) = delete;
+
+      void setPaths(const std::string& configPath, const std::string& runtimePath);
+
+      // Runtime data bundle to extract into `directory`, which should hold the config and runtime paths, before the
+      // engines are loaded. Extraction happens while initializing, off the JS thread, and only once per bundle version.
+      // The bundle file is deleted once it has been extracted.
+      void setRuntimeBundle(const std::string& bundlePath, const std::string& directory);
+
+      // Loads `engineCount` engines, each warming up on a synthetic frame first if `warmUp` is set, and returns where
+      // the time went. Does nothing but return the first load's timings if the engines are already loaded. The engines
+      // are only published once all of them are ready, so recognitions fail fast rather than wait while they load.
+      InitializationTimings initialize(const std::string& country, int topN, const std::string& region, int engineCount,
+                                       bool warmUp = false);
+
+      // Runs initialize on a background thread and returns straight away. `done` gets the outcome on that thread.
+      // Calls made while a load is running are settled by that load, whatever arguments they were given.
+      void initializeAsync(const std::string& country, int topN, const std::string& region, int engineCount, bool warmUp,
+                           std::function<void(InitializationResult)> done);
+
+      // Timings of the load that initialized the engines, or nothing before they are ready
+      std::optional<InitializationTimings> initializationTimings();
+
+      // Returns the engine pool, or nullptr if initialize() has not been called yet
+      std::shared_ptr<EnginePool> findEnginePool();
+
+      // Like findEnginePool, but throws if there are no engines yet
+      std::shared_ptr<EnginePool> enginePool();
+
+      // Runs recognition on the first free engine and waits for it. An empty list of regions searches the whole image.
+      // Unless OpenALPR's own detector is selected, plates are found with the plugin's and only they are read.
+      // With `timings`, the same read records OpenALPR's stage timings: per candidate with the plugin's detector,
+      // summed over every candidate with OpenALPR's.
+      alpr::AlprResults recogniseImage(const cv::Mat& image, const std::vector<cv::Rect>& regionsOfInterest = {},
+                                       RecognitionTimings* timings = nullptr);
+
+      // Decodes and recognises an encoded still image. With reduced decoding on, a JPEG larger than the detector needs
+      // is first decoded at a reduced scale to find plates, and the full-resolution image is then decoded only if there
+      // are plates to read. The bytes are read in place and must stay unchanged until this returns.
+      alpr::AlprResults recogniseEncoded(const uint8_t* bytes, size_t size, const std::vector<cv::Rect>& regionsOfInterest = {},
+                                         RecognitionTimings* timings = nullptr);
+
+      // Whether recogniseEncoded and the calls built on it may find plates on a reduced decode of large JPEGs. Off
+      // unless set: detecting on the DCT-scaled image is much faster, but can find different plates than OpenALPR
+      // does on the full image.
+      void setReducedDecode(bool enabled) { reducedDecode = enabled; }
+      bool getReducedDecode() const { return reducedDecode; }
+
+      // Recognises many encoded images at once, each on whichever engine is free, so a batch uses as many cores as
+      // there are engines. Files are read and images decoded on the calling thread while the engines recognise the
+      // images before them, so even a single engine never waits on a decode. Results come back in input order, with
+      // a failed image reported in its own result.
+      std::vector<ImageResult> recogniseBatch(const std::vector<EncodedImage>& images, bool timing = false);
+
+      // Runs recogniseBatch on the pipeline's batch thread and returns straight away; batches run one after another.
+      // `done` gets the results on that thread. The images' bytes must stay unchanged until `done`.
+      void recogniseBatchAsync(std::vector<EncodedImage> images, bool timing, std::function<void(std::vector<ImageResult>)> done);
+
+      // Queues an encoded image, or an already decoded BGR image, on the first free engine and returns straight away.
+      // `done` gets the outcome on the engine's thread, exactly once. Setting `cancelled` before an engine picks the image
+      // up skips it, with a "Recognition cancelled" error. The image's pixels or bytes must stay unchanged until `done`.
+      void recogniseEncodedAsync(EncodedImage image, std::vector<cv::Rect> regionsOfInterest, bool timing,
+                                 std::shared_ptr<const std::atomic<bool>> cancelled, std::function<void(ImageResult)> done);
+      void recogniseImageAsync(cv::Mat image, std::vector<cv::Rect> regionsOfInterest, bool timing,
+                               std::shared_ptr<const std::atomic<bool>> cancelled, std::function<void(ImageResult)> done);
+
+      // Runs `recognize` on the first free engine, waits for it and counts it as a recognised still image
+      template <typename Recognize>
+      alpr::AlprResults recogniseWith(Recognize recognize) {
+        const double start = FrameScheduler::nowMs();
+        alpr::AlprResults results = enginePool()->run(std::move(recognize)).get();
+        stats.recordImageProcessed(FrameScheduler::nowMs() - start, results.plates.size());
+        recordFirstResult();
+        return results;
+      }
+
+      // Asks the frame scheduler whether to read a frame arriving now. Call it once the frame's arguments are
+      // parsed and its source built, but before the source is locked, so that skipped frames cost nothing more.
+      // recogniseFrame and submitFrame withdraw the admission again if they throw.
+      bool admitFrame();
+
+      // Recognises an admitted frame on the calling thread and feeds its latency back to the scheduler.
+      // Returns nothing, without running recognition, when the motion gate finds the frame static.
+      // Fills `timings`, if given, with where the time went.
+      std::optional<alpr::AlprResults> recogniseFrame(FrameSource& frame, const FrameOptions& options,
+                                                      RecognitionTimings* timings = nullptr);
+
+      // Copies the part of an admitted frame that needs reading and queues it on the frame worker, so the
+      // frame can be released straight away. Returns the frame's id, or nothing when the motion gate finds it static.
+      // With `timing`, the frame's result carries its RecognitionTimings.
+      std::optional<uint64_t> submitFrame(FrameSource& frame, const FrameOptions& options, bool timing = false);
+
+      // Moves the newest unread result of a submitted frame into `result`
+      bool takeFrameResult(FrameResult& result);
+
+      BufferPool& bufferPool() { return buffers; }
+      FrameScheduler& frameScheduler() { return scheduler; }
+      MotionGate& motionGate() { return motion; }
+      PlateRegionDetectors& plateRegionDetectors() { return detectors; }
+      PlateTracker& plateTracker() { return tracker; }
+      RuntimeStats& runtimeStats() { return stats; }
+
+    private:
+      // Notes when the first recognition after initialization returned
+      void recordFirstResult() {
+        if (firstResultAt.load(std::memory_order_relaxed) == 0) {
+          double unset = 0;
+          firstResultAt.compare_exchange_strong(unset, FrameScheduler::nowMs());
+        }
+      }
+
+      void warmUp(alpr::AlprImpl& engine, EngineLoadTiming& timing);
+      // Hands an admitted frame's admission back to the scheduler and counts the frame as dropped
+      void withdrawFrame();
+      std::optional<FrameWindow> frameWindow(const cv::Mat& luma, FrameRotation rotation, bool mirrored, const FrameOptions& options);
+      // Runs `read` on the engine, timing it and counting it as a recognised still image; failures become the error
+      template <typename Read>
+      ImageResult readImageResult(alpr::AlprImpl& engine, bool timing, Read read) {
+        const double start = FrameScheduler::nowMs();
+        ImageResult result;
+        if (timing) {
+          result.timings = std::make_shared<RecognitionTimings>();
+        }
+
+        try {
+          result.results = read(result.timings.get());
+          const double elapsed = FrameScheduler::nowMs() - start;
+          stats.recordImageProcessed(elapsed, result.results.plates.size());
+          recordFirstResult();
+          if (result.timings) {
+            result.timings->totalMs = elapsed;
+          }
+        } catch (const std::exception& e) {
+          result.error = e.what();
+        }
+        return result;
+      }
+
+      template <typename Read>
+      void runAsync(bool timing, std::shared_ptr<const std::atomic<bool>> cancelled, std::function<void(ImageResult)> done, Read read) {
+        // Nothing waits on the returned future; the outcome goes to `done` instead
+        enginePool()->run([this, timing, cancelled, done, read](alpr::AlprImpl& engine) {
+          if (cancelled && cancelled->load()) {
+            ImageResult skipped;
+            skipped.error = "Recognition cancelled";
+            done(std::move(skipped));
+            return;
+          }
+          done(readImageResult(engine, timing, [&](RecognitionTimings* timings) { return read(engine, timings); }));
+        });
+      }
+
+      alpr::AlprResults readImage(alpr::AlprImpl& engine, const cv::Mat& image, const std::vector<cv::Rect>& regionsOfInterest,
+                                  RecognitionTimings* timings);
+      alpr::AlprResults readEncoded(alpr::AlprImpl& engine, const EncodedImage& image, const std::vector<cv::Rect>& regionsOfInterest,
+                                    RecognitionTimings* timings);
+      alpr::AlprResults decodeAndRead(alpr::AlprImpl& engine, const uint8_t* bytes, size_t size,
+                                      const std::vector<cv::Rect>& regionsOfInterest, RecognitionTimings* timings);
+      std::future<ImageResult> prefetchImage(EnginePool& pool, const EncodedImage& image, bool timing);
+      void runBatches();
+      alpr::AlprResults detectAndRead(alpr::AlprImpl& engine, const cv::Mat& image, const std::vector<cv::Rect>& regionsOfInterest,
+                                      bool track, const cv::Point& offset, double timestamp, RecognitionTimings* timings);
+      alpr::AlprResults recogniseWindow(const cv::Mat& window, const std::vector<cv::Rect>& regionsOfInterest,
+                                        const cv::Point& offset, const cv::Size& frameSize, bool track, double timestamp,
+                                        RecognitionTimings* timings);
+      alpr::AlprResults recogniseDecimated(const cv::Mat& source, FrameRotation rotation, bool mirrored, const FrameWindow& window,
+                                           bool track, double timestamp, RecognitionTimings* timings);
+      FrameWorker& frameWorker();
+
+      std::string configPath;
+      std::string runtimePath;
+      std::string bundlePath;
+      std::string bundleDirectory;
+      std::shared_ptr<EnginePool> engines;
+      std::mutex enginesMutex;
+      // Held for the whole of a load, so concurrent initialize calls load the engines once
+      std::mutex initializeMutex;
+      InitializationTimings coldStart;
+      double initializeStartAt = 0;
+      std::atomic<double> firstResultAt{0};
+      std::atomic<bool> reducedDecode{false};
+
+      // Background load started by initializeAsync, and the callers waiting on it
+      std::thread loader;
+      bool loading = false;
+      std::vector<std::function<void(InitializationResult)>> loadWaiters;
+      std::mutex loaderMutex;
+
+      BufferPool buffers;
+      FrameScheduler scheduler;
+      MotionGate motion;
+      PlateRegionDetectors detectors;
+      PlateTracker tracker;
+      RuntimeStats stats;
+
+      std::unique_ptr<FrameWorker> worker;
+      std::mutex workerMutex;
+
+      // Batches queued by recogniseBatchAsync, run in order on a thread started with the first of them
+      std::thread batchThread;
+      std::deque<std::function<void()>> batches;
+      bool stoppingBatches = false;
+      std::mutex batchMutex;
+      std::condition_variable batchAvailable;
+  };
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_RECOGNITIONPIPELINE_H */
@@ -0,0 +1,298 @@
+#include "result-encoding.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+// Fields are copied in host byte order; every ABI the plugin ships for is little-endian
+namespace visioncamerapluginanpr {
+  template <typename T>
+  static inline uint8_t* put(uint8_t* dst, T value) {
+    std::memcpy(dst, &value, sizeof(T));
+    return dst + sizeof(T);
+  }
+
+  template <typename T>
+  static inline T get(const uint8_t* src) {
+    T value;
+    std::memcpy(&value, src, sizeof(T));
+    return value;
+  }
+
+  static inline int16_t saturate16(int value) {
+    return static_cast<int16_t>(std::min<int>(std::max<int>(value, std::numeric_limits<int16_t>::min()),
+                                              std::numeric_limits<int16_t>::max()));
+  }
+
+  static uint8_t* putCorners(uint8_t* dst, const alpr::AlprCoordinate (&corners)[4]) {
+    for (const alpr::AlprCoordinate& corner : corners) {
+      dst = put<int16_t>(dst, saturate16(corner.x));
+      dst = put<int16_t>(dst, saturate16(corner.y));
+    }
+    return dst;
+  }
+
+  static void getCorners(const uint8_t* src, alpr::AlprCoordinate (&corners)[4]) {
+    for (int i = 0; i < 4; ++i) {
+      corners[i].x = get<int16_t>(src + i * 4);
+      corners[i].y = get<int16_t>(src + i * 4 + 2);
+    }
+  }
+
+  static bool isSamePlate(const alpr::AlprPlate& a, const alpr::AlprPlate& b) {
+    return a.characters == b.characters && a.overall_confidence == b.overall_confidence &&
+           a.matches_template == b.matches_template && a.character_details.size() == b.character_details.size();
+  }
+
+  uint32_t ResultEncoder::intern(const std::string& value) {
+    if (value.size() > std::numeric_limits<uint16_t>::max()) {
+      throw std::length_error("String too long to encode");
+    }
+
+    auto existing = stringOffsets.find(value);
+    if (existing != stringOffsets.end()) {
+      return existing->second;
+    }
+
+    uint32_t offset = stringBytes;
+    stringOffsets.emplace(value, offset);
+    strings.push_back(&value);
+    stringBytes += sizeof(uint16_t) + static_cast<uint32_t>(value.size());
+    return offset;
+  }
+
+  void ResultEncoder::addCandidate(const alpr::AlprPlate& plate) {
+    candidates.push_back(&plate);
+    candidateFirstChar.push_back(charCount);
+    charCount += static_cast<uint32_t>(plate.character_details.size());
+
+    intern(plate.characters);
+    for (const alpr::AlprChar& character : plate.character_details) {
+      intern(character.character);
+    }
+  }
+
+  size_t ResultEncoder::prepare(const alpr::AlprResults& results) {
+    if (results.plates.size() > std::numeric_limits<uint16_t>::max() ||
+        results.regionsOfInterest.size() > std::numeric_limits<uint16_t>::max()) {
+      throw std::length_error("Too many plates or regions to encode");
+    }
+
+    this->results = &results;
+    plates.clear();
+    candidates.clear();
+    candidateFirstChar.clear();
+    charCount = 0;
+    stringOffsets.clear();
+    strings.clear();
+    stringBytes = 0;
+
+    for (const alpr::AlprPlateResult& plate : results.plates) {
+      intern(plate.country);
+      intern(plate.region);
+
+      PlateLayout layout;
+      layout.firstCandidate = static_cast<uint32_t>(candidates.size());
+      for (const alpr::AlprPlate& candidate : plate.topNPlates) {
+        addCandidate(candidate);
+      }
+
+      // bestPlate is normally one of topNPlates; only store it separately when it is not
+      auto best = std::find_if(plate.topNPlates.begin(), plate.topNPlates.end(), [&plate](const alpr::AlprPlate& candidate) {
+        return isSamePlate(candidate, plate.bestPlate);
+      });
+
+      if (best != plate.topNPlates.end()) {
+        layout.bestCandidate = layout.firstCandidate + static_cast<uint32_t>(best - plate.topNPlates.begin());
+      } else {
+        layout.bestCandidate = static_cast<uint32_t>(candidates.size());
+        addCandidate(plate.bestPlate);
+      }
+
+      plates.push_back(layout);
+    }
+
+    totalSize = kHeaderSize +
+                results.regionsOfInterest.size() * kRegionSize +
+                results.plates.size() * kPlateSize +
+                candidates.size() * kCandidateSize +
+                static_cast<size_t>(charCount) * kCharSize +
+                stringBytes;
+    return totalSize;
+  }
+
+  void ResultEncoder::write(uint8_t* dst) const {
+    uint8_t* out = dst;
+
+    out = put<uint32_t>(out, kMagic);
+    out = put<uint16_t>(out, kVersion);
+    out = put<uint16_t>(out, static_cast<uint16_t>(kHeaderSize));
+    out = put<uint16_t>(out, static_cast<uint16_t>(results->plates.size()));
+    out = put<uint16_t>(out, static_cast<uint16_t>(results->regionsOfInterest.size()));
+    out = put<uint32_t>(out, static_cast<uint32_t>(candidates.size()));
+    out = put<uint32_t>(out, charCount);
+    out = put<uint32_t>(out, stringBytes);
+    out = put<int32_t>(out, results->img_width);
+    out = put<int32_t>(out, results->img_height);
+    out = put<double>(out, static_cast<double>(results->epoch_time));
+    out = put<double>(out, static_cast<double>(results->frame_number));
+    out = put<float>(out, results->total_processing_time_ms);
+    out = put<uint32_t>(out, static_cast<uint32_t>(totalSize));
+
+    for (const alpr::AlprRegionOfInterest& roi : results->regionsOfInterest) {
+      out = put<int16_t>(out, saturate16(roi.x));
+      out = put<int16_t>(out, saturate16(roi.y));
+      out = put<int16_t>(out, saturate16(roi.width));
+      out = put<int16_t>(out, saturate16(roi.height));
+    }
+
+    for (size_t i = 0; i < results->plates.size(); ++i) {
+      const alpr::AlprPlateResult& plate = results->plates[i];
+      out = putCorners(out, plate.plate_points);
+      out = put<float>(out, plate.processing_time_ms);
+      out = put<int32_t>(out, plate.requested_topn);
+      out = put<int32_t>(out, plate.plate_index);
+      out = put<int32_t>(out, plate.regionConfidence);
+      out = put<uint32_t>(out, stringOffsets.at(plate.country));
+      out = put<uint32_t>(out, stringOffsets.at(plate.region));
+      out = put<uint32_t>(out, plates[i].bestCandidate);
+      out = put<uint32_t>(out, plates[i].firstCandidate);
+      out = put<uint32_t>(out, static_cast<uint32_t>(plate.topNPlates.size()));
+    }
+
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      const alpr::AlprPlate& candidate = *candidates[i];
+      out = put<uint32_t>(out, stringOffsets.at(candidate.characters));
+      out = put<float>(out, candidate.overall_confidence);
+      out = put<uint32_t>(out, candidateFirstChar[i]);
+      out = put<uint16_t>(out, static_cast<uint16_t>(candidate.character_details.size()));
+      out = put<uint8_t>(out, candidate.matches_template ? 1 : 0);
+      out = put<uint8_t>(out, 0);
+    }
+
+    for (const alpr::AlprPlate* candidate : candidates) {
+      for (const alpr::AlprChar& character : candidate->character_details) {
+        out = putCorners(out, character.corners);
+        out = put<float>(out, character.confidence);
+        out = put<uint32_t>(out, stringOffsets.at(character.character));
+      }
+    }
+
+    for (const std::string* value : strings) {
+      out = put<uint16_t>(out, static_cast<uint16_t>(value->size()));
+      std::memcpy(out, value->data(), value->size());
+      out += value->size();
+    }
+  }
+
+  alpr::AlprResults decodeResults(const uint8_t* data, size_t size) {
+    if (size < ResultEncoder::kHeaderSize || get<uint32_t>(data) != ResultEncoder::kMagic) {
+      throw std::invalid_argument("Not an encoded AlprResults buffer");
+    }
+
+    if (get<uint16_t>(data + 4) != ResultEncoder::kVersion) {
+      throw std::invalid_argument("Unsupported AlprResults encoding version");
+    }
+
+    const size_t headerSize = get<uint16_t>(data + 6);
+    if (headerSize < ResultEncoder::kHeaderSize) {
+      throw std::invalid_argument("Invalid AlprResults header size");
+    }
+    const size_t plateCount = get<uint16_t>(data + 8);
+    const size_t roiCount = get<uint16_t>(data + 10);
+    const size_t candidateCount = get<uint32_t>(data + 12);
+    const size_t charCount = get<uint32_t>(data + 16);
+    const size_t stringBytes = get<uint32_t>(data + 20);
+    const size_t totalSize = get<uint32_t>(data + 52);
+
+    const size_t roiOffset = headerSize;
+    const size_t plateOffset = roiOffset + roiCount * ResultEncoder::kRegionSize;
+    const size_t candidateOffset = plateOffset + plateCount * ResultEncoder::kPlateSize;
+    const size_t charOffset = candidateOffset + candidateCount * ResultEncoder::kCandidateSize;
+    const size_t stringOffset = charOffset + charCount * ResultEncoder::kCharSize;
+
+    if (totalSize > size || stringOffset + stringBytes != totalSize) {
+      throw std::invalid_argument("Truncated AlprResults buffer");
+    }
+
+    auto readString = [&](uint32_t offset) {
+      if (offset + sizeof(uint16_t) > stringBytes) {
+        throw std::invalid_argument("String offset out of range");
+      }
+
+      const uint8_t* entry = data + stringOffset + offset;
+      size_t length = get<uint16_t>(entry);
+      if (offset + sizeof(uint16_t) + length > stringBytes) {
+        throw std::invalid_argument("String length out of range");
+      }
+
+      return std::string(reinterpret_cast<const char*>(entry + sizeof(uint16_t)), length);
+    };
+
+    auto readCandidate = [&](uint32_t index) {
+      if (index >= candidateCount) {
+        throw std::invalid_argument("Candidate index out of range");
+      }
+
+      const uint8_t* record = data + candidateOffset + index * ResultEncoder::kCandidateSize;
+      alpr::AlprPlate plate;
+      plate.characters = readString(get<uint32_t>(record));
+      plate.overall_confidence = get<float>(record + 4);
+      plate.matches_template = record[14] != 0;
+
+      size_t firstChar = get<uint32_t>(record + 8);
+      size_t plateChars = get<uint16_t>(record + 12);
+      if (firstChar + plateChars > charCount) {
+        throw std::invalid_argument("Character range out of range");
+      }
+
+      plate.character_details.resize(plateChars);
+      for (size_t i = 0; i < plateChars; ++i) {
+        const uint8_t* charRecord = data + charOffset + (firstChar + i) * ResultEncoder::kCharSize;
+        alpr::AlprChar& character = plate.character_details[i];
+        getCorners(charRecord, character.corners);
+        character.confidence = get<float>(charRecord + 16);
+        character.character = readString(get<uint32_t>(charRecord + 20));
+      }
+
+      return plate;
+    };
+
+    alpr::AlprResults results;
+    results.img_width = get<int32_t>(data + 24);
+    results.img_height = get<int32_t>(data + 28);
+    results.epoch_time = static_cast<int64_t>(get<double>(data + 32));
+    results.frame_number = static_cast<int64_t>(get<double>(data + 40));
+    results.total_processing_time_ms = get<float>(data + 48);
+
+    for (size_t i = 0; i < roiCount; ++i) {
+      const uint8_t* record = data + roiOffset + i * ResultEncoder::kRegionSize;
+      results.regionsOfInterest.emplace_back(get<int16_t>(record), get<int16_t>(record + 2),
+                                             get<int16_t>(record + 4), get<int16_t>(record + 6));
+    }
+
+    results.plates.resize(plateCount);
+    for (size_t i = 0; i < plateCount; ++i) {
+      const uint8_t* record = data + plateOffset + i * ResultEncoder::kPlateSize;
+      alpr::AlprPlateResult& plate = results.plates[i];
+
+      getCorners(record, plate.plate_points);
+      plate.processing_time_ms = get<float>(record + 16);
+      plate.requested_topn = get<int32_t>(record + 20);
+      plate.plate_index = get<int32_t>(record + 24);
+      plate.regionConfidence = get<int32_t>(record + 28);
+      plate.country = readString(get<uint32_t>(record + 32));
+      plate.region = readString(get<uint32_t>(record + 36));
+      plate.bestPlate = readCandidate(get<uint32_t>(record + 40));
+
+      uint32_t firstCandidate = get<uint32_t>(record + 44);
+      uint32_t topNCount = get<uint32_t>(record + 48);
+      for (uint32_t j = 0; j < topNCount; ++j) {
+        plate.topNPlates.push_back(readCandidate(firstCandidate + j));
+      }
+    }
+
+    return results;
+  }
+}
@@ -0,0 +1,75 @@
+#ifndef VISIONCAMERAPLUGINANPR_RESULTENCODING_H
+#define VISIONCAMERAPLUGINANPR_RESULTENCODING_H
+
+#include "alpr.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace visioncamerapluginanpr {
+  // Packed little-endian encoding of AlprResults, read back in JS by decodeAlprResults (src/services/results.decoder.ts).
+  // Keep both sides in sync when changing the layout, and bump kVersion.
+  //
+  //   header      56 bytes, see below
+  //   regions     roiCount       x 8 bytes   int16 x, y, width, height
+  //   plates      plateCount     x 52 bytes  int16 corners[8], float32 processing_time_ms, int32 requested_topn,
+  //                                          int32 plate_index, int32 regionConfidence, uint32 country, uint32 region,
+  //                                          uint32 bestCandidate, uint32 firstCandidate, uint32 candidateCount
+  //   candidates  candidateCount x 16 bytes  uint32 characters, float32 overall_confidence, uint32 firstChar,
+  //                                          uint16 charCount, uint8 matches_template, uint8 padding
+  //   characters  charCount      x 24 bytes  int16 corners[8], float32 confidence, uint32 character
+  //   strings     stringBytes                uint16 length + UTF-8 bytes per string; strings are referenced by byte offset
+  //
+  // The header holds uint32 magic, uint16 version, uint16 headerSize, uint16 plateCount, uint16 roiCount,
+  // uint32 candidateCount, uint32 charCount, uint32 stringBytes, int32 img_width, int32 img_height,
+  // float64 epoch_time, float64 frame_number, float32 total_processing_time_ms and uint32 totalSize.
+  // Coordinates are saturated to the int16 range.
+  class ResultEncoder {
+    public:
+      static constexpr uint32_t kMagic = 0x52504C41; // "ALPR"
+      static constexpr uint16_t kVersion = 1;
+      static constexpr size_t kHeaderSize = 56;
+      static constexpr size_t kRegionSize = 8;
+      static constexpr size_t kPlateSize = 52;
+      static constexpr size_t kCandidateSize = 16;
+      static constexpr size_t kCharSize = 24;
+
+      // Lays out `results` and returns the number of bytes write() will produce.
+      // `results` must outlive the following write().
+      size_t prepare(const alpr::AlprResults& results);
+
+      // Writes the prepared results into `dst`, which must hold at least the size returned by prepare()
+      void write(uint8_t* dst) const;
+
+      size_t size() const { return totalSize; }
+
+    private:
+      struct PlateLayout {
+        uint32_t bestCandidate;
+        uint32_t firstCandidate;
+      };
+
+      uint32_t intern(const std::string& value);
+      void addCandidate(const alpr::AlprPlate& plate);
+
+      const alpr::AlprResults* results = nullptr;
+      std::vector<PlateLayout> plates;
+      std::vector<const alpr::AlprPlate*> candidates;
+      std::vector<uint32_t> candidateFirstChar;
+      uint32_t charCount = 0;
+
+      std::unordered_map<std::string, uint32_t> stringOffsets;
+      std::vector<const std::string*> strings;
+      uint32_t stringBytes = 0;
+
+      size_t totalSize = 0;
+  };
+
+  // Reads an encoding produced by ResultEncoder. Throws std::invalid_argument if `data` is not a valid encoding.
+  alpr::AlprResults decodeResults(const uint8_t* data, size_t size);
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_RESULTENCODING_H */
@@ -0,0 +1,213 @@
+#include "runtime-bundle.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <ftw.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace visioncamerapluginanpr {
+  static const char kMagic[8] = { 'A', 'N', 'P', 'R', 'B', 'N', 'D', 'L' };
+  // Written into the extraction directory once every entry is in place
+  static const char* const kVersionStamp = ".bundle-version";
+
+  template <typename T>
+  static T readLittleEndian(const uint8_t* bytes) {
+    T value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+      value |= static_cast<T>(bytes[i]) << (8 * i);
+    }
+    return value;
+  }
+
+  // Only plain relative paths, so an entry can never be written outside the extraction directory
+  static bool isSafePath(const std::string& path) {
+    if (path.empty() || path.front() == '/') {
+      return false;
+    }
+
+    size_t start = 0;
+    while (start <= path.size()) {
+      size_t end = path.find('/', start);
+      if (end == std::string::npos) {
+        end = path.size();
+      }
+
+      const std::string component = path.substr(start, end - start);
+      if (component.empty() || component == "." || component == "..") {
+        return false;
+      }
+      start = end + 1;
+    }
+    return true;
+  }
+
+  static void makeDirectories(const std::string& path) {
+    for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+      const std::string directory = path.substr(0, slash);
+      struct stat info;
+      if (mkdir(directory.c_str(), 0755) != 0 && (stat(directory.c_str(), &info) != 0 || !S_ISDIR(info.st_mode))) {
+        throw std::runtime_error("Unable to create " + directory + ": " + std::strerror(errno));
+      }
+      if (slash == std::string::npos) {
+        return;
+      }
+    }
+  }
+
+  // Deletes a file, or a directory and everything in it; a path that does not exist is left alone
+  static void removeTree(const std::string& path) {
+    const int flags = FTW_DEPTH | FTW_PHYS;
+    auto remove = [](const char* path, const struct stat*, int, struct FTW*) { return std::remove(path); };
+    if (nftw(path.c_str(), remove, 16, flags) != 0 && errno != ENOENT) {
+      throw std::runtime_error("Unable to remove " + path + ": " + std::strerror(errno));
+    }
+  }
+
+  static std::string versionString(uint64_t version) {
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(version));
+    return hex;
+  }
+
+  RuntimeBundle::RuntimeBundle(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      throw std::runtime_error("Unable to open runtime bundle " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(kHeaderSize)) {
+      close(fd);
+      throw std::runtime_error("Runtime bundle " + path + " is too small");
+    }
+
+    size = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file referenced on its own
+    close(fd);
+    if (mapped == MAP_FAILED) {
+      throw std::runtime_error("Unable to map runtime bundle " + path + ": " + std::strerror(errno));
+    }
+    data = static_cast<const uint8_t*>(mapped);
+
+    try {
+      parse();
+    } catch (...) {
+      munmap(const_cast<uint8_t*>(data), size);
+      throw;
+    }
+  }
+
+  RuntimeBundle::~RuntimeBundle() {
+    munmap(const_cast<uint8_t*>(data), size);
+  }
+
+  void RuntimeBundle::parse() {
+    if (std::memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+      throw std::runtime_error("Not a runtime bundle");
+    }
+
+    const uint32_t formatVersion = readLittleEndian<uint32_t>(data + 8);
+    if (formatVersion != kFormatVersion) {
+      throw std::runtime_error("Unsupported runtime bundle format " + std::to_string(formatVersion));
+    }
+
+    const uint32_t entryCount = readLittleEndian<uint32_t>(data + 12);
+    contentVersion = readLittleEndian<uint64_t>(data + 16);
+    const uint64_t indexSize = readLittleEndian<uint64_t>(data + 24);
+    if (indexSize > size - kHeaderSize) {
+      throw std::runtime_error("Runtime bundle index is truncated");
+    }
+
+    const uint8_t* cursor = data + kHeaderSize;
+    const uint8_t* indexEnd = cursor + indexSize;
+    index.reserve(entryCount);
+    for (uint32_t i = 0; i < entryCount; ++i) {
+      if (indexEnd - cursor < 18) {
+        throw std::runtime_error("Runtime bundle index is truncated");
+      }
+
+      const uint64_t offset = readLittleEndian<uint64_t>(cursor);
+      const uint64_t entrySize = readLittleEndian<uint64_t>(cursor + 8);
+      const uint16_t pathLength = readLittleEndian<uint16_t>(cursor + 16);
+      cursor += 18;
+      if (static_cast<size_t>(indexEnd - cursor) < pathLength) {
+        throw std::runtime_error("Runtime bundle index is truncated");
+      }
+
+      RuntimeBundleEntry entry;
+      entry.path.assign(reinterpret_cast<const char*>(cursor), pathLength);
+      cursor += pathLength;
+
+      if (offset % kAlignment != 0 || offset > size || entrySize > size - offset) {
+        throw std::runtime_error("Runtime bundle entry " + entry.path + " is out of bounds");
+      }
+      if (!isSafePath(entry.path)) {
+        throw std::runtime_error("Runtime bundle entry has an invalid path: " + entry.path);
+      }
+
+      entry.data = data + offset;
+      entry.size = static_cast<size_t>(entrySize);
+      index.push_back(std::move(entry));
+    }
+  }
+
+  const RuntimeBundleEntry* RuntimeBundle::find(const std::string& path) const {
+    for (const RuntimeBundleEntry& entry : index) {
+      if (entry.path == path) {
+        return &entry;
+      }
+    }
+    return nullptr;
+  }
+
+  bool RuntimeBundle::extractTo(const std::string& directory) const {
+    const std::string stampPath = directory + "/" + kVersionStamp;
+    const std::string version = versionString(contentVersion);
+    {
+      std::ifstream stamp(stampPath);
+      std::string extracted((std::istreambuf_iterator<char>(stamp)), std::istreambuf_iterator<char>());
+      if (extracted == version) {
+        return false;
+      }
+    }
+
+    // Entries are written front to back, once each
+    madvise(const_cast<uint8_t*>(data), size, MADV_SEQUENTIAL);
+
+    // Whatever an older version extracted goes first, so files it no longer has do not linger. The stamp goes before
+    // anything else, so an extraction interrupted from here on is redone.
+    std::remove(stampPath.c_str());
+    for (const RuntimeBundleEntry& entry : index) {
+      removeTree(directory + "/" + entry.path.substr(0, entry.path.find('/')));
+    }
+
+    makeDirectories(directory);
+    for (const RuntimeBundleEntry& entry : index) {
+      const std::string path = directory + "/" + entry.path;
+      const size_t slash = path.rfind('/');
+      makeDirectories(path.substr(0, slash));
+
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      file.write(reinterpret_cast<const char*>(entry.data), static_cast<std::streamsize>(entry.size));
+      if (!file) {
+        throw std::runtime_error("Unable to write " + path);
+      }
+    }
+
+    std::ofstream stamp(stampPath, std::ios::trunc);
+    stamp << version;
+    if (!stamp) {
+      throw std::runtime_error("Unable to write " + stampPath);
+    }
+    return true;
+  }
+}
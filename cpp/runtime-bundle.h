@@ -0,0 +1,62 @@
+#ifndef VISIONCAMERAPLUGINANPR_RUNTIMEBUNDLE_H
+#define VISIONCAMERAPLUGINANPR_RUNTIMEBUNDLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace visioncamerapluginanpr {
+  // One file packed into a runtime data bundle. `data` points into the mapped bundle.
+  struct RuntimeBundleEntry {
+    // Relative to the bundle root, with '/' separators, e.g. "runtime_data/config/us.conf"
+    std::string path;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+  };
+
+  // openalpr.conf and runtime_data packed into a single file at build time (see packRuntimeBundle in
+  // android/build.gradle). All integers are little-endian:
+  //
+  //   header   "ANPRBNDL", u32 format version, u32 entry count, u64 content version, u64 index size
+  //   index    per entry: u64 offset, u64 size, u16 path length, path bytes
+  //   entries  each starting at an offset, from the start of the bundle, that is a multiple of kAlignment
+  //
+  // The content version is a hash of every path and its contents, so it changes whenever the data does.
+  // The bundle is mapped read-only, so its pages are shared and can be evicted by the page cache.
+  class RuntimeBundle {
+    public:
+      static constexpr uint32_t kFormatVersion = 1;
+      static constexpr size_t kAlignment = 4096;
+      static constexpr size_t kHeaderSize = 32;
+
+      // Maps the bundle at `path`. Throws std::runtime_error if it cannot be mapped or is not a valid bundle.
+      explicit RuntimeBundle(const std::string& path);
+      ~RuntimeBundle();
+
+      RuntimeBundle(const RuntimeBundle&) = delete;
+      RuntimeBundle& operator=(const RuntimeBundle&) = delete;
+
+      uint64_t version() const { return contentVersion; }
+      const std::vector<RuntimeBundleEntry>& entries() const { return index; }
+
+      // The entry packed from `path`, or nullptr
+      const RuntimeBundleEntry* find(const std::string& path) const;
+
+      // Writes every entry under `directory`, unless it already holds this version of the bundle, which the OpenALPR
+      // loaders then read as plain files. Returns whether anything was written. The files and directories at the top
+      // of the bundle (openalpr.conf, runtime_data) are deleted first, so nothing of an older version is left behind.
+      // A version stamp is only written after every entry, so an interrupted extraction is redone next time.
+      bool extractTo(const std::string& directory) const;
+
+    private:
+      void parse();
+
+      const uint8_t* data = nullptr;
+      size_t size = 0;
+      uint64_t contentVersion = 0;
+      std::vector<RuntimeBundleEntry> index;
+  };
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_RUNTIMEBUNDLE_H */
@@ -0,0 +1,105 @@
+#include "runtime-stats.h"
+
+#include <algorithm>
+
+namespace visioncamerapluginanpr {
+  const std::array<double, LatencyHistogram::kBucketCount> LatencyHistogram::kUpperBoundsMs = {
+    5, 10, 20, 35, 50, 75, 100, 150, 200, 300, 500, 1000, 2000, 1e300
+  };
+
+  void LatencyHistogram::record(double latencyMs) {
+    size_t bucket = std::lower_bound(kUpperBoundsMs.begin(), kUpperBoundsMs.end() - 1, latencyMs) - kUpperBoundsMs.begin();
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  LatencyHistogram::Counts LatencyHistogram::counts() const {
+    Counts counts;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+      counts[i] = buckets[i].load(std::memory_order_relaxed);
+    }
+    return counts;
+  }
+
+  void LatencyHistogram::reset() {
+    for (std::atomic<uint64_t>& bucket : buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  double LatencyHistogram::percentile(const Counts& counts, double fraction) {
+    uint64_t total = 0;
+    for (uint64_t count : counts) {
+      total += count;
+    }
+    if (total == 0) {
+      return 0;
+    }
+
+    // Nearest rank, counted from 1
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * total + 0.999999));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount - 1; ++i) {
+      seen += counts[i];
+      if (seen >= rank) {
+        return kUpperBoundsMs[i];
+      }
+    }
+    return kUpperBoundsMs[kBucketCount - 2];
+  }
+
+  void RuntimeStats::recordFrameReceived() {
+    framesReceived.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void RuntimeStats::recordFrameDropped() {
+    framesDropped.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void RuntimeStats::recordFrameProcessed(double latencyMs, size_t plates) {
+    framesProcessed.fetch_add(1, std::memory_order_relaxed);
+    platesFound.fetch_add(plates, std::memory_order_relaxed);
+    frameLatency.record(latencyMs);
+  }
+
+  void RuntimeStats::recordImageProcessed(double latencyMs, size_t plates) {
+    imagesProcessed.fetch_add(1, std::memory_order_relaxed);
+    platesFound.fetch_add(plates, std::memory_order_relaxed);
+    imageLatency.record(latencyMs);
+  }
+
+  void RuntimeStats::recordCandidates(size_t detected, size_t read) {
+    candidates.fetch_add(detected, std::memory_order_relaxed);
+    candidateSamples.fetch_add(1, std::memory_order_relaxed);
+    ocrCalls.fetch_add(read, std::memory_order_relaxed);
+  }
+
+  RuntimeStatsSnapshot RuntimeStats::snapshot() const {
+    RuntimeStatsSnapshot snapshot;
+    snapshot.framesReceived = framesReceived.load(std::memory_order_relaxed);
+    snapshot.framesProcessed = framesProcessed.load(std::memory_order_relaxed);
+    snapshot.framesDropped = framesDropped.load(std::memory_order_relaxed);
+    snapshot.imagesProcessed = imagesProcessed.load(std::memory_order_relaxed);
+    snapshot.platesFound = platesFound.load(std::memory_order_relaxed);
+    snapshot.ocrCalls = ocrCalls.load(std::memory_order_relaxed);
+
+    const uint64_t samples = candidateSamples.load(std::memory_order_relaxed);
+    snapshot.averageCandidatesPerFrame = samples > 0 ? static_cast<double>(candidates.load(std::memory_order_relaxed)) / samples : 0;
+
+    snapshot.frameLatency = frameLatency.counts();
+    snapshot.imageLatency = imageLatency.counts();
+    return snapshot;
+  }
+
+  void RuntimeStats::reset() {
+    framesReceived.store(0, std::memory_order_relaxed);
+    framesProcessed.store(0, std::memory_order_relaxed);
+    framesDropped.store(0, std::memory_order_relaxed);
+    imagesProcessed.store(0, std::memory_order_relaxed);
+    platesFound.store(0, std::memory_order_relaxed);
+    candidates.store(0, std::memory_order_relaxed);
+    candidateSamples.store(0, std::memory_order_relaxed);
+    ocrCalls.store(0, std::memory_order_relaxed);
+    frameLatency.reset();
+    imageLatency.reset();
+  }
+}
@@ -0,0 +1,84 @@
+#ifndef VISIONCAMERAPLUGINANPR_RUNTIMESTATS_H
+#define VISIONCAMERAPLUGINANPR_RUNTIMESTATS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace visioncamerapluginanpr {
+  // Latency counts in fixed buckets. Recording is a single relaxed atomic increment, so it never blocks
+  // or allocates on the recognition path.
+  class LatencyHistogram {
+    public:
+      static constexpr size_t kBucketCount = 14;
+      // Inclusive upper bound of each bucket in milliseconds; the last bucket takes everything slower
+      static const std::array<double, kBucketCount> kUpperBoundsMs;
+
+      using Counts = std::array<uint64_t, kBucketCount>;
+
+      void record(double latencyMs);
+      Counts counts() const;
+      void reset();
+
+      // Upper bound of the bucket holding the given fraction of samples, or 0 without samples.
+      // Samples in the last bucket report the bound below it.
+      static double percentile(const Counts& counts, double fraction);
+
+    private:
+      std::array<std::atomic<uint64_t>, kBucketCount> buckets{};
+  };
+
+  struct RuntimeStatsSnapshot {
+    // Camera frames handed to recogniseFrame or recogniseFrameAsync
+    uint64_t framesReceived;
+    uint64_t framesProcessed;
+    // Frames turned down by the scheduler or motion gate, or replaced in the async mailbox before they were read
+    uint64_t framesDropped;
+    // Still images recognised with recognise
+    uint64_t imagesProcessed;
+    uint64_t platesFound;
+    // Plate regions handed to OpenALPR's reader by the paths that detect plates first (tracking, decimated
+    // detection, timing). Plain recognitions detect and read inside OpenALPR, which does not report them.
+    uint64_t ocrCalls;
+    // Detected plate regions per frame or image, over the recognitions that counted them
+    double averageCandidatesPerFrame;
+    LatencyHistogram::Counts frameLatency;
+    LatencyHistogram::Counts imageLatency;
+  };
+
+  // Lock-free counters for monitoring throughput on deployed devices. Updates are relaxed atomic
+  // increments that are safe from any thread; a snapshot is not one consistent instant across counters.
+  class RuntimeStats {
+    public:
+      RuntimeStats() = default;
+
+      RuntimeStats(const RuntimeStats&) = delete;
+      RuntimeStats& operator=(const RuntimeStats&) = delete;
+
+      void recordFrameReceived();
+      void recordFrameDropped();
+      void recordFrameProcessed(double latencyMs, size_t plates);
+      void recordImageProcessed(double latencyMs, size_t plates);
+
+      // Plate regions one recognition detected, and how many of them it went on to read
+      void recordCandidates(size_t detected, size_t read);
+
+      RuntimeStatsSnapshot snapshot() const;
+      void reset();
+
+    private:
+      std::atomic<uint64_t> framesReceived{0};
+      std::atomic<uint64_t> framesProcessed{0};
+      std::atomic<uint64_t> framesDropped{0};
+      std::atomic<uint64_t> imagesProcessed{0};
+      std::atomic<uint64_t> platesFound{0};
+      std::atomic<uint64_t> candidates{0};
+      std::atomic<uint64_t> candidateSamples{0};
+      std::atomic<uint64_t> ocrCalls{0};
+      LatencyHistogram frameLatency;
+      LatencyHistogram imageLatency;
+  };
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_RUNTIMESTATS_H */
@@ -0,0 +1,226 @@
+#include "stage-timing.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <streambuf>
+
+namespace visioncamerapluginanpr {
+  // Where std::cout writes from this thread go while a capture is alive
+  static thread_local std::string* t_captureOutput = nullptr;
+
+  // Unbuffered, so every write reaches it straight away and it never holds characters from two threads
+  class CaptureStreamBuffer : public std::streambuf {
+    public:
+      std::streambuf* fallback = nullptr;
+
+    protected:
+      int_type overflow(int_type ch) override {
+        if (traits_type::eq_int_type(ch, traits_type::eof())) {
+          return traits_type::not_eof(ch);
+        }
+
+        if (t_captureOutput) {
+          t_captureOutput->push_back(traits_type::to_char_type(ch));
+          return ch;
+        }
+
+        return fallback->sputc(traits_type::to_char_type(ch));
+      }
+
+      std::streamsize xsputn(const char* s, std::streamsize count) override {
+        if (t_captureOutput) {
+          t_captureOutput->append(s, static_cast<size_t>(count));
+          return count;
+        }
+
+        return fallback->sputn(s, count);
+      }
+
+      int sync() override {
+        return t_captureOutput ? 0 : fallback->pubsync();
+      }
+  };
+
+  // std::cout only goes through the capture buffer while some thread has a capture alive
+  static std::mutex g_captureMutex;
+  static size_t g_activeCaptures = 0;
+
+  // Never freed: a thread that was writing to std::cout as the last capture ended may still be inside it
+  static CaptureStreamBuffer& captureStreamBuffer() {
+    static CaptureStreamBuffer* buffer = new CaptureStreamBuffer();
+    return *buffer;
+  }
+
+  StageTimingCapture::StageTimingCapture() : previous(t_captureOutput) {
+    {
+      std::lock_guard<std::mutex> lock(g_captureMutex);
+      if (g_activeCaptures++ == 0) {
+        CaptureStreamBuffer& buffer = captureStreamBuffer();
+        buffer.fallback = std::cout.rdbuf();
+        std::cout.rdbuf(&buffer);
+      }
+    }
+    t_captureOutput = &output;
+  }
+
+  StageTimingCapture::~StageTimingCapture() {
+    t_captureOutput = previous;
+
+    std::lock_guard<std::mutex> lock(g_captureMutex);
+    if (--g_activeCaptures == 0) {
+      CaptureStreamBuffer& buffer = captureStreamBuffer();
+      // Left alone if something else has replaced std::cout's buffer in the meantime
+      if (std::cout.rdbuf() == &buffer) {
+        std::cout.rdbuf(buffer.fallback);
+      }
+    }
+  }
+
+  std::vector<StageTiming> StageTimingCapture::timings() const {
+    return parseStageTimings(output);
+  }
+
+  std::vector<StageTiming> parseStageTimings(const std::string& debugOutput) {
+    static const std::string kMarker = " Time:";
+
+    std::vector<StageTiming> timings;
+    std::istringstream lines(debugOutput);
+    std::string line;
+    while (std::getline(lines, line)) {
+      size_t marker = line.find(kMarker);
+      if (marker == std::string::npos) {
+        continue;
+      }
+
+      // Nested stages are printed with a "  -- " prefix
+      size_t start = line.find_first_not_of(" -\t");
+      if (start >= marker) {
+        continue;
+      }
+
+      const char* number = line.c_str() + marker + kMarker.size();
+      char* end = nullptr;
+      double ms = std::strtod(number, &end);
+      if (end == number) {
+        continue;
+      }
+
+      addStageTiming(timings, stageKey(line.substr(start, marker - start)), ms);
+    }
+
+    return timings;
+  }
+
+  std::string stageKey(const std::string& label) {
+    static const std::pair<const char*, const char*> kStages[] = {
+      { "LBP", "detection" },
+      { "Plate Detection", "detection" },
+      { "Plate Lines", "plateLines" },
+      { "Plate Corners", "plateCorners" },
+      { "Deskew", "deskew" },
+      { "deskew", "deskew" },
+      { "Character Analysis", "characterAnalysis" },
+      { "Produce Threshold", "thresholds" },
+      { "Character Segmenter", "segmentation" },
+      { "OCR", "ocr" },
+      { "PostProcess", "postProcess" },
+      { "State Identification", "stateIdentification" }
+    };
+
+    for (const auto& stage : kStages) {
+      if (label == stage.first) {
+        return stage.second;
+      }
+    }
+
+    std::string key;
+    bool upper = false;
+    for (char c : label) {
+      if (!std::isalnum(static_cast<unsigned char>(c))) {
+        upper = !key.empty();
+        continue;
+      }
+
+      key.push_back(upper ? std::toupper(static_cast<unsigned char>(c))
+                          : (key.empty() ? std::tolower(static_cast<unsigned char>(c)) : c));
+      upper = false;
+    }
+
+    return key;
+  }
+
+  void addStageTiming(std::vector<StageTiming>& timings, const std::string& stage, double ms, int runs) {
+    for (StageTiming& timing : timings) {
+      if (timing.stage == stage) {
+        timing.ms += ms;
+        timing.runs += runs;
+        return;
+      }
+    }
+
+    timings.push_back(StageTiming{ stage, ms, runs });
+  }
+
+  void addCandidateTiming(RecognitionTimings& timings, CandidateTiming candidate) {
+    if (candidate.plateIndex < 0) {
+      ++timings.candidatesRejected;
+    }
+
+    for (const StageTiming& stage : candidate.stages) {
+      if (stage.stage == "thresholds") {
+        timings.thresholdPasses += stage.runs;
+      }
+    }
+
+    timings.candidates.push_back(std::move(candidate));
+  }
+
+  void offsetTimings(RecognitionTimings& timings, const cv::Point& offset) {
+    for (CandidateTiming& candidate : timings.candidates) {
+      candidate.region += offset;
+    }
+  }
+
+  static void appendNumber(std::string& json, double value) {
+    char number[32];
+    std::snprintf(number, sizeof(number), "%.3f", value);
+    json += number;
+  }
+
+  // Stage keys are alphanumeric, so they need no escaping
+  static void appendStages(std::string& json, const std::vector<StageTiming>& stages) {
+    json += '{';
+    for (size_t i = 0; i < stages.size(); ++i) {
+      json += (i > 0 ? ",\"" : "\"") + stages[i].stage + "\":{\"ms\":";
+      appendNumber(json, stages[i].ms);
+      json += ",\"runs\":" + std::to_string(stages[i].runs) + '}';
+    }
+    json += '}';
+  }
+
+  std::string timingsToJson(const RecognitionTimings& timings) {
+    std::string json = "{\"totalMs\":";
+    appendNumber(json, timings.totalMs);
+    json += ",\"stages\":";
+    appendStages(json, timings.stages);
+
+    json += ",\"candidates\":[";
+    for (size_t i = 0; i < timings.candidates.size(); ++i) {
+      const CandidateTiming& candidate = timings.candidates[i];
+      json += i > 0 ? ",{" : "{";
+      json += "\"region\":{\"x\":" + std::to_string(candidate.region.x) + ",\"y\":" + std::to_string(candidate.region.y) +
+              ",\"width\":" + std::to_string(candidate.region.width) + ",\"height\":" + std::to_string(candidate.region.height) + '}';
+      json += ",\"plateIndex\":" + std::to_string(candidate.plateIndex) + ",\"stages\":";
+      appendStages(json, candidate.stages);
+      json += '}';
+    }
+
+    json += "],\"candidatesRejected\":" + std::to_string(timings.candidatesRejected);
+    json += ",\"thresholdPasses\":" + std::to_string(timings.thresholdPasses) + '}';
+    return json;
+  }
+}
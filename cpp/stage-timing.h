@@ -0,0 +1,77 @@
+#ifndef VISIONCAMERAPLUGINANPR_STAGETIMING_H
+#define VISIONCAMERAPLUGINANPR_STAGETIMING_H
+
+#include "opencv2/core.hpp"
+
+#include <string>
+#include <vector>
+
+namespace visioncamerapluginanpr {
+  // Time spent in one stage of recognition, summed over every time the stage ran
+  struct StageTiming {
+    std::string stage;
+    double ms = 0;
+    int runs = 0;
+  };
+
+  // Stages OpenALPR ran on one detected plate region
+  struct CandidateTiming {
+    cv::Rect region;
+    // Index of the plate read from the region, or -1 if OpenALPR rejected the region
+    int plateIndex = -1;
+    std::vector<StageTiming> stages;
+  };
+
+  // Where the time of one recognition went. Only collected when a caller asks for it.
+  struct RecognitionTimings {
+    double totalMs = 0;
+    // Stages that run once over the whole image, such as decode, rotate and detection
+    std::vector<StageTiming> stages;
+    std::vector<CandidateTiming> candidates;
+    int candidatesRejected = 0;
+    // Sets of binarization thresholds produced across all candidates
+    int thresholdPasses = 0;
+  };
+
+  // The prebuilt OpenALPR only reports its stage timings by printing them to std::cout when Config::debugTiming
+  // is set. While a capture is alive, whatever the current thread prints to std::cout is kept by the capture
+  // instead, so engines on other threads are unaffected. Captures nest; the innermost one collects. std::cout's
+  // own buffer is put back once no thread has a capture alive.
+  class StageTimingCapture {
+    public:
+      StageTimingCapture();
+      ~StageTimingCapture();
+
+      StageTimingCapture(const StageTimingCapture&) = delete;
+      StageTimingCapture& operator=(const StageTimingCapture&) = delete;
+
+      // Stage timings printed since the capture started, in the order each stage first ran
+      std::vector<StageTiming> timings() const;
+
+    private:
+      std::string output;
+      std::string* previous;
+  };
+
+  // Parses "<label> Time: <n>ms" lines printed by OpenALPR's debugTiming, ignoring everything else
+  std::vector<StageTiming> parseStageTimings(const std::string& debugOutput);
+
+  // Key for a stage label OpenALPR prints, e.g. "Plate Lines" -> "plateLines" and "LBP" -> "detection".
+  // Labels without a known stage are camel-cased.
+  std::string stageKey(const std::string& label);
+
+  // Records the stages of one candidate and updates the candidate counters
+  void addCandidateTiming(RecognitionTimings& timings, CandidateTiming candidate);
+
+  // Moves candidate regions by `offset`, alongside offsetResults
+  void offsetTimings(RecognitionTimings& timings, const cv::Point& offset);
+
+  // JSON object with totalMs, stages, candidates, candidatesRejected and thresholdPasses.
+  // Stages are objects keyed by stage name holding ms and runs.
+  std::string timingsToJson(const RecognitionTimings& timings);
+
+  // Adds one run of `ms` to a stage, appending the stage if it has not run yet
+  void addStageTiming(std::vector<StageTiming>& timings, const std::string& stage, double ms, int runs = 1);
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_STAGETIMING_H */
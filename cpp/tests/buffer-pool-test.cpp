@@ -0,0 +1,157 @@
+// Page-rounded buckets, alignment, the idle cap and the accounting of the scratch buffer pool.
+//
+//   cmake -S cpp/tests -B build/tests && cmake --build build/tests && ctest --test-dir build/tests
+
+#include "buffer-pool.h"
+#include "check.h"
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+using namespace visioncamerapluginanpr;
+
+namespace {
+  void testSizesRoundUpToWholePages() {
+    BufferPool pool;
+
+    CHECK(pool.acquire(0).size() == BufferPool::kGranularity);
+    CHECK(pool.acquire(1).size() == BufferPool::kGranularity);
+    CHECK(pool.acquire(BufferPool::kGranularity).size() == BufferPool::kGranularity);
+    CHECK(pool.acquire(BufferPool::kGranularity + 1).size() == 2 * BufferPool::kGranularity);
+    CHECK(pool.acquire(1920 * 1080).size() == 507 * BufferPool::kGranularity);
+  }
+
+  void testBuffersAreAlignedAndWritable() {
+    BufferPool pool;
+
+    for (size_t size : { 1, 100, 4097, 640 * 480 }) {
+      BufferPool::Buffer buffer = pool.acquire(size);
+      CHECK(buffer);
+      CHECK(reinterpret_cast<uintptr_t>(buffer.data()) % BufferPool::kAlignment == 0);
+      std::memset(buffer.data(), 0xab, buffer.size());
+    }
+  }
+
+  void testSameBucketIsReused() {
+    BufferPool pool;
+
+    uint8_t* first;
+    {
+      BufferPool::Buffer buffer = pool.acquire(5000);
+      first = buffer.data();
+    }
+
+    // Any size that rounds to the same number of pages gets the idle buffer back
+    BufferPool::Buffer again = pool.acquire(8000);
+    CHECK(again.data() == first);
+
+    BufferPoolStats stats = pool.stats();
+    CHECK(stats.allocations == 1);
+    CHECK(stats.reuses == 1);
+    CHECK(stats.bytesInUse == 2 * BufferPool::kGranularity);
+    CHECK(stats.bytesCached == 0);
+
+    // A different bucket does not
+    BufferPool::Buffer other = pool.acquire(9000);
+    CHECK(other.data() != first);
+    CHECK(pool.stats().allocations == 2);
+  }
+
+  void testIdleBuffersAreCappedAtMaxCachedBytes() {
+    const size_t page = BufferPool::kGranularity;
+    BufferPool pool(3 * page);
+
+    {
+      BufferPool::Buffer a = pool.acquire(2 * page);
+      BufferPool::Buffer b = pool.acquire(2 * page);
+      CHECK(pool.stats().bytesInUse == 4 * page);
+    }
+
+    // Only one of the two fits under the cap; the other was freed
+    BufferPoolStats stats = pool.stats();
+    CHECK(stats.bytesInUse == 0);
+    CHECK(stats.bytesCached == 2 * page);
+
+    pool.trim();
+    CHECK(pool.stats().bytesCached == 0);
+  }
+
+  void testDefaultCapIs64MegaBytes() {
+    const size_t megaByte = 1024 * 1024;
+    BufferPool pool;
+
+    // b goes back first and is kept; keeping a as well would hold 70 MB, so it is freed
+    {
+      BufferPool::Buffer a = pool.acquire(40 * megaByte);
+      BufferPool::Buffer b = pool.acquire(30 * megaByte);
+    }
+    CHECK(pool.stats().bytesCached == 30 * megaByte);
+
+    // 50 MB fits
+    {
+      BufferPool::Buffer c = pool.acquire(20 * megaByte);
+    }
+    CHECK(pool.stats().bytesCached == 50 * megaByte);
+  }
+
+  void testHighWaterMark() {
+    const size_t page = BufferPool::kGranularity;
+    BufferPool pool;
+
+    {
+      BufferPool::Buffer a = pool.acquire(page);
+      BufferPool::Buffer b = pool.acquire(3 * page);
+    }
+    // Both are now idle, and still count towards the footprint
+    CHECK(pool.stats().highWaterMark == 4 * page);
+
+    {
+      // Served from the cache, so the footprint does not grow
+      BufferPool::Buffer b = pool.acquire(3 * page);
+      CHECK(pool.stats().highWaterMark == 4 * page);
+
+      // A new bucket adds to what is already held
+      BufferPool::Buffer c = pool.acquire(2 * page);
+      CHECK(pool.stats().highWaterMark == 6 * page);
+    }
+
+    // A reset restarts the mark from the current footprint and clears the counters
+    pool.trim();
+    pool.resetStats();
+    BufferPoolStats stats = pool.stats();
+    CHECK(stats.highWaterMark == 0);
+    CHECK(stats.allocations == 0);
+    CHECK(stats.reuses == 0);
+  }
+
+  void testMovedLeaseReleasesOnce() {
+    BufferPool pool;
+
+    BufferPool::Buffer a = pool.acquire(100);
+    BufferPool::Buffer b = std::move(a);
+    CHECK(!a);
+    CHECK(b);
+
+    // Assigning over a live lease hands its old buffer back
+    b = pool.acquire(100);
+    CHECK(pool.stats().bytesInUse == BufferPool::kGranularity);
+    CHECK(pool.stats().bytesCached == BufferPool::kGranularity);
+
+    b = BufferPool::Buffer();
+    CHECK(pool.stats().bytesInUse == 0);
+    CHECK(pool.stats().bytesCached == 2 * BufferPool::kGranularity);
+  }
+}
+
+int main() {
+  testSizesRoundUpToWholePages();
+  testBuffersAreAlignedAndWritable();
+  testSameBucketIsReused();
+  testIdleBuffersAreCappedAtMaxCachedBytes();
+  testDefaultCapIs64MegaBytes();
+  testHighWaterMark();
+  testMovedLeaseReleasesOnce();
+
+  return checkResult();
+}
@@ -0,0 +1,172 @@
+// The plugin's LBP cascade scan against cv::CascadeClassifier, on every region cascade shipped in runtime_data.
+// Only built as part of the host build in cpp/CMakeLists.txt, which brings OpenCV:
+//
+//   cmake -S cpp -B build/host -DANPR_HOST_PREFIX=/opt/anpr-host && cmake --build build/host && ctest --test-dir build/host
+//
+// Scenes are synthetic, with plate-like rectangles of text on a noisy background, so that every stage of the
+// cascades is exercised and some windows pass them all. The packed files loadSharedLbpCascade writes are checked
+// against serializeLbpCascade in a scratch directory.
+
+#include "cascade-detector.h"
+#include "check.h"
+#include "opencv2/core.hpp"
+#include "opencv2/imgproc.hpp"
+#include "opencv2/objdetect.hpp"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace visioncamerapluginanpr;
+
+namespace {
+  // Equalized as DetectorCPU and SharedCascadeDetector do before scanning
+  cv::Mat syntheticScene(int seed) {
+    cv::RNG rng(seed);
+    cv::Mat scene(480, 640, CV_8UC1);
+    rng.fill(scene, cv::RNG::NORMAL, 110, 35);
+    cv::GaussianBlur(scene, scene, cv::Size(5, 5), 0);
+
+    static const char* const kTexts[] = { "ABC123", "7XYZ890", "KA01AB", "GH54TR" };
+    for (int i = 0; i < 4; ++i) {
+      const int width = rng.uniform(90, 260);
+      const int height = width * rng.uniform(20, 55) / 100;
+      const cv::Rect plate(rng.uniform(0, scene.cols - width), rng.uniform(0, scene.rows - height), width, height);
+      cv::rectangle(scene, plate, cv::Scalar(rng.uniform(190, 250)), cv::FILLED);
+      cv::rectangle(scene, plate, cv::Scalar(rng.uniform(10, 60)), 2);
+      cv::putText(scene, kTexts[i], cv::Point(plate.x + width / 12, plate.y + height * 3 / 4), cv::FONT_HERSHEY_DUPLEX,
+                  height / 40.0, cv::Scalar(rng.uniform(0, 50)), std::max(1, height / 20));
+    }
+
+    cv::equalizeHist(scene, scene);
+    return scene;
+  }
+
+  bool samePlates(std::vector<cv::Rect> a, std::vector<cv::Rect> b) {
+    auto byPosition = [](const cv::Rect& l, const cv::Rect& r) {
+      return std::tie(l.y, l.x, l.height, l.width) < std::tie(r.y, r.x, r.height, r.width);
+    };
+    std::sort(a.begin(), a.end(), byPosition);
+    std::sort(b.begin(), b.end(), byPosition);
+    return a == b;
+  }
+
+  std::vector<uint8_t> readBytes(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  }
+
+  void writeBytes(const std::string& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+  }
+
+  // `xmlPath` and `otherXmlPath` are two different cascades
+  void testLoaderWritesPackedCascade(const std::string& xmlPath, const std::string& otherXmlPath) {
+    char scratch[] = "/tmp/cascade-detector-test-XXXXXX";
+    CHECK(mkdtemp(scratch) != nullptr);
+    const std::string xml = std::string(scratch) + "/region.xml";
+    const std::string packed = packedCascadePath(xml);
+    std::filesystem::copy_file(xmlPath, xml);
+
+    const std::vector<uint8_t> expected = serializeLbpCascade(readLbpCascadeXml(xmlPath));
+    const std::vector<uint8_t> other = serializeLbpCascade(readLbpCascadeXml(otherXmlPath));
+    CHECK(expected != other);
+
+    // The first load parses the XML and leaves exactly what serializeLbpCascade writes beside it
+    std::shared_ptr<const LbpCascade> cascade = loadSharedLbpCascade(xml);
+    CHECK(cascade && serializeLbpCascade(*cascade) == expected);
+    CHECK(readBytes(packed) == expected);
+    CHECK(!std::filesystem::exists(packed + ".partial"));
+    cascade.reset();
+
+    // A packed file at least as new as the XML is read instead of it
+    writeBytes(packed, other);
+    std::filesystem::last_write_time(packed, std::filesystem::last_write_time(xml) + std::chrono::seconds(10));
+    cascade = loadSharedLbpCascade(xml);
+    CHECK(cascade && serializeLbpCascade(*cascade) == other);
+    cascade.reset();
+
+    // One older than the XML is stale: the XML is read and the packed file rewritten
+    std::filesystem::last_write_time(packed, std::filesystem::last_write_time(xml) - std::chrono::seconds(10));
+    cascade = loadSharedLbpCascade(xml);
+    CHECK(cascade && serializeLbpCascade(*cascade) == expected);
+    CHECK(readBytes(packed) == expected);
+    cascade.reset();
+
+    std::filesystem::remove_all(scratch);
+  }
+
+  void testPackedRoundTrip(const std::string& path) {
+    const LbpCascade cascade = readLbpCascadeXml(path);
+    const std::vector<uint8_t> packed = serializeLbpCascade(cascade);
+    CHECK(serializeLbpCascade(parseLbpCascade(packed.data(), packed.size())) == packed);
+  }
+
+  void testMatchesCascadeClassifier(const std::string& path) {
+    cv::CascadeClassifier classifier;
+    CHECK(classifier.load(path));
+    const LbpCascade cascade = readLbpCascadeXml(path);
+    LbpScanBuffers buffers;
+
+    // The scale step and strictness of the default openalpr.conf, then a coarser and a looser scan
+    const std::tuple<double, int, cv::Size, cv::Size> scans[] = {
+      { 1.1, 3, cv::Size(), cv::Size() },
+      { 1.05, 3, cv::Size(60, 30), cv::Size(400, 200) },
+      { 1.25, 1, cv::Size(), cv::Size() }
+    };
+
+    for (int seed = 1; seed <= 6; ++seed) {
+      const cv::Mat scene = syntheticScene(seed);
+      for (const auto& [scaleFactor, minNeighbors, minSize, maxSize] : scans) {
+        std::vector<cv::Rect> expected;
+        classifier.detectMultiScale(scene, expected, scaleFactor, minNeighbors, 0, minSize, maxSize);
+
+        // Serial, one work item per scale, and runs of scales on at most two threads as an engine's share gets
+        const std::pair<bool, int> schedules[] = { { false, 0 }, { true, 0 }, { true, 2 } };
+        for (LbpEvaluator evaluator : { LbpEvaluator::Scalar, LbpEvaluator::Vector }) {
+          for (const auto& [parallel, maxThreads] : schedules) {
+            const bool same = samePlates(detectLbpCascade(cascade, scene, scaleFactor, minNeighbors, minSize, maxSize, buffers,
+                                                          evaluator, parallel, maxThreads), expected);
+            if (!same) {
+              std::printf("%s differs from cv::CascadeClassifier on scene %d at scale %.2f (%s, %s, %d threads)\n", path.c_str(),
+                          seed, scaleFactor, evaluator == LbpEvaluator::Vector ? "vector" : "scalar",
+                          parallel ? "parallel" : "serial", maxThreads);
+            }
+            CHECK(same);
+          }
+        }
+      }
+    }
+  }
+}
+
+int main() {
+  std::vector<std::string> paths;
+  for (const auto& entry : std::filesystem::directory_iterator(ANPR_REGION_CASCADE_DIR)) {
+    if (entry.path().extension() == ".xml") {
+      paths.push_back(entry.path().string());
+    }
+  }
+  std::sort(paths.begin(), paths.end());
+  CHECK(paths.size() >= 2);
+
+  testLoaderWritesPackedCascade(paths[0], paths[1]);
+
+  for (const std::string& path : paths) {
+    testPackedRoundTrip(path);
+    testMatchesCascadeClassifier(path);
+  }
+
+  return checkResult();
+}
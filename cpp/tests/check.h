@@ -0,0 +1,31 @@
+#ifndef VISIONCAMERAPLUGINANPR_TESTS_CHECK_H
+#define VISIONCAMERAPLUGINANPR_TESTS_CHECK_H
+
+// The assertions every host test uses: a failed CHECK is reported and counted, and the test carries on.
+
+#include <cstdio>
+
+namespace {
+  int g_failures = 0;
+
+  #define CHECK(condition) \
+    do { \
+      if (!(condition)) { \
+        std::printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+        ++g_failures; \
+      } \
+    } while (0)
+
+  // Reports how the checks went, for main to return
+  int checkResult() {
+    if (g_failures > 0) {
+      std::printf("%d check(s) failed\n", g_failures);
+      return 1;
+    }
+
+    std::printf("All checks passed\n");
+    return 0;
+  }
+}
+
+#endif /* VISIONCAMERAPLUGINANPR_TESTS_CHECK_H */
@@ -0,0 +1,101 @@
+// Rectangle mapping for crop-before-rotate, checked against the rotation kernels.
+//
+//   cmake -S cpp/tests -B build/tests && cmake --build build/tests && ctest --test-dir build/tests
+
+#include "frame-rotation.h"
+#include "check.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace visioncamerapluginanpr;
+
+namespace {
+  const FrameRotation kRotations[] = {
+    FrameRotation::None, FrameRotation::Clockwise90, FrameRotation::Rotate180, FrameRotation::CounterClockwise90
+  };
+
+  // Bounding box of the non-zero pixels of a plane
+  PlaneRect markedRect(const std::vector<uint8_t>& plane, int width, int height) {
+    int left = width, top = height, right = 0, bottom = 0;
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        if (plane[y * width + x]) {
+          left = std::min(left, x);
+          top = std::min(top, y);
+          right = std::max(right, x + 1);
+          bottom = std::max(bottom, y + 1);
+        }
+      }
+    }
+    return PlaneRect{ left, top, right - left, bottom - top };
+  }
+
+  void testRectFollowsPixels() {
+    const int width = 37, height = 23;
+    const PlaneRect rect{ 5, 14, 11, 6 };
+
+    std::vector<uint8_t> src(width * height, 0);
+    for (int y = rect.y; y < rect.y + rect.height; ++y) {
+      std::fill(src.begin() + y * width + rect.x, src.begin() + y * width + rect.x + rect.width, 1);
+    }
+
+    for (FrameRotation rotation : kRotations) {
+      for (bool mirrored : { false, true }) {
+        const int dstWidth = isTransposed(rotation) ? height : width;
+        const int dstHeight = isTransposed(rotation) ? width : height;
+        std::vector<uint8_t> dst(dstWidth * dstHeight, 0);
+        rotatePlaneReference(src.data(), width, height, width, dst.data(), dstWidth, rotation, mirrored);
+
+        PlaneRect expected = markedRect(dst, dstWidth, dstHeight);
+        PlaneRect actual = rotateRect(rect, width, height, rotation, mirrored);
+        CHECK(actual.x == expected.x && actual.y == expected.y);
+        CHECK(actual.width == expected.width && actual.height == expected.height);
+
+        PlaneRect restored = unrotateRect(actual, width, height, rotation, mirrored);
+        CHECK(restored.x == rect.x && restored.y == rect.y);
+        CHECK(restored.width == rect.width && restored.height == rect.height);
+      }
+    }
+  }
+
+  // Rotating only a window of the plane gives the same pixels as cutting that window out of the rotated plane
+  void testCropBeforeRotate() {
+    const int width = 96, height = 64;
+    const PlaneRect crop{ 13, 40, 50, 21 };
+
+    std::vector<uint8_t> src(width * height);
+    for (size_t i = 0; i < src.size(); ++i) {
+      src[i] = static_cast<uint8_t>(i * 31 + i / width);
+    }
+
+    for (FrameRotation rotation : kRotations) {
+      for (bool mirrored : { false, true }) {
+        const int dstWidth = isTransposed(rotation) ? height : width;
+        const int dstHeight = isTransposed(rotation) ? width : height;
+        std::vector<uint8_t> full(dstWidth * dstHeight);
+        rotatePlane(src.data(), width, height, width, full.data(), dstWidth, rotation, mirrored);
+
+        const PlaneRect window = rotateRect(crop, width, height, rotation, mirrored);
+        std::vector<uint8_t> cropped(window.width * window.height);
+        rotatePlane(src.data() + crop.y * width + crop.x, crop.width, crop.height, width,
+                    cropped.data(), window.width, rotation, mirrored);
+
+        bool matches = true;
+        for (int y = 0; y < window.height; ++y) {
+          for (int x = 0; x < window.width; ++x) {
+            matches = matches && cropped[y * window.width + x] == full[(window.y + y) * dstWidth + window.x + x];
+          }
+        }
+        CHECK(matches);
+      }
+    }
+  }
+}
+
+int main() {
+  testRectFollowsPixels();
+  testCropBeforeRotate();
+
+  return checkResult();
+}
@@ -0,0 +1,130 @@
+// Admission decisions of the adaptive frame scheduler, driven by a simulated clock.
+//
+//   cmake -S cpp/tests -B build/tests && cmake --build build/tests && ctest --test-dir build/tests
+
+#include "frame-scheduler.h"
+#include "check.h"
+
+
+using namespace visioncamerapluginanpr;
+
+namespace {
+  void testUnlimitedProcessesEverything() {
+    FrameScheduler scheduler;
+
+    for (int i = 0; i < 30; ++i) {
+      CHECK(scheduler.schedule(i * 33.0) == ScheduleDecision::Process);
+      scheduler.recordLatency(80);
+    }
+
+    FrameSchedulerStats stats = scheduler.stats();
+    CHECK(stats.processed == 30);
+    CHECK(stats.skippedFrameRate + stats.skippedDutyCycle + stats.skippedLatency == 0);
+  }
+
+  void testFrameRateLimit() {
+    FrameScheduler scheduler;
+    scheduler.configure({ 10, 1, 0 });
+
+    // 30fps camera against a 10fps limit admits one frame in three
+    int processed = 0;
+    for (int i = 0; i < 30; ++i) {
+      if (scheduler.schedule(i * (1000.0 / 30)) == ScheduleDecision::Process) {
+        ++processed;
+      }
+    }
+
+    CHECK(processed == 10);
+    CHECK(scheduler.stats().skippedFrameRate == 20);
+  }
+
+  void testDutyCycle() {
+    FrameScheduler scheduler;
+    scheduler.configure({ 0, 0.25, 0 });
+
+    for (int i = 0; i < 10; ++i) {
+      scheduler.recordLatency(100);
+    }
+
+    // 100ms recognitions at 25% duty start at most every 400ms
+    CHECK(scheduler.schedule(0) == ScheduleDecision::Process);
+    CHECK(scheduler.schedule(200) == ScheduleDecision::SkipDutyCycle);
+    CHECK(scheduler.schedule(399) == ScheduleDecision::SkipDutyCycle);
+    CHECK(scheduler.schedule(400) == ScheduleDecision::Process);
+    CHECK(scheduler.stats().skippedDutyCycle == 2);
+  }
+
+  void testLatencyBackoff() {
+    FrameScheduler scheduler;
+    scheduler.configure({ 0, 1, 100 });
+
+    for (int i = 0; i < 20; ++i) {
+      scheduler.recordLatency(100);
+    }
+    // A throttled tail: p95 at 200ms, twice the target
+    for (int i = 0; i < 2; ++i) {
+      scheduler.recordLatency(200);
+    }
+
+    FrameSchedulerStats stats = scheduler.stats();
+    CHECK(stats.p50LatencyMs == 100);
+    CHECK(stats.p95LatencyMs == 200);
+
+    CHECK(scheduler.schedule(0) == ScheduleDecision::Process);
+    CHECK(scheduler.schedule(150) == ScheduleDecision::SkipLatency);
+    CHECK(scheduler.schedule(200) == ScheduleDecision::Process);
+
+    // Once latency recovers the back-off goes away
+    for (size_t i = 0; i < FrameScheduler::kLatencyWindow; ++i) {
+      scheduler.recordLatency(90);
+    }
+    CHECK(scheduler.schedule(290) == ScheduleDecision::Process);
+  }
+
+  void testRevoke() {
+    FrameScheduler scheduler;
+    scheduler.configure({ 10, 1, 0 });
+
+    CHECK(scheduler.schedule(0) == ScheduleDecision::Process);
+    // Admitted, then found static: the next frame is measured from the admission before it
+    CHECK(scheduler.schedule(100) == ScheduleDecision::Process);
+    scheduler.revoke();
+    CHECK(scheduler.stats().processed == 1);
+    CHECK(scheduler.schedule(133) == ScheduleDecision::Process);
+    CHECK(scheduler.schedule(166) == ScheduleDecision::SkipFrameRate);
+
+    // Revoking the first admission leaves nothing to wait for
+    FrameScheduler fresh;
+    fresh.configure({ 10, 1, 0 });
+    fresh.schedule(0);
+    fresh.revoke();
+    CHECK(fresh.schedule(1) == ScheduleDecision::Process);
+    CHECK(fresh.stats().processed == 1);
+  }
+
+  void testResetStats() {
+    FrameScheduler scheduler;
+    scheduler.configure({ 10, 1, 0 });
+    scheduler.schedule(0);
+    scheduler.schedule(10);
+    scheduler.recordLatency(50);
+    scheduler.resetStats();
+
+    FrameSchedulerStats stats = scheduler.stats();
+    CHECK(stats.processed == 0);
+    CHECK(stats.skippedFrameRate == 0);
+    // The latency window is kept; it describes the engine, not the counters
+    CHECK(stats.latencySamples == 1);
+  }
+}
+
+int main() {
+  testUnlimitedProcessesEverything();
+  testFrameRateLimit();
+  testDutyCycle();
+  testLatencyBackoff();
+  testRevoke();
+  testResetStats();
+
+  return checkResult();
+}
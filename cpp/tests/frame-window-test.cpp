@@ -0,0 +1,82 @@
+// Which part of a camera frame is rotated and searched for a given set of regions of interest.
+//
+//   cmake -S cpp/tests -B build/tests && cmake --build build/tests && ctest --test-dir build/tests
+
+#include "frame-window.h"
+#include "check.h"
+
+#include <stdexcept>
+
+using namespace visioncamerapluginanpr;
+
+namespace {
+  const cv::Size kSensorSize(1920, 1080);
+
+  void testWholeFrame() {
+    FrameWindow window = computeFrameWindow(kSensorSize, FrameRotation::Clockwise90, false, {});
+
+    CHECK(window.source == cv::Rect(0, 0, 1920, 1080));
+    CHECK(window.upright == cv::Rect(0, 0, 1080, 1920));
+    CHECK(window.frameSize == cv::Size(1080, 1920));
+    CHECK(window.regionsOfInterest.empty());
+  }
+
+  void testSingleRegionBecomesWindow() {
+    // The bottom third of an upright landscape frame
+    FrameWindow window = computeFrameWindow(kSensorSize, FrameRotation::None, false, { cv::Rect(0, 720, 1920, 360) });
+
+    CHECK(window.source == cv::Rect(0, 720, 1920, 360));
+    CHECK(window.upright == cv::Rect(0, 720, 1920, 360));
+    CHECK(window.frameSize == kSensorSize);
+    CHECK(window.regionsOfInterest.empty());
+  }
+
+  void testRegionsAreClippedAndBounded() {
+    FrameWindow window = computeFrameWindow(kSensorSize, FrameRotation::Rotate180, false, {
+      cv::Rect(100, 900, 400, 300),
+      cv::Rect(1500, 800, 200, 100)
+    });
+
+    // The first region runs off the bottom of the frame
+    CHECK(window.source == cv::Rect(100, 800, 1600, 280));
+    CHECK(window.upright == cv::Rect(220, 0, 1600, 280));
+    CHECK(window.regionsOfInterest.size() == 2);
+    CHECK(window.regionsOfInterest[0] == cv::Rect(1200, 0, 400, 180));
+    CHECK(window.regionsOfInterest[1] == cv::Rect(0, 180, 200, 100));
+
+    bool threw = false;
+    try {
+      computeFrameWindow(kSensorSize, FrameRotation::None, false, { cv::Rect(2000, 0, 100, 100) });
+    } catch (const std::invalid_argument&) {
+      threw = true;
+    }
+    CHECK(threw);
+  }
+
+  void testMotionNarrowsSearch() {
+    FrameWindow window = computeFrameWindow(kSensorSize, FrameRotation::None, false, { cv::Rect(0, 720, 1920, 360) });
+    CHECK(restrictToMotion(window, cv::Rect(500, 600, 300, 300)));
+    CHECK(window.regionsOfInterest.size() == 1);
+    CHECK(window.regionsOfInterest[0] == cv::Rect(500, 0, 300, 180));
+
+    FrameWindow staticWindow = computeFrameWindow(kSensorSize, FrameRotation::None, false, { cv::Rect(0, 720, 1920, 360) });
+    CHECK(!restrictToMotion(staticWindow, cv::Rect(500, 100, 300, 300)));
+
+    FrameWindow split = computeFrameWindow(kSensorSize, FrameRotation::None, false, {
+      cv::Rect(0, 800, 400, 200),
+      cv::Rect(1400, 800, 400, 200)
+    });
+    CHECK(restrictToMotion(split, cv::Rect(1500, 850, 100, 100)));
+    CHECK(split.regionsOfInterest.size() == 1);
+    CHECK(split.regionsOfInterest[0] == cv::Rect(1500, 50, 100, 100));
+  }
+}
+
+int main() {
+  testWholeFrame();
+  testSingleRegionBecomesWindow();
+  testRegionsAreClippedAndBounded();
+  testMotionNarrowsSearch();
+
+  return checkResult();
+}
@@ -0,0 +1,83 @@
+// Reading a JPEG's size from its frame header, and the decode reduction picked for detection.
+//
+//   cmake -S cpp/tests -B build/tests && cmake --build build/tests && ctest --test-dir build/tests
+
+#include "jpeg-header.h"
+#include "check.h"
+
+#include <vector>
+
+using namespace visioncamerapluginanpr;
+
+namespace {
+  void appendSegment(std::vector<uint8_t>& jpeg, uint8_t marker, const std::vector<uint8_t>& payload) {
+    const size_t length = payload.size() + 2;
+    jpeg.insert(jpeg.end(), { 0xFF, marker, static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(length & 0xFF) });
+    jpeg.insert(jpeg.end(), payload.begin(), payload.end());
+  }
+
+  // SOI, an APP1 segment standing in for EXIF, a quantization table, padding and a frame header of the given type
+  std::vector<uint8_t> jpegHeader(uint8_t frameMarker, int width, int height) {
+    std::vector<uint8_t> jpeg = { 0xFF, 0xD8 };
+    appendSegment(jpeg, 0xE1, std::vector<uint8_t>(300, 0xAB));
+    appendSegment(jpeg, 0xDB, std::vector<uint8_t>(65, 0x01));
+    jpeg.insert(jpeg.end(), { 0xFF, 0xFF });
+    appendSegment(jpeg, frameMarker, {
+      8,
+      static_cast<uint8_t>(height >> 8), static_cast<uint8_t>(height & 0xFF),
+      static_cast<uint8_t>(width >> 8), static_cast<uint8_t>(width & 0xFF),
+      1, 1, 0x11, 0
+    });
+    return jpeg;
+  }
+
+  void testReadJpegSize() {
+    cv::Size size;
+
+    std::vector<uint8_t> baseline = jpegHeader(0xC0, 4000, 3000);
+    CHECK(readJpegSize(baseline.data(), baseline.size(), size) && size == cv::Size(4000, 3000));
+
+    std::vector<uint8_t> progressive = jpegHeader(0xC2, 640, 480);
+    CHECK(readJpegSize(progressive.data(), progressive.size(), size) && size == cv::Size(640, 480));
+
+    // A Huffman table segment sits in the SOF range but is not a frame header
+    std::vector<uint8_t> huffmanFirst = { 0xFF, 0xD8 };
+    appendSegment(huffmanFirst, 0xC4, std::vector<uint8_t>(20, 0));
+    std::vector<uint8_t> rest = jpegHeader(0xC1, 1920, 1080);
+    huffmanFirst.insert(huffmanFirst.end(), rest.begin() + 2, rest.end());
+    CHECK(readJpegSize(huffmanFirst.data(), huffmanFirst.size(), size) && size == cv::Size(1920, 1080));
+
+    std::vector<uint8_t> truncated(baseline.begin(), baseline.end() - 6);
+    CHECK(!readJpegSize(truncated.data(), truncated.size(), size));
+
+    std::vector<uint8_t> scanFirst = { 0xFF, 0xD8 };
+    appendSegment(scanFirst, 0xDA, std::vector<uint8_t>(10, 0));
+    CHECK(!readJpegSize(scanFirst.data(), scanFirst.size(), size));
+
+    const uint8_t png[] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    CHECK(!readJpegSize(png, sizeof(png), size));
+    CHECK(!readJpegSize(nullptr, 0, size));
+  }
+
+  void testJpegReduction() {
+    const cv::Size maxDetection(1280, 720);
+
+    CHECK(jpegReduction(cv::Size(1280, 720), maxDetection) == 1);
+    CHECK(jpegReduction(cv::Size(640, 480), maxDetection) == 1);
+    CHECK(jpegReduction(cv::Size(2560, 1440), maxDetection) == 2);
+    // 12 MP: the detector keeps 960x720, so a quarter-scale decode at 1000x750 is enough
+    CHECK(jpegReduction(cv::Size(4000, 3000), maxDetection) == 4);
+    // Portrait, or turned by EXIF orientation: the detector keeps 720x540 either way round
+    CHECK(jpegReduction(cv::Size(3000, 4000), maxDetection) == 4);
+    CHECK(jpegReduction(cv::Size(20000, 15000), maxDetection) == 8);
+    CHECK(jpegReduction(cv::Size(2559, 1439), maxDetection) == 1);
+    CHECK(jpegReduction(cv::Size(), maxDetection) == 1);
+  }
+}
+
+int main() {
+  testReadJpegSize();
+  testJpegReduction();
+
+  return checkResult();
+}
@@ -0,0 +1,210 @@
+// Packed LBP cascades and the LBP code and stage evaluation they are run with.
+//
+//   cmake -S cpp/tests -B build/tests && cmake --build build/tests && ctest --test-dir build/tests
+
+#include "lbp-cascade.h"
+#include "check.h"
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace visioncamerapluginanpr;
+
+namespace {
+  // Two stages over a 12x6 window: the first accepts every window, the second only windows whose first feature has
+  // a brighter top-left cell than its centre
+  LbpCascade testCascade() {
+    LbpCascade cascade;
+    cascade.windowWidth = 12;
+    cascade.windowHeight = 6;
+    cascade.features = { { 0, 0, 4, 2 }, { 3, 0, 2, 1 } };
+
+    LbpCascade::Weak always;
+    always.feature = 1;
+    always.subset.fill(0xffffffffu);
+    always.leaves = { 1.0f, -1.0f };
+
+    LbpCascade::Weak topLeft;
+    topLeft.feature = 0;
+    topLeft.subset.fill(0);
+    // Codes 128-255, i.e. with the top-left bit set
+    for (size_t i = 4; i < 8; ++i) {
+      topLeft.subset[i] = 0xffffffffu;
+    }
+    topLeft.leaves = { 0.75f, -0.5f };
+
+    cascade.weaks = { always, topLeft, always };
+    cascade.stages = { { 0.5f, 0, 1 }, { 1.0f, 1, 2 } };
+    return cascade;
+  }
+
+  bool rejects(const std::vector<uint8_t>& bytes) {
+    try {
+      parseLbpCascade(bytes.data(), bytes.size());
+      return false;
+    } catch (const std::runtime_error&) {
+      return true;
+    }
+  }
+
+  // Integral image of an 8-bit image, one row and column larger, as cv::integral produces with CV_32S
+  std::vector<int> integralImage(const std::vector<uint8_t>& image, int width, int height) {
+    std::vector<int> sum((width + 1) * (height + 1), 0);
+    for (int y = 0; y < height; ++y) {
+      int row = 0;
+      for (int x = 0; x < width; ++x) {
+        row += image[y * width + x];
+        sum[(y + 1) * (width + 1) + x + 1] = sum[y * (width + 1) + x + 1] + row;
+      }
+    }
+    return sum;
+  }
+
+  int cellSum(const std::vector<uint8_t>& image, int width, int x, int y, int cellWidth, int cellHeight) {
+    int sum = 0;
+    for (int row = y; row < y + cellHeight; ++row) {
+      for (int column = x; column < x + cellWidth; ++column) {
+        sum += image[row * width + column];
+      }
+    }
+    return sum;
+  }
+
+  // The LBP code computed directly from pixel sums, with OpenCV's neighbour order
+  int bruteForceCode(const std::vector<uint8_t>& image, int width, int x, int y, const LbpCascade::Feature& feature) {
+    auto cell = [&](int column, int row) {
+      return cellSum(image, width, x + feature.x + column * feature.width, y + feature.y + row * feature.height,
+                     feature.width, feature.height);
+    };
+    static const int kNeighbours[8][2] = { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 2, 1 }, { 2, 2 }, { 1, 2 }, { 0, 2 }, { 0, 1 } };
+
+    const int centre = cell(1, 1);
+    int code = 0;
+    for (int i = 0; i < 8; ++i) {
+      code |= (cell(kNeighbours[i][0], kNeighbours[i][1]) >= centre ? 1 : 0) << (7 - i);
+    }
+    return code;
+  }
+
+  void testRoundTrip() {
+    const LbpCascade cascade = testCascade();
+    const std::vector<uint8_t> bytes = serializeLbpCascade(cascade);
+    CHECK(bytes.size() == LbpCascade::kHeaderSize + 2 * 12 + 3 * 44 + 2 * 16);
+    CHECK(std::memcmp(bytes.data(), "ANPRLBPC", 8) == 0);
+
+    const LbpCascade parsed = parseLbpCascade(bytes.data(), bytes.size());
+    CHECK(parsed.windowWidth == 12 && parsed.windowHeight == 6);
+    CHECK(parsed.stages.size() == 2 && parsed.weaks.size() == 3 && parsed.features.size() == 2);
+    CHECK(parsed.stages[1].threshold == 1.0f && parsed.stages[1].firstWeak == 1 && parsed.stages[1].weakCount == 2);
+    CHECK(parsed.weaks[1].subset == cascade.weaks[1].subset && parsed.weaks[1].leaves == cascade.weaks[1].leaves);
+    CHECK(parsed.features[1].x == 3 && parsed.features[1].width == 2);
+    CHECK(serializeLbpCascade(parsed) == bytes);
+  }
+
+  void testInvalid() {
+    const std::vector<uint8_t> valid = serializeLbpCascade(testCascade());
+
+    CHECK(rejects({}));
+    CHECK(rejects(std::vector<uint8_t>(valid.begin(), valid.begin() + LbpCascade::kHeaderSize - 1)));
+    CHECK(rejects(std::vector<uint8_t>(valid.begin(), valid.end() - 1)));
+
+    std::vector<uint8_t> padded = valid;
+    padded.push_back(0);
+    CHECK(rejects(padded));
+
+    std::vector<uint8_t> magic = valid;
+    magic[0] = 'X';
+    CHECK(rejects(magic));
+
+    std::vector<uint8_t> version = valid;
+    version[8] = LbpCascade::kFormatVersion + 1;
+    CHECK(rejects(version));
+
+    LbpCascade stageRange = testCascade();
+    stageRange.stages[1].weakCount = 3;
+    CHECK(rejects(serializeLbpCascade(stageRange)));
+
+    LbpCascade featureRange = testCascade();
+    featureRange.weaks[2].feature = 2;
+    CHECK(rejects(serializeLbpCascade(featureRange)));
+
+    LbpCascade outsideWindow = testCascade();
+    outsideWindow.features[1].x = 7;
+    CHECK(rejects(serializeLbpCascade(outsideWindow)));
+
+    LbpCascade noWindow = testCascade();
+    noWindow.windowHeight = 0;
+    CHECK(rejects(serializeLbpCascade(noWindow)));
+  }
+
+  void testLbpCode() {
+    const int width = 40;
+    const int height = 24;
+    std::mt19937 random(7);
+    std::vector<uint8_t> image(width * height);
+    for (uint8_t& pixel : image) {
+      // Few distinct values, so cells with equal sums come up
+      pixel = static_cast<uint8_t>(random() % 4 * 60);
+    }
+    const std::vector<int> sum = integralImage(image, width, height);
+
+    LbpCascade cascade = testCascade();
+    cascade.features.push_back({ 1, 2, 1, 1 });
+    cascade.features.push_back({ 0, 0, 3, 2 });
+    const std::vector<LbpFeatureOffsets> offsets = lbpFeatureOffsets(cascade, width + 1);
+
+    int mismatches = 0;
+    for (int y = 0; y + cascade.windowHeight <= height; ++y) {
+      for (int x = 0; x + cascade.windowWidth <= width; ++x) {
+        for (size_t f = 0; f < cascade.features.size(); ++f) {
+          if (lbpCode(&sum[y * (width + 1) + x], offsets[f]) != bruteForceCode(image, width, x, y, cascade.features[f])) {
+            ++mismatches;
+          }
+        }
+      }
+    }
+    CHECK(mismatches == 0);
+  }
+
+  void testEvaluate() {
+    const LbpCascade cascade = testCascade();
+    const int width = 12;
+    const int height = 6;
+    const std::vector<LbpFeatureOffsets> offsets = lbpFeatureOffsets(cascade, width + 1);
+
+    // A bright top-left cell passes the second stage: 1.0 + 0.75 is not below 1.0
+    std::vector<uint8_t> bright(width * height, 10);
+    for (int y = 0; y < 2; ++y) {
+      for (int x = 0; x < 4; ++x) {
+        bright[y * width + x] = 200;
+      }
+    }
+    CHECK(evaluateLbpCascade(cascade, offsets, integralImage(bright, width, height).data()) == 1);
+
+    // A dark one does not: 1.0 - 0.5
+    std::vector<uint8_t> dark(width * height, 100);
+    for (int y = 0; y < 2; ++y) {
+      for (int x = 0; x < 4; ++x) {
+        dark[y * width + x] = 0;
+      }
+    }
+    CHECK(evaluateLbpCascade(cascade, offsets, integralImage(dark, width, height).data()) == -1);
+
+    // Nothing passes a first stage that cannot be reached
+    LbpCascade strict = cascade;
+    strict.stages[0].threshold = 2.0f;
+    CHECK(evaluateLbpCascade(strict, offsets, integralImage(bright, width, height).data()) == 0);
+  }
+}
+
+int main() {
+  testRoundTrip();
+  testInvalid();
+  testLbpCode();
+  testEvaluate();
+
+  return checkResult();
+}
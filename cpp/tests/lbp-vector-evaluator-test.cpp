@@ -0,0 +1,110 @@
+// The vectorized LBP cascade evaluator, window by window against evaluateLbpCascade.
+//
+//   cmake -S cpp/tests -B build/tests && cmake --build build/tests && ctest --test-dir build/tests
+
+#include "lbp-vector-evaluator.h"
+#include "check.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace visioncamerapluginanpr;
+
+namespace {
+  // Random stumps over a 24x12 window. Stage thresholds sit low enough in their sums' range that windows are
+  // rejected at many stages as well as accepted.
+  LbpCascade randomCascade(std::mt19937& random) {
+    LbpCascade cascade;
+    cascade.windowWidth = 24;
+    cascade.windowHeight = 12;
+
+    for (int i = 0; i < 40; ++i) {
+      const int32_t width = 1 + random() % 8;
+      const int32_t height = 1 + random() % 4;
+      cascade.features.push_back({ static_cast<int32_t>(random() % (25 - 3 * width)),
+                                   static_cast<int32_t>(random() % (13 - 3 * height)), width, height });
+    }
+
+    std::uniform_real_distribution<float> leaf(-1.0f, 1.0f);
+    for (int s = 0; s < 6; ++s) {
+      LbpCascade::Stage stage;
+      stage.firstWeak = static_cast<uint32_t>(cascade.weaks.size());
+      stage.weakCount = 3 + s;
+      stage.threshold = leaf(random) * 0.25f - 1.0f;
+      for (uint32_t w = 0; w < stage.weakCount; ++w) {
+        LbpCascade::Weak weak;
+        weak.feature = random() % cascade.features.size();
+        for (uint32_t& word : weak.subset) {
+          word = static_cast<uint32_t>(random());
+        }
+        weak.leaves = { leaf(random), leaf(random) };
+        cascade.weaks.push_back(weak);
+      }
+      cascade.stages.push_back(stage);
+    }
+    return cascade;
+  }
+
+  // Integral image with LbpVectorEvaluator::kPadding columns to spare on every row
+  std::vector<int> paddedIntegral(const std::vector<uint8_t>& image, int width, int height, size_t step) {
+    std::vector<int> sum(step * (height + 1), 0);
+    for (int y = 0; y < height; ++y) {
+      int row = 0;
+      for (int x = 0; x < width; ++x) {
+        row += image[y * width + x];
+        sum[(y + 1) * step + x + 1] = sum[y * step + x + 1] + row;
+      }
+    }
+    return sum;
+  }
+
+  void testMatchesScalar(int stride) {
+    std::mt19937 random(11 + stride);
+    const LbpCascade cascade = randomCascade(random);
+    const int width = 80;
+    const int height = 40;
+    const size_t step = width + 1 + LbpVectorEvaluator::kPadding;
+
+    std::vector<uint8_t> image(width * height);
+    for (uint8_t& pixel : image) {
+      pixel = static_cast<uint8_t>(random() % 6 * 40);
+    }
+    const std::vector<int> sum = paddedIntegral(image, width, height, step);
+
+    const LbpVectorEvaluator evaluator(cascade, step);
+    const std::vector<LbpFeatureOffsets> offsets = lbpFeatureOffsets(cascade, step);
+    CHECK(evaluator.integralStep() == step);
+
+    const int workingWidth = width + 1 - cascade.windowWidth;
+    const int workingHeight = height + 1 - cascade.windowHeight;
+    int mismatches = 0;
+    std::vector<int> outcomes(8, 0);
+    for (int y = 0; y < workingHeight; ++y) {
+      for (int x = 0; x < workingWidth; x += stride * LbpVectorEvaluator::kLanes) {
+        int results[LbpVectorEvaluator::kLanes];
+        evaluator.evaluate(&sum[y * step + x], stride, results);
+        for (int lane = 0; lane < LbpVectorEvaluator::kLanes && x + lane * stride < workingWidth; ++lane) {
+          const int expected = evaluateLbpCascade(cascade, offsets, &sum[y * step + x + lane * stride]);
+          mismatches += results[lane] != expected;
+          ++outcomes[expected > 0 ? 0 : 1 - expected];
+        }
+      }
+    }
+
+    CHECK(mismatches == 0);
+    // Some windows were accepted, and others rejected at several different stages
+    int kinds = 0;
+    for (int outcome : outcomes) {
+      kinds += outcome > 0;
+    }
+    CHECK(outcomes[0] > 0 && kinds >= 4);
+  }
+}
+
+int main() {
+  testMatchesScalar(1);
+  testMatchesScalar(2);
+
+  return checkResult();
+}
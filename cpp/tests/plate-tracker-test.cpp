@@ -0,0 +1,188 @@
+// Association, voting and convergence of the cross-frame plate tracker.
+//
+//   cmake -S cpp/tests -B build/tests && cmake --build build/tests && ctest --test-dir build/tests
+
+#include "plate-tracker.h"
+#include "check.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace visioncamerapluginanpr;
+
+// Stands in for the OpenALPR implementation, which is not built for the host
+namespace alpr {
+  int levenshteinDistance(const std::string& s1, const std::string& s2, int max) {
+    std::vector<int> previous(s2.size() + 1), current(s2.size() + 1);
+    for (size_t j = 0; j <= s2.size(); ++j) {
+      previous[j] = static_cast<int>(j);
+    }
+
+    for (size_t i = 1; i <= s1.size(); ++i) {
+      current[0] = static_cast<int>(i);
+      for (size_t j = 1; j <= s2.size(); ++j) {
+        int substitution = previous[j - 1] + (s1[i - 1] == s2[j - 1] ? 0 : 1);
+        current[j] = std::min({ previous[j] + 1, current[j - 1] + 1, substitution });
+      }
+      std::swap(previous, current);
+    }
+
+    return std::min(previous[s2.size()], max + 1);
+  }
+}
+
+namespace {
+  alpr::AlprPlate makeCandidate(const std::string& characters, float confidence) {
+    alpr::AlprPlate plate;
+    plate.characters = characters;
+    plate.overall_confidence = confidence;
+    plate.matches_template = false;
+    return plate;
+  }
+
+  alpr::AlprPlateResult makePlate(int x, int y, std::vector<alpr::AlprPlate> candidates) {
+    alpr::AlprPlateResult plate;
+    plate.requested_topn = 10;
+    plate.country = "eu";
+    plate.regionConfidence = 0;
+    plate.plate_index = 0;
+    plate.processing_time_ms = 10;
+    plate.plate_points[0] = { x, y };
+    plate.plate_points[1] = { x + 100, y };
+    plate.plate_points[2] = { x + 100, y + 25 };
+    plate.plate_points[3] = { x, y + 25 };
+    plate.topNPlates = candidates;
+    plate.bestPlate = candidates.front();
+    return plate;
+  }
+
+  alpr::AlprResults makeFrame(std::vector<alpr::AlprPlateResult> plates) {
+    alpr::AlprResults results;
+    results.epoch_time = 0;
+    results.img_width = 1280;
+    results.img_height = 720;
+    results.total_processing_time_ms = 20;
+    results.plates = plates;
+    return results;
+  }
+
+  void testVotesAcrossFrames() {
+    PlateTracker tracker;
+
+    // The true reading is second in one frame but present in all of them
+    alpr::AlprResults consolidated;
+    consolidated = tracker.update(makeFrame({ makePlate(100, 500, { makeCandidate("AB12CDE", 80), makeCandidate("AB12CD", 70) }) }), 0);
+    consolidated = tracker.update(makeFrame({ makePlate(104, 498, { makeCandidate("A812CDE", 82), makeCandidate("AB12CDE", 81) }) }), 100);
+    consolidated = tracker.update(makeFrame({ makePlate(108, 497, { makeCandidate("AB12CDE", 84) }) }), 200);
+
+    CHECK(consolidated.plates.size() == 1);
+    CHECK(consolidated.plates[0].bestPlate.characters == "AB12CDE");
+    CHECK(consolidated.plates[0].bestPlate.overall_confidence == (80.0f + 81.0f + 84.0f) / 3);
+    CHECK(consolidated.plates[0].plate_points[0].x == 108);
+
+    std::vector<PlateTrack> tracks = tracker.activeTracks(200);
+    CHECK(tracks.size() == 1);
+    CHECK(tracks[0].observations == 3);
+    CHECK(!tracks[0].converged);
+    CHECK(tracker.stats().tracksStarted == 1);
+  }
+
+  void testSeparateVehicles() {
+    PlateTracker tracker;
+
+    alpr::AlprResults consolidated = tracker.update(makeFrame({
+      makePlate(100, 500, { makeCandidate("AB12CDE", 85) }),
+      makePlate(900, 300, { makeCandidate("XY99ZZZ", 88) })
+    }), 0);
+    CHECK(consolidated.plates.size() == 2);
+
+    consolidated = tracker.update(makeFrame({
+      makePlate(905, 302, { makeCandidate("XY99ZZZ", 86) }),
+      makePlate(102, 501, { makeCandidate("AB12CDE", 84) })
+    }), 100);
+
+    CHECK(tracker.stats().tracksStarted == 2);
+    CHECK(consolidated.plates.size() == 2);
+    CHECK(consolidated.plates[0].bestPlate.characters == "XY99ZZZ");
+    CHECK(consolidated.plates[1].bestPlate.characters == "AB12CDE");
+  }
+
+  void testReadingMatchesMovedPlate() {
+    PlateTracker tracker;
+
+    tracker.update(makeFrame({ makePlate(100, 500, { makeCandidate("AB12CDE", 85) }) }), 0);
+    // No overlap, but one character off from the track's reading
+    tracker.update(makeFrame({ makePlate(600, 200, { makeCandidate("AB12CD3", 80) }) }), 100);
+    CHECK(tracker.stats().tracksStarted == 1);
+
+    // Neither overlapping nor a similar reading
+    tracker.update(makeFrame({ makePlate(100, 100, { makeCandidate("QQ77RRR", 80) }) }), 200);
+    CHECK(tracker.stats().tracksStarted == 2);
+  }
+
+  void testConvergenceStopsReads() {
+    PlateTracker tracker;
+    PlateTrackerConfig config;
+    config.convergedConfidence = 85;
+    config.minObservations = 3;
+    tracker.configure(config);
+
+    for (int i = 0; i < 3; ++i) {
+      tracker.update(makeFrame({ makePlate(100 + i, 500, { makeCandidate("AB12CDE", 90) }) }), i * 100.0);
+    }
+
+    std::vector<PlateTrack> completed = tracker.takeCompletedTracks(200);
+    CHECK(completed.size() == 1);
+    CHECK(completed[0].converged);
+    CHECK(completed[0].consensus.bestPlate.characters == "AB12CDE");
+
+    // The converged plate's region is not read again, but stays in the frame's results
+    CHECK(tracker.coveredByConvergedTrack(cv::Rect(104, 501, 100, 25), 300));
+    CHECK(!tracker.coveredByConvergedTrack(cv::Rect(700, 100, 100, 25), 300));
+    alpr::AlprResults consolidated = tracker.update(makeFrame({}), 300);
+    CHECK(consolidated.plates.size() == 1);
+    CHECK(tracker.stats().readsSkipped == 1);
+
+    // Reported once only
+    CHECK(tracker.takeCompletedTracks(300).empty());
+  }
+
+  void testTimeoutCompletesTrack() {
+    PlateTracker tracker;
+    tracker.update(makeFrame({ makePlate(100, 500, { makeCandidate("AB12CDE", 60) }) }), 0);
+
+    CHECK(tracker.takeCompletedTracks(1000).empty());
+
+    std::vector<PlateTrack> completed = tracker.takeCompletedTracks(2000);
+    CHECK(completed.size() == 1);
+    CHECK(!completed[0].converged);
+    CHECK(tracker.activeTracks(2000).empty());
+  }
+
+  void testCompletedTracksAreCapped() {
+    PlateTracker tracker;
+    const size_t extra = 5;
+
+    // Separate vehicles, each timing out long before the next arrives
+    for (size_t i = 0; i < PlateTracker::kMaxCompletedTracks + extra; ++i) {
+      tracker.update(makeFrame({ makePlate(100, 500, { makeCandidate("AB12CDE", 60) }) }), i * 2000.0);
+    }
+
+    std::vector<PlateTrack> completed = tracker.takeCompletedTracks((PlateTracker::kMaxCompletedTracks + extra) * 2000.0);
+    CHECK(completed.size() == PlateTracker::kMaxCompletedTracks);
+    CHECK(tracker.stats().completedDropped == extra);
+    // The oldest are the ones dropped
+    CHECK(completed.front().id == extra + 1);
+  }
+}
+
+int main() {
+  testVotesAcrossFrames();
+  testSeparateVehicles();
+  testReadingMatchesMovedPlate();
+  testConvergenceStopsReads();
+  testTimeoutCompletesTrack();
+  testCompletedTracksAreCapped();
+
+  return checkResult();
+}
@@ -0,0 +1,280 @@
+// Round-trip test for the binary AlprResults encoding.
+//
+//   cmake -S cpp/tests -B build/tests && cmake --build build/tests && ctest --test-dir build/tests
+
+#include "result-encoding.h"
+#include "check.h"
+
+#include <algorithm>
+#include <vector>
+
+#ifdef ANPR_TEST_WITH_OPENALPR
+  #include "alpr.h"
+#endif
+
+using namespace visioncamerapluginanpr;
+
+namespace {
+  void setCorners(alpr::AlprCoordinate (&corners)[4], int x, int y, int width, int height) {
+    corners[0] = { x, y };
+    corners[1] = { x + width, y };
+    corners[2] = { x + width, y + height };
+    corners[3] = { x, y + height };
+  }
+
+  alpr::AlprPlate makePlate(const std::string& characters, float confidence, bool matchesTemplate) {
+    alpr::AlprPlate plate;
+    plate.characters = characters;
+    plate.overall_confidence = confidence;
+    plate.matches_template = matchesTemplate;
+
+    for (size_t i = 0; i < characters.size(); ++i) {
+      alpr::AlprChar character;
+      setCorners(character.corners, 100 + static_cast<int>(i) * 12, 200, 10, 20);
+      character.confidence = confidence - static_cast<float>(i) * 0.5f;
+      character.character = characters.substr(i, 1);
+      plate.character_details.push_back(character);
+    }
+
+    return plate;
+  }
+
+  alpr::AlprResults makeResults() {
+    alpr::AlprResults results;
+    results.epoch_time = 1718000000123;
+    results.frame_number = 42;
+    results.img_width = 1920;
+    results.img_height = 1080;
+    results.total_processing_time_ms = 87.25f;
+    results.regionsOfInterest.emplace_back(0, 0, 1920, 1080);
+    results.regionsOfInterest.emplace_back(640, 360, 320, 180);
+
+    alpr::AlprPlateResult first;
+    first.requested_topn = 3;
+    first.country = "eu";
+    first.region = "Île-de-France";
+    first.regionConfidence = 71;
+    first.plate_index = 0;
+    first.processing_time_ms = 31.5f;
+    setCorners(first.plate_points, 96, 196, 120, 30);
+    first.topNPlates.push_back(makePlate("AB123CD", 91.75f, true));
+    first.topNPlates.push_back(makePlate("AB123C0", 84.5f, false));
+    first.topNPlates.push_back(makePlate("A8123CD", 80.25f, false));
+    first.bestPlate = first.topNPlates[0];
+    results.plates.push_back(first);
+
+    // A best plate that is not one of the candidates is stored on its own
+    alpr::AlprPlateResult second;
+    second.requested_topn = 3;
+    second.country = "eu";
+    second.region = "";
+    second.regionConfidence = 0;
+    second.plate_index = 1;
+    second.processing_time_ms = 12.0f;
+    setCorners(second.plate_points, 1500, 900, 110, 28);
+    second.bestPlate = makePlate("XY99ZZ", 77.0f, false);
+    results.plates.push_back(second);
+
+    return results;
+  }
+
+  void checkSameCorners(const alpr::AlprCoordinate (&a)[4], const alpr::AlprCoordinate (&b)[4]) {
+    for (int i = 0; i < 4; ++i) {
+      CHECK(a[i].x == b[i].x);
+      CHECK(a[i].y == b[i].y);
+    }
+  }
+
+  void checkSamePlate(const alpr::AlprPlate& a, const alpr::AlprPlate& b) {
+    CHECK(a.characters == b.characters);
+    CHECK(a.overall_confidence == b.overall_confidence);
+    CHECK(a.matches_template == b.matches_template);
+    CHECK(a.character_details.size() == b.character_details.size());
+
+    for (size_t i = 0; i < a.character_details.size() && i < b.character_details.size(); ++i) {
+      CHECK(a.character_details[i].character == b.character_details[i].character);
+      CHECK(a.character_details[i].confidence == b.character_details[i].confidence);
+      checkSameCorners(a.character_details[i].corners, b.character_details[i].corners);
+    }
+  }
+
+  void checkSameResults(const alpr::AlprResults& a, const alpr::AlprResults& b) {
+    CHECK(a.epoch_time == b.epoch_time);
+    CHECK(a.frame_number == b.frame_number);
+    CHECK(a.img_width == b.img_width);
+    CHECK(a.img_height == b.img_height);
+    CHECK(a.total_processing_time_ms == b.total_processing_time_ms);
+
+    CHECK(a.regionsOfInterest.size() == b.regionsOfInterest.size());
+    for (size_t i = 0; i < a.regionsOfInterest.size() && i < b.regionsOfInterest.size(); ++i) {
+      CHECK(a.regionsOfInterest[i].x == b.regionsOfInterest[i].x);
+      CHECK(a.regionsOfInterest[i].y == b.regionsOfInterest[i].y);
+      CHECK(a.regionsOfInterest[i].width == b.regionsOfInterest[i].width);
+      CHECK(a.regionsOfInterest[i].height == b.regionsOfInterest[i].height);
+    }
+
+    CHECK(a.plates.size() == b.plates.size());
+    for (size_t i = 0; i < a.plates.size() && i < b.plates.size(); ++i) {
+      const alpr::AlprPlateResult& plateA = a.plates[i];
+      const alpr::AlprPlateResult& plateB = b.plates[i];
+
+      CHECK(plateA.requested_topn == plateB.requested_topn);
+      CHECK(plateA.country == plateB.country);
+      CHECK(plateA.region == plateB.region);
+      CHECK(plateA.regionConfidence == plateB.regionConfidence);
+      CHECK(plateA.plate_index == plateB.plate_index);
+      CHECK(plateA.processing_time_ms == plateB.processing_time_ms);
+      checkSameCorners(plateA.plate_points, plateB.plate_points);
+      checkSamePlate(plateA.bestPlate, plateB.bestPlate);
+
+      CHECK(plateA.topNPlates.size() == plateB.topNPlates.size());
+      for (size_t j = 0; j < plateA.topNPlates.size() && j < plateB.topNPlates.size(); ++j) {
+        checkSamePlate(plateA.topNPlates[j], plateB.topNPlates[j]);
+      }
+    }
+  }
+
+#ifdef ANPR_TEST_WITH_OPENALPR
+  // Only the fields Alpr::toJson writes and Alpr::fromJson reads back; frame_number, country and character
+  // details do not survive the JSON round trip
+  void checkSameJsonFields(const alpr::AlprResults& a, const alpr::AlprResults& b) {
+    CHECK(a.epoch_time == b.epoch_time);
+    CHECK(a.img_width == b.img_width);
+    CHECK(a.img_height == b.img_height);
+    CHECK(a.total_processing_time_ms == b.total_processing_time_ms);
+
+    CHECK(a.regionsOfInterest.size() == b.regionsOfInterest.size());
+    for (size_t i = 0; i < a.regionsOfInterest.size() && i < b.regionsOfInterest.size(); ++i) {
+      CHECK(a.regionsOfInterest[i].x == b.regionsOfInterest[i].x);
+      CHECK(a.regionsOfInterest[i].y == b.regionsOfInterest[i].y);
+      CHECK(a.regionsOfInterest[i].width == b.regionsOfInterest[i].width);
+      CHECK(a.regionsOfInterest[i].height == b.regionsOfInterest[i].height);
+    }
+
+    auto checkSameCandidate = [](const alpr::AlprPlate& plateA, const alpr::AlprPlate& plateB) {
+      CHECK(plateA.characters == plateB.characters);
+      CHECK(plateA.overall_confidence == plateB.overall_confidence);
+      CHECK(plateA.matches_template == plateB.matches_template);
+    };
+
+    CHECK(a.plates.size() == b.plates.size());
+    for (size_t i = 0; i < a.plates.size() && i < b.plates.size(); ++i) {
+      const alpr::AlprPlateResult& plateA = a.plates[i];
+      const alpr::AlprPlateResult& plateB = b.plates[i];
+
+      CHECK(plateA.requested_topn == plateB.requested_topn);
+      CHECK(plateA.region == plateB.region);
+      CHECK(plateA.regionConfidence == plateB.regionConfidence);
+      CHECK(plateA.plate_index == plateB.plate_index);
+      CHECK(plateA.processing_time_ms == plateB.processing_time_ms);
+      checkSameCorners(plateA.plate_points, plateB.plate_points);
+      checkSameCandidate(plateA.bestPlate, plateB.bestPlate);
+
+      CHECK(plateA.topNPlates.size() == plateB.topNPlates.size());
+      for (size_t j = 0; j < plateA.topNPlates.size() && j < plateB.topNPlates.size(); ++j) {
+        checkSameCandidate(plateA.topNPlates[j], plateB.topNPlates[j]);
+      }
+    }
+  }
+#endif
+
+  std::vector<uint8_t> encode(const alpr::AlprResults& results) {
+    ResultEncoder encoder;
+    std::vector<uint8_t> buffer(encoder.prepare(results));
+    encoder.write(buffer.data());
+    return buffer;
+  }
+
+  void testRoundTrip() {
+    alpr::AlprResults results = makeResults();
+    std::vector<uint8_t> buffer = encode(results);
+
+    checkSameResults(decodeResults(buffer.data(), buffer.size()), results);
+
+#ifdef ANPR_TEST_WITH_OPENALPR
+    // The binary encoding must carry everything the JSON encoding does
+    alpr::AlprResults fromJson = alpr::Alpr::fromJson(alpr::Alpr::toJson(results));
+    checkSameJsonFields(decodeResults(buffer.data(), buffer.size()), fromJson);
+#endif
+  }
+
+  void testEmptyResults() {
+    alpr::AlprResults results;
+    results.epoch_time = 0;
+    results.img_width = 640;
+    results.img_height = 480;
+    results.total_processing_time_ms = 1.5f;
+
+    std::vector<uint8_t> buffer = encode(results);
+    CHECK(buffer.size() == ResultEncoder::kHeaderSize);
+    checkSameResults(decodeResults(buffer.data(), buffer.size()), results);
+  }
+
+  void testStringsAreShared() {
+    alpr::AlprResults results = makeResults();
+    std::vector<uint8_t> buffer = encode(results);
+
+    // Both plates share the country, and repeated characters share one entry
+    std::string country = "eu";
+    size_t occurrences = 0;
+    for (size_t i = 0; i + country.size() <= buffer.size(); ++i) {
+      if (std::equal(country.begin(), country.end(), buffer.begin() + i)) {
+        ++occurrences;
+      }
+    }
+    CHECK(occurrences == 1);
+  }
+
+  void testCoordinatesSaturate() {
+    alpr::AlprResults results = makeResults();
+    setCorners(results.plates[0].plate_points, -40000, 0, 80000, 10);
+
+    std::vector<uint8_t> buffer = encode(results);
+    alpr::AlprResults decoded = decodeResults(buffer.data(), buffer.size());
+    CHECK(decoded.plates[0].plate_points[0].x == -32768);
+    CHECK(decoded.plates[0].plate_points[1].x == 32767);
+  }
+
+  void testMalformedInput() {
+    std::vector<uint8_t> buffer = encode(makeResults());
+
+    bool threw = false;
+    try {
+      decodeResults(buffer.data(), buffer.size() - 1);
+    } catch (const std::invalid_argument&) {
+      threw = true;
+    }
+    CHECK(threw);
+
+    // A header shorter than the fixed fields would put the regions on top of them
+    threw = false;
+    std::vector<uint8_t> shortHeader = buffer;
+    shortHeader[6] = 8;
+    shortHeader[7] = 0;
+    try {
+      decodeResults(shortHeader.data(), shortHeader.size());
+    } catch (const std::invalid_argument&) {
+      threw = true;
+    }
+    CHECK(threw);
+
+    threw = false;
+    buffer[0] ^= 0xFF;
+    try {
+      decodeResults(buffer.data(), buffer.size());
+    } catch (const std::invalid_argument&) {
+      threw = true;
+    }
+    CHECK(threw);
+  }
+}
+
+int main() {
+  testRoundTrip();
+  testEmptyResults();
+  testStringsAreShared();
+  testCoordinatesSaturate();
+  testMalformedInput();
+
+  return checkResult();
+}
@@ -0,0 +1,168 @@
+// Reading, validating and extracting packed runtime data bundles.
+//
+//   cmake -S cpp/tests -B build/tests && cmake --build build/tests && ctest --test-dir build/tests
+
+#include "runtime-bundle.h"
+#include "check.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace visioncamerapluginanpr;
+
+namespace {
+  using Files = std::vector<std::pair<std::string, std::string>>;
+
+  void appendLittleEndian(std::string& bytes, uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+      bytes.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+  }
+
+  // Lays files out the way packRuntimeBundle in android/build.gradle does
+  std::string packBundle(const Files& files, uint64_t version, uint32_t format = RuntimeBundle::kFormatVersion) {
+    std::string index;
+    size_t indexSize = 0;
+    for (const auto& file : files) {
+      indexSize += 18 + file.first.size();
+    }
+
+    size_t offset = RuntimeBundle::kHeaderSize + indexSize;
+    std::vector<size_t> offsets;
+    for (const auto& file : files) {
+      offset = (offset + RuntimeBundle::kAlignment - 1) / RuntimeBundle::kAlignment * RuntimeBundle::kAlignment;
+      offsets.push_back(offset);
+      appendLittleEndian(index, offset, 8);
+      appendLittleEndian(index, file.second.size(), 8);
+      appendLittleEndian(index, file.first.size(), 2);
+      index += file.first;
+      offset += file.second.size();
+    }
+
+    std::string bundle = "ANPRBNDL";
+    appendLittleEndian(bundle, format, 4);
+    appendLittleEndian(bundle, files.size(), 4);
+    appendLittleEndian(bundle, version, 8);
+    appendLittleEndian(bundle, index.size(), 8);
+    bundle += index;
+    for (size_t i = 0; i < files.size(); ++i) {
+      bundle.resize(offsets[i], '\0');
+      bundle += files[i].second;
+    }
+    return bundle;
+  }
+
+  std::string writeFile(const std::string& path, const std::string& contents) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << contents;
+    return path;
+  }
+
+  std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  }
+
+  bool rejects(const std::string& path) {
+    try {
+      RuntimeBundle bundle(path);
+      return false;
+    } catch (const std::runtime_error&) {
+      return true;
+    }
+  }
+
+  const Files kFiles = {
+    { "openalpr.conf", "[common]\nmax_detection_input_width = 1280\n" },
+    { "runtime_data/config/us.conf", "detector_file = us.xml\n" },
+    { "runtime_data/region/us.xml", std::string(5000, 'x') },
+    { "runtime_data/empty", "" }
+  };
+
+  void testRead(const std::string& directory) {
+    RuntimeBundle bundle(writeFile(directory + "/read.bundle", packBundle(kFiles, 0x0123456789abcdefULL)));
+
+    CHECK(bundle.version() == 0x0123456789abcdefULL);
+    CHECK(bundle.entries().size() == kFiles.size());
+
+    const RuntimeBundleEntry* cascade = bundle.find("runtime_data/region/us.xml");
+    CHECK(cascade && cascade->size == 5000);
+    CHECK(cascade && std::string(reinterpret_cast<const char*>(cascade->data), cascade->size) == kFiles[2].second);
+    CHECK(bundle.find("runtime_data/region/eu.xml") == nullptr);
+
+    // The mapping starts on a page, so entries do too
+    for (const RuntimeBundleEntry& entry : bundle.entries()) {
+      CHECK(reinterpret_cast<uintptr_t>(entry.data) % RuntimeBundle::kAlignment == 0);
+    }
+  }
+
+  void testExtract(const std::string& directory) {
+    const std::string target = directory + "/extracted/openalpr";
+    {
+      RuntimeBundle bundle(writeFile(directory + "/v1.bundle", packBundle(kFiles, 1)));
+      CHECK(bundle.extractTo(target));
+      CHECK(readFile(target + "/openalpr.conf") == kFiles[0].second);
+      CHECK(readFile(target + "/runtime_data/region/us.xml") == kFiles[2].second);
+      CHECK(readFile(target + "/runtime_data/empty").empty());
+
+      // The same version is not written again
+      writeFile(target + "/openalpr.conf", "edited");
+      CHECK(!bundle.extractTo(target));
+      CHECK(readFile(target + "/openalpr.conf") == "edited");
+    }
+
+    Files changed = kFiles;
+    changed[0].second = "[common]\n";
+    changed.pop_back();
+    RuntimeBundle bundle(writeFile(directory + "/v2.bundle", packBundle(changed, 2)));
+    CHECK(bundle.extractTo(target));
+    CHECK(readFile(target + "/openalpr.conf") == "[common]\n");
+    // A file the new version no longer has is removed
+    CHECK(access((target + "/runtime_data/empty").c_str(), F_OK) != 0);
+    CHECK(readFile(target + "/runtime_data/region/us.xml") == kFiles[2].second);
+  }
+
+  void testInvalid(const std::string& directory) {
+    CHECK(rejects(directory + "/missing.bundle"));
+    CHECK(rejects(writeFile(directory + "/short.bundle", "ANPRBNDL")));
+
+    std::string wrongMagic = packBundle(kFiles, 1);
+    wrongMagic[0] = 'X';
+    CHECK(rejects(writeFile(directory + "/magic.bundle", wrongMagic)));
+
+    CHECK(rejects(writeFile(directory + "/format.bundle", packBundle(kFiles, 1, RuntimeBundle::kFormatVersion + 1))));
+
+    std::string truncated = packBundle(kFiles, 1);
+    truncated.resize(truncated.size() - 100);
+    CHECK(rejects(writeFile(directory + "/truncated.bundle", truncated)));
+
+    CHECK(rejects(writeFile(directory + "/escape.bundle", packBundle({ { "../outside", "x" } }, 1))));
+    CHECK(rejects(writeFile(directory + "/absolute.bundle", packBundle({ { "/etc/outside", "x" } }, 1))));
+  }
+}
+
+int main() {
+  char pattern[] = "/tmp/runtime-bundle-test-XXXXXX";
+  const char* directory = mkdtemp(pattern);
+  if (!directory) {
+    std::printf("Unable to create a temporary directory\n");
+    return 1;
+  }
+
+  testRead(directory);
+  testExtract(directory);
+  testInvalid(directory);
+
+  std::system((std::string("rm -rf ") + directory).c_str());
+
+  return checkResult();
+}
@@ -0,0 +1,98 @@
+// Latency buckets, percentiles and runtime counters updated concurrently.
+//
+//   cmake -S cpp/tests -B build/tests && cmake --build build/tests && ctest --test-dir build/tests
+
+#include "runtime-stats.h"
+#include "check.h"
+
+#include <thread>
+#include <vector>
+
+using namespace visioncamerapluginanpr;
+
+namespace {
+  void testBuckets() {
+    LatencyHistogram histogram;
+    histogram.record(0);
+    histogram.record(5);
+    histogram.record(5.5);
+    histogram.record(2000);
+    histogram.record(60000);
+
+    LatencyHistogram::Counts counts = histogram.counts();
+    CHECK(counts[0] == 2);
+    CHECK(counts[1] == 1);
+    CHECK(counts[LatencyHistogram::kBucketCount - 2] == 1);
+    CHECK(counts[LatencyHistogram::kBucketCount - 1] == 1);
+
+    histogram.reset();
+    counts = histogram.counts();
+    for (uint64_t count : counts) {
+      CHECK(count == 0);
+    }
+  }
+
+  void testPercentile() {
+    LatencyHistogram::Counts counts{};
+    CHECK(LatencyHistogram::percentile(counts, 0.5) == 0);
+
+    // 90 samples up to 20ms, 9 up to 100ms and one slower than every bound
+    counts[2] = 90;
+    counts[6] = 9;
+    counts[LatencyHistogram::kBucketCount - 1] = 1;
+    CHECK(LatencyHistogram::percentile(counts, 0.5) == 20);
+    CHECK(LatencyHistogram::percentile(counts, 0.9) == 20);
+    CHECK(LatencyHistogram::percentile(counts, 0.95) == 100);
+    CHECK(LatencyHistogram::percentile(counts, 1.0) == 2000);
+  }
+
+  void testConcurrentUpdates() {
+    RuntimeStats stats;
+    const int kThreads = 4;
+    const int kFrames = 10000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&stats]() {
+        for (int i = 0; i < kFrames; ++i) {
+          stats.recordFrameReceived();
+          if (i % 2 == 0) {
+            stats.recordFrameDropped();
+          } else {
+            stats.recordCandidates(3, 2);
+            stats.recordFrameProcessed(12, 1);
+          }
+        }
+        stats.recordImageProcessed(300, 2);
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    RuntimeStatsSnapshot snapshot = stats.snapshot();
+    CHECK(snapshot.framesReceived == kThreads * kFrames);
+    CHECK(snapshot.framesDropped == kThreads * kFrames / 2);
+    CHECK(snapshot.framesProcessed == kThreads * kFrames / 2);
+    CHECK(snapshot.imagesProcessed == kThreads);
+    CHECK(snapshot.platesFound == kThreads * kFrames / 2 + kThreads * 2);
+    CHECK(snapshot.ocrCalls == kThreads * kFrames);
+    CHECK(snapshot.averageCandidatesPerFrame == 3.0);
+    CHECK(snapshot.frameLatency[2] == kThreads * kFrames / 2);
+    CHECK(snapshot.imageLatency[9] == kThreads);
+
+    stats.reset();
+    snapshot = stats.snapshot();
+    CHECK(snapshot.framesReceived == 0 && snapshot.framesProcessed == 0 && snapshot.ocrCalls == 0);
+    CHECK(snapshot.averageCandidatesPerFrame == 0);
+    CHECK(LatencyHistogram::percentile(snapshot.frameLatency, 0.5) == 0);
+  }
+}
+
+int main() {
+  testBuckets();
+  testPercentile();
+  testConcurrentUpdates();
+
+  return checkResult();
+}
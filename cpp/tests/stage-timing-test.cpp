@@ -0,0 +1,137 @@
+// Parsing of OpenALPR's debugTiming output, capturing it per thread, and the timing breakdown built from it.
+//
+//   cmake -S cpp/tests -B build/tests && cmake --build build/tests && ctest --test-dir build/tests
+
+#include "stage-timing.h"
+#include "check.h"
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace visioncamerapluginanpr;
+
+namespace {
+  const StageTiming* findStage(const std::vector<StageTiming>& timings, const std::string& stage) {
+    for (const StageTiming& timing : timings) {
+      if (timing.stage == stage) {
+        return &timing;
+      }
+    }
+    return nullptr;
+  }
+
+  void testParse() {
+    std::vector<StageTiming> timings = parseStageTimings(
+      "LBP Time: 41.5ms.\n"
+      "  -- Character Analysis Time: 2.25ms.\n"
+      "Plate Lines Time: 1ms.\n"
+      "  -- Character Analysis Time: 1.75ms.\n"
+      "Character Segmenter Time: 3ms.\n"
+      "OCR Time: 12ms.\n"
+      "PostProcess Time: 0.5ms.\n"
+      "Total Time to process image: 70ms.\n"
+      "Some Future Stage Time: 4ms.\n"
+      " Time: 9ms.\n"
+      "Broken Time: n/a\n");
+
+    CHECK(timings.size() == 7);
+    CHECK(timings[0].stage == "detection" && timings[0].ms == 41.5 && timings[0].runs == 1);
+    CHECK(timings[1].stage == "characterAnalysis" && timings[1].ms == 4.0 && timings[1].runs == 2);
+    CHECK(findStage(timings, "plateLines") != nullptr);
+    CHECK(findStage(timings, "segmentation") && findStage(timings, "segmentation")->ms == 3.0);
+    CHECK(findStage(timings, "ocr") && findStage(timings, "ocr")->ms == 12.0);
+    CHECK(findStage(timings, "postProcess") != nullptr);
+    CHECK(findStage(timings, "someFutureStage") != nullptr);
+    CHECK(findStage(timings, "broken") == nullptr);
+  }
+
+  void testStageKey() {
+    CHECK(stageKey("Plate Corners") == "plateCorners");
+    CHECK(stageKey("LBP") == "detection");
+    CHECK(stageKey("Prewarp") == "prewarp");
+    CHECK(stageKey("Region  Validation") == "regionValidation");
+  }
+
+  void testCandidatesAndJson() {
+    RecognitionTimings timings;
+    timings.totalMs = 25;
+    addStageTiming(timings.stages, "detection", 10);
+
+    CandidateTiming read;
+    read.region = cv::Rect(10, 20, 100, 30);
+    read.plateIndex = 0;
+    read.stages = parseStageTimings("  -- Produce Threshold Time: 1ms.\n  -- Produce Threshold Time: 1ms.\nOCR Time: 5ms.\n");
+    addCandidateTiming(timings, read);
+
+    CandidateTiming rejected;
+    rejected.region = cv::Rect(300, 40, 80, 20);
+    rejected.stages = parseStageTimings("  -- Character Analysis Time: 2ms.\n");
+    addCandidateTiming(timings, rejected);
+
+    offsetTimings(timings, cv::Point(5, 7));
+
+    CHECK(timings.candidatesRejected == 1);
+    CHECK(timings.thresholdPasses == 2);
+    CHECK(timings.candidates[1].region == cv::Rect(305, 47, 80, 20));
+    CHECK(timingsToJson(timings) ==
+      "{\"totalMs\":25.000,\"stages\":{\"detection\":{\"ms\":10.000,\"runs\":1}},\"candidates\":["
+      "{\"region\":{\"x\":15,\"y\":27,\"width\":100,\"height\":30},\"plateIndex\":0,\"stages\":"
+      "{\"thresholds\":{\"ms\":2.000,\"runs\":2},\"ocr\":{\"ms\":5.000,\"runs\":1}}},"
+      "{\"region\":{\"x\":305,\"y\":47,\"width\":80,\"height\":20},\"plateIndex\":-1,\"stages\":"
+      "{\"characterAnalysis\":{\"ms\":2.000,\"runs\":1}}}],\"candidatesRejected\":1,\"thresholdPasses\":2}");
+  }
+
+  void testCapturePerThread() {
+    std::vector<StageTiming> first, second, nested;
+
+    std::thread a([&first]() {
+      StageTimingCapture capture;
+      for (int i = 0; i < 200; ++i) {
+        std::cout << "OCR Time: " << 1 << "ms." << std::endl;
+      }
+      first = capture.timings();
+    });
+
+    std::thread b([&second, &nested]() {
+      StageTimingCapture capture;
+      for (int i = 0; i < 100; ++i) {
+        std::cout << "Plate Lines Time: " << 0.5 << "ms." << std::endl;
+      }
+      {
+        StageTimingCapture inner;
+        std::cout << "OCR Time: 7ms." << std::endl;
+        nested = inner.timings();
+      }
+      second = capture.timings();
+    });
+
+    a.join();
+    b.join();
+
+    CHECK(first.size() == 1 && first[0].stage == "ocr" && first[0].runs == 200 && first[0].ms == 200.0);
+    CHECK(second.size() == 1 && second[0].stage == "plateLines" && second[0].runs == 100 && second[0].ms == 50.0);
+    CHECK(nested.size() == 1 && nested[0].ms == 7.0);
+  }
+
+  void testCaptureRestoresStreamBuffer() {
+    std::streambuf* original = std::cout.rdbuf();
+    {
+      StageTimingCapture capture;
+      CHECK(std::cout.rdbuf() != original);
+    }
+    // std::cout is left as it was once no capture is alive
+    CHECK(std::cout.rdbuf() == original);
+  }
+}
+
+int main() {
+  testParse();
+  testStageKey();
+  testCandidatesAndJson();
+  testCapturePerThread();
+  testCaptureRestoresStreamBuffer();
+
+  return checkResult();
+}
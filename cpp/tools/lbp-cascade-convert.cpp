@@ -0,0 +1,64 @@
+// Packs LBP cascade XMLs into the binary form read by loadSharedLbpCascade, writing each next to its XML.
+//
+//   cmake -S cpp -B build/host -DANPR_HOST_PREFIX=/opt/anpr-host && cmake --build build/host --target lbp-cascade-convert
+//   ./build/host/tools/lbp-cascade-convert android/src/main/assets/openalpr/runtime_data/region/*.xml
+//
+// Each packed file is read back and compared with the XML before the next one is converted. The plugin writes the
+// same file itself the first time it reads a cascade, and ignores one that is older than its XML, so this is only
+// needed to pack cascades ahead of time.
+
+#include "cascade-detector.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace visioncamerapluginanpr;
+
+namespace {
+  bool convert(const std::string& xmlPath) {
+    const std::vector<uint8_t> packed = serializeLbpCascade(readLbpCascadeXml(xmlPath));
+    const std::string packedPath = packedCascadePath(xmlPath);
+    {
+      std::ofstream file(packedPath, std::ios::binary | std::ios::trunc);
+      file.write(reinterpret_cast<const char*>(packed.data()), static_cast<std::streamsize>(packed.size()));
+      if (!file) {
+        std::fprintf(stderr, "Unable to write %s\n", packedPath.c_str());
+        return false;
+      }
+    }
+
+    std::ifstream file(packedPath, std::ios::binary);
+    const std::vector<uint8_t> written((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (serializeLbpCascade(parseLbpCascade(written.data(), written.size())) != packed) {
+      std::fprintf(stderr, "%s does not read back as %s\n", packedPath.c_str(), xmlPath.c_str());
+      return false;
+    }
+
+    std::printf("%s -> %s (%zu bytes)\n", xmlPath.c_str(), packedPath.c_str(), packed.size());
+    return true;
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "Usage: lbp-cascade-convert <cascade.xml>...\n");
+    return 2;
+  }
+
+  int failures = 0;
+  for (int i = 1; i < argc; ++i) {
+    try {
+      if (!convert(argv[i])) {
+        ++failures;
+      }
+    } catch (const std::exception& e) {
+      std::fprintf(stderr, "%s: %s\n", argv[i], e.what());
+      ++failures;
+    }
+  }
+
+  return failures > 0 ? 1 : 0;
+}
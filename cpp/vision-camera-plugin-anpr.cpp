@@ -1,10 +1,16 @@
 #include <jsi/jsi.h>
 #include "vision-camera-plugin-anpr.h"
+#include "recognition-pipeline.h"
+#include "image-decoder.h"
+#include "hardware-buffer-frame-source.h"
+#include "alpr-results-host-object.h"
+#include "result-encoding.h"
+#include "logging.h"
 #include "react-native-vision-camera/FrameHostObject.h"
-#include "alpr.h"
-#include <android/log.h>
+#include <ReactCommon/CallInvoker.h>
+#include "alpr_impl.h"
 #include <memory>
-#include <mutex>
+#include <optional>
 #include <string>
 #include <android/hardware_buffer.h>
 #include <jni.h>
@@ -13,19 +19,16 @@
 #include <vector>
 #include <cerrno>
 #include <cstring>
-
-#define LOG_TAG "ReactNative"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
 
 namespace visioncamerapluginanpr {
   using namespace facebook;
   using namespace vision;
   
-  static std::string g_configPath;
-  static std::string g_runtimePath;
-  static std::unique_ptr<alpr::Alpr> g_openalprInstance = nullptr;
-  static std::mutex g_openalprMutex;
+  static RecognitionPipeline g_pipeline;
+
 
   uint8_t* getPixelData(jsi::Runtime& runtime, const jsi::Value& arg) {
     if (!arg.isObject() || !arg.asObject(runtime).isArrayBuffer(runtime)) {
@@ -38,31 +41,177 @@ namespace visioncamerapluginanpr {
   }
 
   void setAlprPaths(const char* configPath, const char* runtimePath) {
-    g_configPath = configPath;
-    g_runtimePath = runtimePath;
+    g_pipeline.setPaths(configPath, runtimePath);
+  }
+
+  void setRuntimeBundle(const char* bundlePath, const char* directory) {
+    g_pipeline.setRuntimeBundle(bundlePath, directory);
+  }
+
+  enum class ResultFormat {
+    // A JSON string, as produced by alpr::AlprImpl::toJson
+    Json,
+    // An AlprResultsHostObject that is only converted as JS reads it
+    Object,
+    // An ArrayBuffer holding the packed encoding from result-encoding.h
+    Binary
+  };
+
+  struct ResultOptions {
+    ResultFormat format = ResultFormat::Json;
+    // Caller-provided ArrayBuffer that binary results are written into instead of a pooled one
+    std::optional<jsi::ArrayBuffer> buffer;
+    // Attach a per-stage timing breakdown to JSON and object results
+    bool timing = false;
+  };
+
+  // Reads the { output: 'json' | 'object' | 'binary', buffer?: ArrayBuffer, timing?: boolean } options argument at `index`
+  ResultOptions getResultOptions(jsi::Runtime& runtime, const jsi::Value* args, size_t count, size_t index) {
+    ResultOptions options;
+    if (count <= index || !args[index].isObject()) {
+      return options;
+    }
+
+    jsi::Object optionsObject = args[index].asObject(runtime);
+    auto timing = optionsObject.getProperty(runtime, "timing");
+    options.timing = timing.isBool() && timing.getBool();
+
+    auto outputValue = optionsObject.getProperty(runtime, "output");
+    if (!outputValue.isString()) {
+      return options;
+    }
+
+    std::string output = outputValue.getString(runtime).utf8(runtime);
+    if (output == "object") {
+      options.format = ResultFormat::Object;
+    } else if (output == "binary") {
+      options.format = ResultFormat::Binary;
+
+      auto bufferValue = optionsObject.getProperty(runtime, "buffer");
+      if (bufferValue.isObject() && bufferValue.asObject(runtime).isArrayBuffer(runtime)) {
+        options.buffer = bufferValue.asObject(runtime).getArrayBuffer(runtime);
+      }
+    } else if (output != "json") {
+      throw std::invalid_argument("Unknown output format '" + output + "'");
+    }
+
+    return options;
   }
 
-  void initializeOpenALPR(std::string country, int topN, std::string region) {
-    std::lock_guard<std::mutex> lock(g_openalprMutex);
-    if (!g_openalprInstance) {
-      LOGI("Initializing OpenALPR...");
-      g_openalprInstance = std::make_unique<alpr::Alpr>(country, g_configPath, g_runtimePath);
+  // Backs a JS ArrayBuffer with pooled memory, which returns to the pool once JS collects the buffer
+  class PooledMutableBuffer : public jsi::MutableBuffer {
+    public:
+      PooledMutableBuffer(BufferPool::Buffer buffer, size_t length) : buffer(std::move(buffer)), length(length) {}
 
-      if(topN > 0) {
-        g_openalprInstance->setTopN(topN);
+      size_t size() const override {
+        return length;
       }
 
-      if(!region.empty()) {
-        LOGI("Setting region to %s", region.c_str());
-        g_openalprInstance->setDefaultRegion(region);
+      uint8_t* data() override {
+        return buffer.data();
       }
 
-      if (!g_openalprInstance->isLoaded()) {
-        LOGE("Error loading OpenALPR library");
-      } else {
-        LOGI("OpenALPR initialized successfully");
+    private:
+      BufferPool::Buffer buffer;
+      size_t length;
+  };
+
+  // Timings are attached to JSON and object results; the binary encoding has no room for them
+  jsi::Value toJsResult(jsi::Runtime& runtime, alpr::AlprResults results, ResultOptions& options,
+                        std::shared_ptr<const RecognitionTimings> timings = nullptr) {
+    if (options.format == ResultFormat::Object) {
+      return jsi::Object::createFromHostObject(runtime, std::make_shared<AlprResultsHostObject>(std::move(results), std::move(timings)));
+    }
+
+    if (options.format == ResultFormat::Binary) {
+      ResultEncoder encoder;
+      size_t size = encoder.prepare(results);
+
+      if (options.buffer) {
+        if (options.buffer->size(runtime) < size) {
+          throw std::length_error("Result buffer too small, " + std::to_string(size) + " bytes needed");
+        }
+
+        encoder.write(options.buffer->data(runtime));
+        return jsi::Value(runtime, *options.buffer);
+      }
+
+      auto buffer = std::make_shared<PooledMutableBuffer>(g_pipeline.bufferPool().acquire(size), size);
+      encoder.write(buffer->data());
+      return jsi::ArrayBuffer(runtime, buffer);
+    }
+
+    std::string json = alpr::AlprImpl::toJson(results);
+    size_t end = json.rfind('}');
+    if (timings && end != std::string::npos) {
+      json.insert(end, ",\"timing\":" + timingsToJson(*timings));
+    }
+
+    return jsi::String::createFromUtf8(runtime, json);
+  }
+
+  std::shared_ptr<RecognitionTimings> createTimings(const ResultOptions& options) {
+    return options.timing ? std::make_shared<RecognitionTimings>() : nullptr;
+  }
+
+  // Reads an array of { x, y, width, height } regions
+  std::vector<cv::Rect> parseRegionsOfInterest(jsi::Runtime& runtime, const jsi::Value& value) {
+    if (!value.isObject() || !value.asObject(runtime).isArray(runtime)) {
+      throw std::invalid_argument("Regions of interest must be an array");
+    }
+
+    jsi::Array array = value.asObject(runtime).asArray(runtime);
+    std::vector<cv::Rect> regions;
+    regions.reserve(array.size(runtime));
+
+    for (size_t i = 0; i < array.size(runtime); ++i) {
+      jsi::Value entry = array.getValueAtIndex(runtime, i);
+      if (!entry.isObject()) {
+        throw std::invalid_argument("Region of interest " + std::to_string(i) + " is not an object");
       }
+
+      jsi::Object region = entry.asObject(runtime);
+      auto readNumber = [&](const char* name) {
+        jsi::Value number = region.getProperty(runtime, name);
+        if (!number.isNumber()) {
+          throw std::invalid_argument("Region of interest " + std::to_string(i) + " has no numeric " + name);
+        }
+        return static_cast<int>(number.asNumber());
+      };
+
+      cv::Rect rect(readNumber("x"), readNumber("y"), readNumber("width"), readNumber("height"));
+      if (rect.width <= 0 || rect.height <= 0) {
+        throw std::invalid_argument("Region of interest " + std::to_string(i) + " is empty");
+      }
+      regions.push_back(rect);
+    }
+
+    return regions;
+  }
+
+  // Reads the frame processing options from the same options object as the output format
+  FrameOptions getFrameOptions(jsi::Runtime& runtime, const jsi::Value* args, size_t count, size_t index) {
+    FrameOptions options;
+    if (count <= index || !args[index].isObject()) {
+      return options;
+    }
+
+    jsi::Object optionsObject = args[index].asObject(runtime);
+    auto motionGate = optionsObject.getProperty(runtime, "motionGate");
+    options.motionGate = motionGate.isBool() && motionGate.getBool();
+
+    auto track = optionsObject.getProperty(runtime, "track");
+    options.track = track.isBool() && track.getBool();
+
+    auto decimatedDetection = optionsObject.getProperty(runtime, "decimatedDetection");
+    options.decimatedDetection = decimatedDetection.isBool() && decimatedDetection.getBool();
+
+    auto regionsOfInterest = optionsObject.getProperty(runtime, "regionsOfInterest");
+    if (!regionsOfInterest.isUndefined()) {
+      options.regionsOfInterest = parseRegionsOfInterest(runtime, regionsOfInterest);
     }
+
+    return options;
   }
 
   AHardwareBuffer* getHardwareBuffer(jsi::Runtime& runtime, std::shared_ptr<FrameHostObject> frame) {
@@ -74,54 +223,79 @@ namespace visioncamerapluginanpr {
     return reinterpret_cast<AHardwareBuffer*>(pointer);
   }
 
-  std::string processImage(AHardwareBuffer* hardwareBuffer, int width, int height) {
-      AHardwareBuffer_Planes planes;
-      int result = AHardwareBuffer_lockPlanes(hardwareBuffer,AHARDWAREBUFFER_USAGE_CPU_READ_RARELY,-1, nullptr, &planes);
+  FrameRotation getFrameRotation(jsi::Runtime& runtime, std::shared_ptr<FrameHostObject> frame) {
+    auto orientationValue = frame->get(runtime, jsi::PropNameID::forUtf8(runtime, "orientation"));
 
-      if (result == 0) {
-          uint8_t* yPlane = static_cast<uint8_t*>(planes.planes[0].data);
-          int yStride = planes.planes[0].rowStride;
+    // Sensor frames on Android are landscape-left unless told otherwise
+    if (!orientationValue.isString()) {
+      return FrameRotation::Clockwise90;
+    }
 
-          unsigned char* pixelData = new unsigned char[width * height];
+    std::string orientation = orientationValue.getString(runtime).utf8(runtime);
 
-          // Rotate the Y-plane 90 degrees clockwise
-          for (int y = 0; y < height; ++y) {
-              for (int x = 0; x < width; ++x) {
-                  pixelData[x * height + (height - y - 1)] = yPlane[y * yStride + x];
-              }
-          }
+    if (orientation == "portrait") {
+      return FrameRotation::None;
+    } else if (orientation == "portrait-upside-down") {
+      return FrameRotation::Rotate180;
+    } else if (orientation == "landscape-right") {
+      return FrameRotation::CounterClockwise90;
+    }
 
-          std::vector<alpr::AlprRegionOfInterest> regionsOfInterest;
-          alpr::AlprResults results = g_openalprInstance->recognize(pixelData, 1, height, width, regionsOfInterest);
-          return alpr::Alpr::toJson(results);
-          delete[] pixelData;
-      } else {
-          LOGE("Failed to lock HardwareBuffer planes for reading! Error code: %d", result);
-          throw std::runtime_error("Failed to lock HardwareBuffer planes for reading!");
-      }
+    return FrameRotation::Clockwise90;
   }
 
-  auto initializeANPR  = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
-    try {
-      if (count < 1 || !args[0].isString()) {
-        LOGE("Invalid arguments");
-        throw jsi::JSError(runtime, "Invalid arguments");
-      }
+  bool isFrameMirrored(jsi::Runtime& runtime, std::shared_ptr<FrameHostObject> frame) {
+    auto mirroredValue = frame->get(runtime, jsi::PropNameID::forUtf8(runtime, "isMirrored"));
+    return mirroredValue.isBool() && mirroredValue.getBool();
+  }
 
-      std::string country = args[0].getString(runtime).utf8(runtime);
-      
-      int topN = 0; 
-      std::string region = "";
+  // Adapts a VisionCamera frame for the recognition pipeline. Its planes are only mapped once the pipeline locks it.
+  std::unique_ptr<FrameSource> createFrameSource(jsi::Runtime& runtime, const jsi::Value& frameValue) {
+    auto frame = frameValue.asObject(runtime).asHostObject<FrameHostObject>(runtime);
 
-      if (count > 1 && args[1].isNumber()) {
-        topN = args[1].asNumber();
-      }
+    int height = frame->get(runtime, jsi::PropNameID::forUtf8(runtime, "height")).asNumber();
+    int width = frame->get(runtime, jsi::PropNameID::forUtf8(runtime, "width")).asNumber();
 
-      if (count > 2 && args[2].isString()) {
-        region = args[2].getString(runtime).utf8(runtime);
-      }
+    return std::make_unique<HardwareBufferFrameSource>(getHardwareBuffer(runtime, frame), width, height,
+                                                       getFrameRotation(runtime, frame), isFrameMirrored(runtime, frame));
+  }
+
+  struct InitializeArguments {
+    std::string country;
+    int topN = 0;
+    std::string region;
+    // Independent engines to run recognitions on concurrently
+    int engineCount = 1;
+  };
+
+  InitializeArguments parseInitializeArguments(jsi::Runtime& runtime, const jsi::Value* args, size_t count) {
+    if (count < 1 || !args[0].isString()) {
+      LOGE("Invalid arguments");
+      throw jsi::JSError(runtime, "Invalid arguments");
+    }
+
+    InitializeArguments arguments;
+    arguments.country = args[0].getString(runtime).utf8(runtime);
+
+    if (count > 1 && args[1].isNumber()) {
+      arguments.topN = args[1].asNumber();
+    }
+
+    if (count > 2 && args[2].isString()) {
+      arguments.region = args[2].getString(runtime).utf8(runtime);
+    }
 
-      initializeOpenALPR(country, topN, region);
+    if (count > 3 && args[3].isNumber()) {
+      arguments.engineCount = std::max(1, static_cast<int>(args[3].asNumber()));
+    }
+
+    return arguments;
+  }
+
+  auto initializeANPR  = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    try {
+      InitializeArguments arguments = parseInitializeArguments(runtime, args, count);
+      g_pipeline.initialize(arguments.country, arguments.topN, arguments.region, arguments.engineCount);
 
       // JSI requires a return value - undefined to specify void
       return jsi::Value::undefined();
@@ -140,8 +314,11 @@ namespace visioncamerapluginanpr {
 
       int topN = args[0].asNumber();
 
-      if (g_openalprInstance) {
-        g_openalprInstance->setTopN(topN);
+      std::shared_ptr<EnginePool> enginePool = g_pipeline.findEnginePool();
+      if (enginePool) {
+        enginePool->configureAll([&](alpr::AlprImpl& engine) {
+          engine.setTopN(topN);
+        });
       } else {
         LOGE("OpenALPR not initialized");
         throw jsi::JSError(runtime, "OpenALPR not initialized");
@@ -164,8 +341,12 @@ namespace visioncamerapluginanpr {
 
       std::string country = args[0].getString(runtime).utf8(runtime);
 
-      if (g_openalprInstance) {
-        g_openalprInstance->setCountry(country);
+      std::shared_ptr<EnginePool> enginePool = g_pipeline.findEnginePool();
+      if (enginePool) {
+        enginePool->configureAll([&](alpr::AlprImpl& engine) {
+          engine.setCountry(country);
+          g_pipeline.plateRegionDetectors().invalidate(engine);
+        });
       } else {
         LOGE("OpenALPR not initialized");
         throw jsi::JSError(runtime, "OpenALPR not initialized");
@@ -187,8 +368,12 @@ namespace visioncamerapluginanpr {
 
       std::string prewarpConfig = args[0].getString(runtime).utf8(runtime);
 
-      if (g_openalprInstance) {
-        g_openalprInstance->setPrewarp(prewarpConfig);
+      std::shared_ptr<EnginePool> enginePool = g_pipeline.findEnginePool();
+      if (enginePool) {
+        enginePool->configureAll([&](alpr::AlprImpl& engine) {
+          engine.setPrewarp(prewarpConfig);
+          g_pipeline.plateRegionDetectors().invalidate(engine);
+        });
       } else {
         LOGE("OpenALPR not initialized");
         throw jsi::JSError(runtime, "OpenALPR not initialized");
@@ -213,8 +398,12 @@ namespace visioncamerapluginanpr {
       int imgWidth = args[2].asNumber();
       int imgHeight = args[3].asNumber();
 
-      if (g_openalprInstance) {
-        g_openalprInstance->setMask(pixelData, bytesPerPixel, imgWidth, imgHeight);
+      std::shared_ptr<EnginePool> enginePool = g_pipeline.findEnginePool();
+      if (enginePool) {
+        enginePool->configureAll([&](alpr::AlprImpl& engine) {
+          engine.setMask(pixelData, bytesPerPixel, imgWidth, imgHeight);
+          g_pipeline.plateRegionDetectors().invalidate(engine);
+        });
       } else {
         LOGE("OpenALPR not initialized");
         throw jsi::JSError(runtime, "OpenALPR not initialized");
@@ -236,8 +425,11 @@ namespace visioncamerapluginanpr {
 
       bool detectRegion = args[0].getBool();
 
-      if (g_openalprInstance) {
-        g_openalprInstance->setDetectRegion(detectRegion);
+      std::shared_ptr<EnginePool> enginePool = g_pipeline.findEnginePool();
+      if (enginePool) {
+        enginePool->configureAll([&](alpr::AlprImpl& engine) {
+          engine.setDetectRegion(detectRegion);
+        });
       } else {
         LOGE("OpenALPR not initialized");
         throw jsi::JSError(runtime, "OpenALPR not initialized");
@@ -259,8 +451,11 @@ namespace visioncamerapluginanpr {
 
       std::string region = args[0].getString(runtime).utf8(runtime);
 
-      if (g_openalprInstance) {
-        g_openalprInstance->setDefaultRegion(region);
+      std::shared_ptr<EnginePool> enginePool = g_pipeline.findEnginePool();
+      if (enginePool) {
+        enginePool->configureAll([&](alpr::AlprImpl& engine) {
+          engine.setDefaultRegion(region);
+        });
       } else {
         LOGE("OpenALPR not initialized");
         throw jsi::JSError(runtime, "OpenALPR not initialized");
@@ -273,77 +468,149 @@ namespace visioncamerapluginanpr {
     }
   };
 
+  auto setPlateDetector = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    try {
+      if (count < 1 || !args[0].isString()) {
+        LOGE("Plate detector must be a string");
+        throw jsi::JSError(runtime, "Plate detector must be a string");
+      }
+
+      std::string name = args[0].getString(runtime).utf8(runtime);
+      PlateDetectorType type;
+      if (name == "openalpr") {
+        type = PlateDetectorType::OpenAlpr;
+      } else if (name == "lbp") {
+        type = PlateDetectorType::SharedCascade;
+      } else if (name == "lbpVector") {
+        type = PlateDetectorType::VectorCascade;
+      } else {
+        throw std::runtime_error("Unknown plate detector " + name);
+      }
+
+      // Engines rebuild their detector on their next detection; before initialization there are none to rebuild
+      PlateRegionDetectors& detectors = g_pipeline.plateRegionDetectors();
+      detectors.setDetectorType(type);
+      std::shared_ptr<EnginePool> enginePool = g_pipeline.findEnginePool();
+      if (enginePool) {
+        enginePool->configureAll([&](alpr::AlprImpl& engine) {
+          detectors.invalidate(engine);
+        });
+      }
+
+      return jsi::Value::undefined();
+    } catch (const std::exception& e) {
+      LOGE("Error in setPlateDetector: %s", e.what());
+      throw jsi::JSError(runtime, std::string("Error in setPlateDetector: ") + e.what());
+    }
+  };
+
+  auto setReducedJpegDecode = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    try {
+      if (count < 1 || !args[0].isBool()) {
+        LOGE("ReducedJpegDecode value must be a boolean");
+        throw jsi::JSError(runtime, "ReducedJpegDecode value must be a boolean");
+      }
+
+      g_pipeline.setReducedDecode(args[0].getBool());
+
+      return jsi::Value::undefined();
+    } catch (const std::exception& e) {
+      LOGE("Error in setReducedJpegDecode: %s", e.what());
+      throw jsi::JSError(runtime, std::string("Error in setReducedJpegDecode: ") + e.what());
+    }
+  };
+
   auto recognise = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
       LOGI("Starting ALPR recognition");
       try {
-          if (!g_openalprInstance) {
+          if (!g_pipeline.findEnginePool()) {
               throw jsi::JSError(runtime, "OpenALPR not initialized");
           }
 
           // Case 1: Recognize from file path
-          if (count == 1 && args[0].isString()) {
-              std::string filePath = args[0].getString(runtime).utf8(runtime);
+          if (count >= 1 && args[0].isString()) {
+              ResultOptions options = getResultOptions(runtime, args, count, 1);
 
-              // TODO: Fix the fact that the openalpr recognize method only works if I manually open the file first
-              std::ifstream file(filePath);
-              file.close();
+              std::string filePath = args[0].getString(runtime).utf8(runtime);
 
               // Proceed with ALPR recognition
               try {
-                  alpr::AlprResults results = g_openalprInstance->recognize(filePath);
+                  // Read whole, so a JPEG can be decoded at a reduced scale for detection like image bytes are
+                  std::vector<uint8_t> imageBytes = readImageFile(filePath);
+
+                  std::shared_ptr<RecognitionTimings> timings = createTimings(options);
+                  alpr::AlprResults results = g_pipeline.recogniseEncoded(imageBytes.data(), imageBytes.size(), {}, timings.get());
                   LOGI("ALPR recognition completed");
-                  return jsi::String::createFromUtf8(runtime, alpr::Alpr::toJson(results));
+                  return toJsResult(runtime, std::move(results), options, timings);
               } catch (const std::exception& e) {
                   LOGE("Exception during ALPR recognition: %s", e.what());
                   return jsi::String::createFromUtf8(runtime, std::string("Error during recognition: ") + e.what());
               }
           }
 
-          // Case 2: Recognize from image bytes
-          if (count == 1 && args[0].isObject() && args[0].asObject(runtime).isArrayBuffer(runtime)) {
-            LOGI("Starting ALPR recognition with image bytes");
-            try {  
+          // Case 3: Recognize from image bytes with regions of interest
+          if (count >= 2 && args[0].isObject() && args[0].asObject(runtime).isArrayBuffer(runtime) &&
+              args[1].isObject() && args[1].asObject(runtime).isArray(runtime)) {
+              ResultOptions options = getResultOptions(runtime, args, count, 2);
               jsi::ArrayBuffer arrayBuffer = args[0].asObject(runtime).getArrayBuffer(runtime);
-              jsi::Value byteLengthValue = args[0].asObject(runtime).getProperty(runtime, "byteLength");
-              size_t byteLength = byteLengthValue.asNumber();
+              std::vector<cv::Rect> regionsOfInterest = parseRegionsOfInterest(runtime, args[1]);
+
+              // The ArrayBuffer stays alive and unchanged while recognise runs on the JS thread, so it is decoded in place
+              try {
+                  std::shared_ptr<RecognitionTimings> timings = createTimings(options);
+                  alpr::AlprResults results = g_pipeline.recogniseEncoded(arrayBuffer.data(runtime), arrayBuffer.size(runtime),
+                                                                          regionsOfInterest, timings.get());
+                  return toJsResult(runtime, std::move(results), options, timings);
+              } catch (const std::exception& e) {
+                  LOGE("Exception during ALPR recognition: %s", e.what());
+                  return jsi::String::createFromUtf8(runtime, std::string("Error during recognition: ") + e.what());
+              }
+          }
+
+          // Case 4: Recognize from raw pixel data
+          if (count >= 4 && args[0].isObject() && args[0].asObject(runtime).isArrayBuffer(runtime) &&
+              args[1].isNumber() && args[2].isNumber() && args[3].isObject() && args[3].asObject(runtime).isArray(runtime)) {
+              ResultOptions options = getResultOptions(runtime, args, count, 4);
+              jsi::ArrayBuffer arrayBuffer = args[0].asObject(runtime).getArrayBuffer(runtime);
+              int imgWidth = args[1].asNumber();
+              int imgHeight = args[2].asNumber();
+              std::vector<cv::Rect> regionsOfInterest = parseRegionsOfInterest(runtime, args[3]);
+
+              // Assuming 3 bytes per pixel (RGB)
+              const int bytesPerPixel = 3;
+              if (imgWidth <= 0 || imgHeight <= 0 ||
+                  arrayBuffer.size(runtime) < static_cast<size_t>(imgWidth) * imgHeight * bytesPerPixel) {
+                throw std::invalid_argument("Pixel data does not match the given width and height");
+              }
 
-              // Get the pointer to the data in the ArrayBuffer
-              const uint8_t *data = arrayBuffer.data(runtime);
+              unsigned char* pixelData = arrayBuffer.data(runtime);
+              try {
+                  // Read in place, like engine.recognize reads raw pixels, but through the selected plate detector
+                  std::shared_ptr<RecognitionTimings> timings = createTimings(options);
+                  cv::Mat image(imgHeight, imgWidth, CV_8UC3, pixelData);
+                  alpr::AlprResults results = g_pipeline.recogniseImage(image, regionsOfInterest, timings.get());
+                  return toJsResult(runtime, std::move(results), options, timings);
+              } catch (const std::exception& e) {
+                  LOGE("Exception during ALPR recognition: %s", e.what());
+                  return jsi::String::createFromUtf8(runtime, std::string("Error during recognition: ") + e.what());
+              }
+          }
 
-              // Create a std::vector<char> and fill it with the bytes from the ArrayBuffer
-              std::vector<char> imageBytes(data, data + byteLength);
+          // Case 2: Recognize from image bytes, checked after the cases it is a prefix of
+          if (count >= 1 && args[0].isObject() && args[0].asObject(runtime).isArrayBuffer(runtime)) {
+            LOGI("Starting ALPR recognition with image bytes");
+            try {
+              ResultOptions options = getResultOptions(runtime, args, count, 1);
+              jsi::ArrayBuffer arrayBuffer = args[0].asObject(runtime).getArrayBuffer(runtime);
 
-              alpr::AlprResults results = g_openalprInstance->recognize(imageBytes);
-              return jsi::String::createFromUtf8(runtime, alpr::Alpr::toJson(results));
+              std::shared_ptr<RecognitionTimings> timings = createTimings(options);
+              alpr::AlprResults results = g_pipeline.recogniseEncoded(arrayBuffer.data(runtime), arrayBuffer.size(runtime), {}, timings.get());
+              return toJsResult(runtime, std::move(results), options, timings);
             } catch (const std::exception& e) {
               LOGE("Exception during ALPR recognition: %s", e.what());
               return jsi::String::createFromUtf8(runtime, std::string("Error during recognition: ") + e.what());
             }
           }
- 
-          // // Case 3: Recognize from image bytes with regions of interest
-          // if (count == 2 && args[0].isObject() && args[0].asObject(runtime).isArrayBuffer(runtime) && 
-          //     args[1].isObject() && args[1].asObject(runtime).isArray(runtime)) {
-          //     auto arrayBuffer = args[0].asObject(runtime).getArrayBuffer(runtime);
-          //     std::vector<char> imageBytes(static_cast<char*>(arrayBuffer.data(runtime)), 
-          //                                 static_cast<char*>(arrayBuffer.data(runtime)) + arrayBuffer.size(runtime));
-          //     std::vector<alpr::AlprRegionOfInterest> regionsOfInterest = parseRegionsOfInterest(runtime, args[1]);
-          //     alpr::AlprResults results = g_openalprInstance->recognize(imageBytes, regionsOfInterest);
-          //     return jsi::String::createFromUtf8(runtime, alpr::Alpr::toJson(results));
-          // }
-
-          // // Case 4: Recognize from raw pixel data
-          // if (count == 4 && args[0].isObject() && args[0].asObject(runtime).isArrayBuffer(runtime) && 
-          //     args[1].isNumber() && args[2].isNumber() && args[3].isObject() && args[3].asObject(runtime).isArray(runtime)) {
-          //     unsigned char* pixelData = getPixelData(runtime, args[0]);
-          //     int imgWidth = args[1].asNumber();
-          //     int imgHeight = args[2].asNumber();
-          //     std::vector<alpr::AlprRegionOfInterest> regionsOfInterest = parseRegionsOfInterest(runtime, args[3]);
-              
-          //     // Assuming 3 bytes per pixel (RGB)
-          //     alpr::AlprResults results = g_openalprInstance->recognize(pixelData, 3, imgWidth, imgHeight, regionsOfInterest);
-          //     return jsi::String::createFromUtf8(runtime, alpr::Alpr::toJson(results));
-          // }
 
           // If we reach here, the arguments didn't match any expected pattern
 
@@ -362,20 +629,668 @@ namespace visioncamerapluginanpr {
         throw jsi::JSError(runtime, "Invalid arguments");
       }
 
-      auto frame = args[0].asObject(runtime).asHostObject<FrameHostObject>(runtime);
+      ResultOptions options = getResultOptions(runtime, args, count, 1);
+      FrameOptions frameOptions = getFrameOptions(runtime, args, count, 1);
+      std::unique_ptr<FrameSource> source = createFrameSource(runtime, args[0]);
+
+      if (!g_pipeline.findEnginePool()) {
+        throw jsi::JSError(runtime, "OpenALPR not initialized");
+      }
+
+      // Admitted only once nothing above can throw. Frames the scheduler turns down cost nothing beyond this check.
+      if (!g_pipeline.admitFrame()) {
+        return jsi::Value::null();
+      }
+
+      std::shared_ptr<RecognitionTimings> timings = createTimings(options);
+      std::optional<alpr::AlprResults> results = g_pipeline.recogniseFrame(*source, frameOptions, timings.get());
+      if (!results) {
+        return jsi::Value::null();
+      }
 
-      int height = frame->get(runtime, jsi::PropNameID::forUtf8(runtime, "height")).asNumber();
-      int width = frame->get(runtime, jsi::PropNameID::forUtf8(runtime, "width")).asNumber();
-      
-      
-      std::string jsonResult = processImage(getHardwareBuffer(runtime, frame), width, height);
-      return jsi::String::createFromUtf8(runtime, jsonResult);
+      return toJsResult(runtime, std::move(*results), options, timings);
     } catch (const std::exception& e) {
       LOGE("Error in recogniseFrame: %s", e.what());
       throw jsi::JSError(runtime, std::string("Error in recogniseFrame: ") + e.what());
     }
   };
 
+  auto recogniseFrameAsync = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    try {
+      if (count < 1 || !args[0].isObject()) {
+        LOGE("Invalid arguments");
+        throw jsi::JSError(runtime, "Invalid arguments");
+      }
+
+      FrameOptions frameOptions = getFrameOptions(runtime, args, count, 1);
+
+      // Results are converted later by getLatestFrameResult, but timing has to be asked for up front
+      bool timing = getResultOptions(runtime, args, count, 1).timing;
+
+      std::unique_ptr<FrameSource> source = createFrameSource(runtime, args[0]);
+
+      if (!g_pipeline.findEnginePool()) {
+        throw jsi::JSError(runtime, "OpenALPR not initialized");
+      }
+
+      // Admitted only once nothing above can throw. Skipped frames are not copied out of the camera buffer.
+      if (!g_pipeline.admitFrame()) {
+        return jsi::Value::null();
+      }
+
+      std::optional<uint64_t> frameId = g_pipeline.submitFrame(*source, frameOptions, timing);
+      if (!frameId) {
+        return jsi::Value::null();
+      }
+
+      return jsi::Value(static_cast<double>(*frameId));
+    } catch (const std::exception& e) {
+      LOGE("Error in recogniseFrameAsync: %s", e.what());
+      throw jsi::JSError(runtime, std::string("Error in recogniseFrameAsync: ") + e.what());
+    }
+  };
+
+  // A recognise call whose Promise is still unsettled. Only touched on the JS thread.
+  struct PendingRecognition {
+    jsi::Function resolve;
+    jsi::Function reject;
+    ResultOptions options;
+    // Caller's id to cancel it by, from options.requestId
+    std::optional<double> requestId;
+    // Keeps the input alive while an engine reads it in place
+    std::optional<jsi::ArrayBuffer> input;
+    std::shared_ptr<std::atomic<bool>> cancelled;
+    // Rejected by cancelRecognition. Stays registered, holding its input, until the engine is done with it.
+    bool settled = false;
+  };
+
+  using PendingRecognitions = std::unordered_map<uint64_t, std::shared_ptr<PendingRecognition>>;
+
+  static std::shared_ptr<react::CallInvoker> g_callInvoker;
+  // Replaced, never freed, when the plugin is installed into a new runtime: the JS values of recognitions
+  // still pending in the old one must not be released once that runtime is gone
+  static PendingRecognitions* g_pendingRecognitions = nullptr;
+  static uint64_t g_nextRecognitionId = 1;
+
+  jsi::Value createJsError(jsi::Runtime& runtime, const std::string& message) {
+    return runtime.global().getPropertyAsFunction(runtime, "Error").callAsConstructor(runtime, jsi::String::createFromUtf8(runtime, message));
+  }
+
+  // Resolves or rejects a recognition's Promise on the JS thread once the engine is done with it, unless it was
+  // cancelled meanwhile
+  void settleRecognition(jsi::Runtime& runtime, PendingRecognitions& pendingRecognitions, uint64_t id, ImageResult result) {
+    auto entry = pendingRecognitions.find(id);
+    if (entry == pendingRecognitions.end()) {
+      return;
+    }
+
+    std::shared_ptr<PendingRecognition> pending = entry->second;
+    pendingRecognitions.erase(entry);
+    if (pending->settled) {
+      return;
+    }
+
+    if (!result.error.empty()) {
+      pending->reject.call(runtime, createJsError(runtime, "Error in recogniseAsync: " + result.error));
+      return;
+    }
+
+    try {
+      jsi::Value value = toJsResult(runtime, std::move(result.results), pending->options, std::move(result.timings));
+      pending->resolve.call(runtime, value);
+    } catch (const std::exception& e) {
+      pending->reject.call(runtime, createJsError(runtime, std::string("Error in recogniseAsync: ") + e.what()));
+    }
+  }
+
+  // Takes the same arguments as recognise and returns a Promise of the same result. Decoding and recognition run
+  // on the engine threads, so the JS thread is free meanwhile; an ArrayBuffer must not be changed until it settles.
+  auto recogniseAsync = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    try {
+      if (!g_pipeline.findEnginePool()) {
+        throw std::runtime_error("OpenALPR not initialized");
+      }
+      if (!g_callInvoker || !g_pendingRecognitions) {
+        throw std::runtime_error("Plugin installed without a CallInvoker");
+      }
+
+      EncodedImage encoded;
+      cv::Mat pixels;
+      std::vector<cv::Rect> regionsOfInterest;
+      std::optional<jsi::ArrayBuffer> input;
+      size_t optionsIndex = 1;
+
+      if (count >= 1 && args[0].isString()) {
+        encoded.path = args[0].getString(runtime).utf8(runtime);
+      } else if (count >= 1 && args[0].isObject() && args[0].asObject(runtime).isArrayBuffer(runtime)) {
+        input = args[0].asObject(runtime).getArrayBuffer(runtime);
+
+        if (count >= 4 && args[1].isNumber() && args[2].isNumber() && args[3].isObject() && args[3].asObject(runtime).isArray(runtime)) {
+          // Raw pixel data, 3 bytes per pixel
+          int imgWidth = args[1].asNumber();
+          int imgHeight = args[2].asNumber();
+          if (imgWidth <= 0 || imgHeight <= 0 || input->size(runtime) < static_cast<size_t>(imgWidth) * imgHeight * 3) {
+            throw std::invalid_argument("Pixel data does not match the given width and height");
+          }
+
+          pixels = cv::Mat(imgHeight, imgWidth, CV_8UC3, input->data(runtime));
+          regionsOfInterest = parseRegionsOfInterest(runtime, args[3]);
+          optionsIndex = 4;
+        } else {
+          if (count >= 2 && args[1].isObject() && args[1].asObject(runtime).isArray(runtime)) {
+            regionsOfInterest = parseRegionsOfInterest(runtime, args[1]);
+            optionsIndex = 2;
+          }
+
+          encoded.bytes = input->data(runtime);
+          encoded.size = input->size(runtime);
+        }
+      } else {
+        throw std::invalid_argument("Invalid arguments for recogniseAsync");
+      }
+
+      ResultOptions options = getResultOptions(runtime, args, count, optionsIndex);
+      std::optional<double> requestId;
+      if (count > optionsIndex && args[optionsIndex].isObject()) {
+        auto requestIdValue = args[optionsIndex].asObject(runtime).getProperty(runtime, "requestId");
+        if (requestIdValue.isNumber()) {
+          requestId = requestIdValue.asNumber();
+        }
+      }
+
+      // The executor runs inside the Promise constructor, so `pending` is set by the time it returns
+      std::shared_ptr<PendingRecognition> pending;
+      jsi::Function executor = jsi::Function::createFromHostFunction(runtime, jsi::PropNameID::forAscii(runtime, "executor"), 2,
+        [&pending](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+          pending = std::make_shared<PendingRecognition>(PendingRecognition{
+            args[0].asObject(runtime).asFunction(runtime),
+            args[1].asObject(runtime).asFunction(runtime)
+          });
+          return jsi::Value::undefined();
+        });
+      jsi::Value promise = runtime.global().getPropertyAsFunction(runtime, "Promise").callAsConstructor(runtime, executor);
+
+      const uint64_t id = g_nextRecognitionId++;
+      pending->options = std::move(options);
+      pending->requestId = requestId;
+      pending->input = std::move(input);
+      pending->cancelled = std::make_shared<std::atomic<bool>>(false);
+
+      // Hands the outcome from the engine thread back to the JS thread
+      auto done = [id, runtime = &runtime, pendingRecognitions = g_pendingRecognitions, callInvoker = g_callInvoker](ImageResult result) {
+        auto outcome = std::make_shared<ImageResult>(std::move(result));
+        callInvoker->invokeAsync([id, runtime, pendingRecognitions, outcome]() {
+          settleRecognition(*runtime, *pendingRecognitions, id, std::move(*outcome));
+        });
+      };
+
+      if (!pixels.empty()) {
+        g_pipeline.recogniseImageAsync(pixels, regionsOfInterest, pending->options.timing, pending->cancelled, done);
+      } else {
+        g_pipeline.recogniseEncodedAsync(encoded, regionsOfInterest, pending->options.timing, pending->cancelled, done);
+      }
+      (*g_pendingRecognitions)[id] = pending;
+
+      return promise;
+    } catch (const std::exception& e) {
+      LOGE("Error in recogniseAsync: %s", e.what());
+      throw jsi::JSError(runtime, std::string("Error in recogniseAsync: ") + e.what());
+    }
+  };
+
+  // Rejects the pending recognitions started with this requestId, and skips them if no engine has picked them up
+  // yet. An engine already reading one finishes, but its result is dropped. Returns whether any were pending.
+  auto cancelRecognition = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    if (count < 1 || !args[0].isNumber()) {
+      throw jsi::JSError(runtime, "Request id must be a number");
+    }
+    if (!g_pendingRecognitions) {
+      return false;
+    }
+
+    const double requestId = args[0].asNumber();
+    std::vector<std::shared_ptr<PendingRecognition>> cancelled;
+    for (const auto& entry : *g_pendingRecognitions) {
+      if (!entry.second->settled && entry.second->requestId == requestId) {
+        entry.second->settled = true;
+        entry.second->cancelled->store(true);
+        cancelled.push_back(entry.second);
+      }
+    }
+
+    for (const std::shared_ptr<PendingRecognition>& pending : cancelled) {
+      pending->reject.call(runtime, createJsError(runtime, "Recognition cancelled"));
+    }
+    return !cancelled.empty();
+  };
+
+  jsi::Object toJsInitialization(jsi::Runtime& runtime, const InitializationTimings& timings) {
+    jsi::Array engines(runtime, timings.engines.size());
+    for (size_t i = 0; i < timings.engines.size(); ++i) {
+      const EngineLoadTiming& engine = timings.engines[i];
+      jsi::Object timing(runtime);
+      timing.setProperty(runtime, "constructMs", engine.constructMs);
+      timing.setProperty(runtime, "warmUpMs", engine.warmUpMs);
+      timing.setProperty(runtime, "warmUpStages", toJsStages(runtime, engine.warmUpStages));
+      engines.setValueAtIndex(runtime, i, timing);
+    }
+
+    jsi::Object result(runtime);
+    result.setProperty(runtime, "bundleMs", timings.bundleMs);
+    result.setProperty(runtime, "engines", engines);
+    result.setProperty(runtime, "totalMs", timings.totalMs);
+    result.setProperty(runtime, "firstResultMs", timings.firstResultMs);
+    return result;
+  }
+
+  // An initializeANPRAsync call whose Promise is still unsettled. Only touched on the JS thread.
+  struct PendingInitialization {
+    jsi::Function resolve;
+    jsi::Function reject;
+  };
+
+  // Replaced, never freed, when the plugin is installed into a new runtime, like g_pendingRecognitions
+  static std::unordered_map<uint64_t, PendingInitialization>* g_pendingInitializations = nullptr;
+  static uint64_t g_nextInitializationId = 1;
+
+  // Takes the same arguments as initializeANPR, plus { warmUp } options, and returns a Promise of the cold-start
+  // timings. The engines load on a background thread, so app launch is not held up by them.
+  auto initializeANPRAsync = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    try {
+      if (!g_callInvoker || !g_pendingInitializations) {
+        throw std::runtime_error("Plugin installed without a CallInvoker");
+      }
+
+      InitializeArguments arguments = parseInitializeArguments(runtime, args, count);
+      bool warmUp = false;
+      if (count > 4 && args[4].isObject()) {
+        auto warmUpValue = args[4].asObject(runtime).getProperty(runtime, "warmUp");
+        warmUp = warmUpValue.isBool() && warmUpValue.getBool();
+      }
+
+      // The executor runs inside the Promise constructor, so the entry is registered by the time it returns
+      const uint64_t id = g_nextInitializationId++;
+      jsi::Function executor = jsi::Function::createFromHostFunction(runtime, jsi::PropNameID::forAscii(runtime, "executor"), 2,
+        [id](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+          g_pendingInitializations->emplace(id, PendingInitialization{
+            args[0].asObject(runtime).asFunction(runtime),
+            args[1].asObject(runtime).asFunction(runtime)
+          });
+          return jsi::Value::undefined();
+        });
+      jsi::Value promise = runtime.global().getPropertyAsFunction(runtime, "Promise").callAsConstructor(runtime, executor);
+
+      // Hands the outcome from the loader thread back to the JS thread, where the Promise's functions live
+      auto done = [id, runtime = &runtime, pendingInitializations = g_pendingInitializations, callInvoker = g_callInvoker](InitializationResult result) {
+        auto outcome = std::make_shared<InitializationResult>(std::move(result));
+        callInvoker->invokeAsync([id, runtime, pendingInitializations, outcome]() {
+          auto entry = pendingInitializations->find(id);
+          if (entry == pendingInitializations->end()) {
+            return;
+          }
+
+          PendingInitialization pending = std::move(entry->second);
+          pendingInitializations->erase(entry);
+          if (!outcome->error.empty()) {
+            pending.reject.call(*runtime, createJsError(*runtime, "Error in initializeANPRAsync: " + outcome->error));
+            return;
+          }
+          pending.resolve.call(*runtime, toJsInitialization(*runtime, outcome->timings));
+        });
+      };
+
+      g_pipeline.initializeAsync(arguments.country, arguments.topN, arguments.region, arguments.engineCount, warmUp, done);
+      return promise;
+    } catch (const std::exception& e) {
+      LOGE("Error in initializeANPRAsync: %s", e.what());
+      throw jsi::JSError(runtime, std::string("Error in initializeANPRAsync: ") + e.what());
+    }
+  };
+
+  // Cold-start timings, with the time to the first result filled in once there is one, or null before the engines are ready
+  auto getInitializationTimings = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    std::optional<InitializationTimings> timings = g_pipeline.initializationTimings();
+    if (!timings) {
+      return jsi::Value::null();
+    }
+    return toJsInitialization(runtime, *timings);
+  };
+
+  // A recogniseBatch call whose Promise is still unsettled. Only touched on the JS thread.
+  struct PendingBatch {
+    jsi::Function resolve;
+    jsi::Function reject;
+    ResultOptions options;
+    // Keep the inputs alive while the batch reads them in place
+    std::vector<jsi::ArrayBuffer> inputs;
+  };
+
+  // Replaced, never freed, when the plugin is installed into a new runtime, like g_pendingRecognitions
+  static std::unordered_map<uint64_t, std::shared_ptr<PendingBatch>>* g_pendingBatches = nullptr;
+  static uint64_t g_nextBatchId = 1;
+
+  // Returns a Promise of one result per input, in input order. Files are read, images decoded and recognised off the
+  // JS thread, so it is free meanwhile; an ArrayBuffer must not be changed until the Promise settles.
+  auto recogniseBatch = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    try {
+      if (!g_pipeline.findEnginePool()) {
+        throw std::runtime_error("OpenALPR not initialized");
+      }
+      if (!g_callInvoker || !g_pendingBatches) {
+        throw std::runtime_error("Plugin installed without a CallInvoker");
+      }
+      if (count < 1 || !args[0].isObject() || !args[0].asObject(runtime).isArray(runtime)) {
+        throw std::invalid_argument("Expected an array of file paths and ArrayBuffers");
+      }
+
+      ResultOptions options = getResultOptions(runtime, args, count, 1);
+      // One caller buffer cannot hold a result per image, so binary results always get their own
+      options.buffer.reset();
+
+      jsi::Array inputs = args[0].asObject(runtime).asArray(runtime);
+      std::vector<EncodedImage> images(inputs.size(runtime));
+      std::vector<jsi::ArrayBuffer> arrayBuffers;
+      for (size_t i = 0; i < images.size(); ++i) {
+        jsi::Value input = inputs.getValueAtIndex(runtime, i);
+        if (input.isString()) {
+          images[i].path = input.getString(runtime).utf8(runtime);
+        } else if (input.isObject() && input.asObject(runtime).isArrayBuffer(runtime)) {
+          jsi::ArrayBuffer arrayBuffer = input.asObject(runtime).getArrayBuffer(runtime);
+          images[i].bytes = arrayBuffer.data(runtime);
+          images[i].size = arrayBuffer.size(runtime);
+          arrayBuffers.push_back(std::move(arrayBuffer));
+        } else {
+          throw std::invalid_argument("Batch input " + std::to_string(i) + " is not a file path or an ArrayBuffer");
+        }
+      }
+
+      // The executor runs inside the Promise constructor, so `pending` is set by the time it returns
+      std::shared_ptr<PendingBatch> pending;
+      jsi::Function executor = jsi::Function::createFromHostFunction(runtime, jsi::PropNameID::forAscii(runtime, "executor"), 2,
+        [&pending](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+          pending = std::make_shared<PendingBatch>(PendingBatch{
+            args[0].asObject(runtime).asFunction(runtime),
+            args[1].asObject(runtime).asFunction(runtime)
+          });
+          return jsi::Value::undefined();
+        });
+      jsi::Value promise = runtime.global().getPropertyAsFunction(runtime, "Promise").callAsConstructor(runtime, executor);
+
+      const uint64_t id = g_nextBatchId++;
+      pending->options = std::move(options);
+      pending->inputs = std::move(arrayBuffers);
+
+      // Hands the results from the batch thread back to the JS thread, where the Promise's functions live
+      auto done = [id, runtime = &runtime, pendingBatches = g_pendingBatches, callInvoker = g_callInvoker](std::vector<ImageResult> batch) {
+        auto outcome = std::make_shared<std::vector<ImageResult>>(std::move(batch));
+        callInvoker->invokeAsync([id, runtime, pendingBatches, outcome]() {
+          auto entry = pendingBatches->find(id);
+          if (entry == pendingBatches->end()) {
+            return;
+          }
+
+          std::shared_ptr<PendingBatch> pending = entry->second;
+          pendingBatches->erase(entry);
+          try {
+            jsi::Array results(*runtime, outcome->size());
+            for (size_t i = 0; i < outcome->size(); ++i) {
+              ImageResult& image = (*outcome)[i];
+              jsi::Object result(*runtime);
+              if (!image.error.empty()) {
+                result.setProperty(*runtime, "error", jsi::String::createFromUtf8(*runtime, image.error));
+              } else {
+                result.setProperty(*runtime, "result", toJsResult(*runtime, std::move(image.results), pending->options, std::move(image.timings)));
+              }
+              results.setValueAtIndex(*runtime, i, result);
+            }
+            pending->resolve.call(*runtime, results);
+          } catch (const std::exception& e) {
+            pending->reject.call(*runtime, createJsError(*runtime, std::string("Error in recogniseBatch: ") + e.what()));
+          }
+        });
+      };
+
+      g_pipeline.recogniseBatchAsync(std::move(images), pending->options.timing, done);
+      (*g_pendingBatches)[id] = pending;
+
+      return promise;
+    } catch (const std::exception& e) {
+      LOGE("Error in recogniseBatch: %s", e.what());
+      throw jsi::JSError(runtime, std::string("Error in recogniseBatch: ") + e.what());
+    }
+  };
+
+  auto getLatestFrameResult = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    ResultOptions options;
+    try {
+      options = getResultOptions(runtime, args, count, 0);
+    } catch (const std::exception& e) {
+      LOGE("Error in getLatestFrameResult: %s", e.what());
+      throw jsi::JSError(runtime, std::string("Error in getLatestFrameResult: ") + e.what());
+    }
+
+    FrameResult frameResult;
+
+    if (!g_pipeline.takeFrameResult(frameResult)) {
+      return jsi::Value::null();
+    }
+
+    jsi::Object result(runtime);
+    result.setProperty(runtime, "frameId", static_cast<double>(frameResult.frameId));
+
+    if (!frameResult.error.empty()) {
+      result.setProperty(runtime, "error", jsi::String::createFromUtf8(runtime, frameResult.error));
+    } else {
+      result.setProperty(runtime, "result", toJsResult(runtime, std::move(frameResult.results), options, std::move(frameResult.timings)));
+    }
+
+    return result;
+  };
+
+  auto getBufferPoolStats = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    BufferPoolStats stats = g_pipeline.bufferPool().stats();
+
+    jsi::Object result(runtime);
+    result.setProperty(runtime, "bytesInUse", static_cast<double>(stats.bytesInUse));
+    result.setProperty(runtime, "bytesCached", static_cast<double>(stats.bytesCached));
+    result.setProperty(runtime, "highWaterMark", static_cast<double>(stats.highWaterMark));
+    result.setProperty(runtime, "allocations", static_cast<double>(stats.allocations));
+    result.setProperty(runtime, "reuses", static_cast<double>(stats.reuses));
+    return result;
+  };
+
+  // Buckets as { upperMs, count }, with a null bound on the last bucket, which takes everything slower
+  jsi::Object toJsLatency(jsi::Runtime& runtime, const LatencyHistogram::Counts& counts) {
+    jsi::Array buckets(runtime, LatencyHistogram::kBucketCount);
+    for (size_t i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+      jsi::Object bucket(runtime);
+      bucket.setProperty(runtime, "upperMs", i + 1 < LatencyHistogram::kBucketCount
+                                               ? jsi::Value(LatencyHistogram::kUpperBoundsMs[i])
+                                               : jsi::Value::null());
+      bucket.setProperty(runtime, "count", static_cast<double>(counts[i]));
+      buckets.setValueAtIndex(runtime, i, bucket);
+    }
+
+    jsi::Object result(runtime);
+    result.setProperty(runtime, "buckets", buckets);
+    result.setProperty(runtime, "p50Ms", LatencyHistogram::percentile(counts, 0.5));
+    result.setProperty(runtime, "p95Ms", LatencyHistogram::percentile(counts, 0.95));
+    return result;
+  }
+
+  auto getANPRStats = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    RuntimeStatsSnapshot stats = g_pipeline.runtimeStats().snapshot();
+    BufferPoolStats bufferPool = g_pipeline.bufferPool().stats();
+
+    jsi::Object result(runtime);
+    result.setProperty(runtime, "framesReceived", static_cast<double>(stats.framesReceived));
+    result.setProperty(runtime, "framesProcessed", static_cast<double>(stats.framesProcessed));
+    result.setProperty(runtime, "framesDropped", static_cast<double>(stats.framesDropped));
+    result.setProperty(runtime, "imagesProcessed", static_cast<double>(stats.imagesProcessed));
+    result.setProperty(runtime, "platesFound", static_cast<double>(stats.platesFound));
+    result.setProperty(runtime, "ocrCalls", static_cast<double>(stats.ocrCalls));
+    result.setProperty(runtime, "averageCandidatesPerFrame", stats.averageCandidatesPerFrame);
+    result.setProperty(runtime, "frameLatency", toJsLatency(runtime, stats.frameLatency));
+    result.setProperty(runtime, "imageLatency", toJsLatency(runtime, stats.imageLatency));
+    result.setProperty(runtime, "bufferBytesInUse", static_cast<double>(bufferPool.bytesInUse));
+    result.setProperty(runtime, "bufferBytesCached", static_cast<double>(bufferPool.bytesCached));
+    result.setProperty(runtime, "bufferHighWaterMark", static_cast<double>(bufferPool.highWaterMark));
+    return result;
+  };
+
+  auto resetANPRStats = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    g_pipeline.runtimeStats().reset();
+    g_pipeline.bufferPool().resetStats();
+    return jsi::Value::undefined();
+  };
+
+  auto configureFrameScheduler = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    try {
+      if (count < 1 || !args[0].isObject()) {
+        LOGE("Frame scheduler options must be an object");
+        throw jsi::JSError(runtime, "Frame scheduler options must be an object");
+      }
+
+      jsi::Object options = args[0].asObject(runtime);
+      FrameSchedulerConfig config = g_pipeline.frameScheduler().config();
+
+      auto maxFps = options.getProperty(runtime, "maxFps");
+      if (maxFps.isNumber()) {
+        config.maxFps = maxFps.asNumber();
+      }
+
+      auto maxDutyCycle = options.getProperty(runtime, "maxDutyCycle");
+      if (maxDutyCycle.isNumber()) {
+        config.maxDutyCycle = maxDutyCycle.asNumber();
+      }
+
+      auto targetLatencyMs = options.getProperty(runtime, "targetLatencyMs");
+      if (targetLatencyMs.isNumber()) {
+        config.targetLatencyMs = targetLatencyMs.asNumber();
+      }
+
+      g_pipeline.frameScheduler().configure(config);
+      return jsi::Value::undefined();
+    } catch (const std::exception& e) {
+      LOGE("Error in configureFrameScheduler: %s", e.what());
+      throw jsi::JSError(runtime, std::string("Error in configureFrameScheduler: ") + e.what());
+    }
+  };
+
+  auto getFrameSchedulerStats = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    FrameSchedulerStats stats = g_pipeline.frameScheduler().stats();
+
+    jsi::Object result(runtime);
+    result.setProperty(runtime, "processed", static_cast<double>(stats.processed));
+    result.setProperty(runtime, "skippedFrameRate", static_cast<double>(stats.skippedFrameRate));
+    result.setProperty(runtime, "skippedDutyCycle", static_cast<double>(stats.skippedDutyCycle));
+    result.setProperty(runtime, "skippedLatency", static_cast<double>(stats.skippedLatency));
+    result.setProperty(runtime, "p50LatencyMs", stats.p50LatencyMs);
+    result.setProperty(runtime, "p95LatencyMs", stats.p95LatencyMs);
+    result.setProperty(runtime, "latencySamples", static_cast<double>(stats.latencySamples));
+    return result;
+  };
+
+  auto getMotionGateStats = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    MotionGateStats stats = g_pipeline.motionGate().stats();
+
+    jsi::Object result(runtime);
+    result.setProperty(runtime, "framesChecked", static_cast<double>(stats.framesChecked));
+    result.setProperty(runtime, "framesStatic", static_cast<double>(stats.framesStatic));
+    return result;
+  };
+
+  auto resetMotionGate = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    g_pipeline.motionGate().reset();
+    return jsi::Value::undefined();
+  };
+
+  jsi::Object toJsPlateTrack(jsi::Runtime& runtime, const PlateTrack& track) {
+    jsi::Object result(runtime);
+    result.setProperty(runtime, "id", static_cast<double>(track.id));
+    result.setProperty(runtime, "plate", jsi::String::createFromUtf8(runtime, alpr::AlprImpl::toJson(track.consensus)));
+    result.setProperty(runtime, "observations", track.observations);
+    result.setProperty(runtime, "converged", track.converged);
+    result.setProperty(runtime, "firstSeenMs", track.firstSeenMs);
+    result.setProperty(runtime, "lastSeenMs", track.lastSeenMs);
+    return result;
+  }
+
+  jsi::Array toJsPlateTracks(jsi::Runtime& runtime, const std::vector<PlateTrack>& tracks) {
+    jsi::Array result(runtime, tracks.size());
+    for (size_t i = 0; i < tracks.size(); ++i) {
+      result.setValueAtIndex(runtime, i, toJsPlateTrack(runtime, tracks[i]));
+    }
+    return result;
+  }
+
+  auto configurePlateTracker = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    try {
+      if (count < 1 || !args[0].isObject()) {
+        LOGE("Plate tracker options must be an object");
+        throw jsi::JSError(runtime, "Plate tracker options must be an object");
+      }
+
+      jsi::Object options = args[0].asObject(runtime);
+      PlateTrackerConfig config = g_pipeline.plateTracker().config();
+
+      auto minIoU = options.getProperty(runtime, "minIoU");
+      if (minIoU.isNumber()) {
+        config.minIoU = minIoU.asNumber();
+      }
+
+      auto maxEditDistance = options.getProperty(runtime, "maxEditDistance");
+      if (maxEditDistance.isNumber()) {
+        config.maxEditDistance = static_cast<int>(maxEditDistance.asNumber());
+      }
+
+      auto convergedConfidence = options.getProperty(runtime, "convergedConfidence");
+      if (convergedConfidence.isNumber()) {
+        config.convergedConfidence = static_cast<float>(convergedConfidence.asNumber());
+      }
+
+      auto minObservations = options.getProperty(runtime, "minObservations");
+      if (minObservations.isNumber()) {
+        config.minObservations = static_cast<int>(minObservations.asNumber());
+      }
+
+      auto trackTimeoutMs = options.getProperty(runtime, "trackTimeoutMs");
+      if (trackTimeoutMs.isNumber()) {
+        config.trackTimeoutMs = trackTimeoutMs.asNumber();
+      }
+
+      g_pipeline.plateTracker().configure(config);
+      return jsi::Value::undefined();
+    } catch (const std::exception& e) {
+      LOGE("Error in configurePlateTracker: %s", e.what());
+      throw jsi::JSError(runtime, std::string("Error in configurePlateTracker: ") + e.what());
+    }
+  };
+
+  auto getPlateTracks = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    return toJsPlateTracks(runtime, g_pipeline.plateTracker().activeTracks(FrameScheduler::nowMs()));
+  };
+
+  auto takeCompletedPlates = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    return toJsPlateTracks(runtime, g_pipeline.plateTracker().takeCompletedTracks(FrameScheduler::nowMs()));
+  };
+
+  auto getPlateTrackerStats = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    PlateTrackerStats stats = g_pipeline.plateTracker().stats();
+
+    jsi::Object result(runtime);
+    result.setProperty(runtime, "tracksStarted", static_cast<double>(stats.tracksStarted));
+    result.setProperty(runtime, "tracksConverged", static_cast<double>(stats.tracksConverged));
+    result.setProperty(runtime, "readsSkipped", static_cast<double>(stats.readsSkipped));
+    result.setProperty(runtime, "completedDropped", static_cast<double>(stats.completedDropped));
+    return result;
+  };
+
+  auto resetPlateTracker = [](jsi::Runtime& runtime, const jsi::Value& thisArg, const jsi::Value* args, size_t count) -> jsi::Value {
+    g_pipeline.plateTracker().reset();
+    return jsi::Value::undefined();
+  };
+
   using JSIHostFunction = std::function<jsi::Value(jsi::Runtime&, const jsi::Value&, const jsi::Value*, size_t)>;
 
   void addPluginFunction(jsi::Runtime& runtime, const std::string& funcName, JSIHostFunction func) {
@@ -383,7 +1298,7 @@ namespace visioncamerapluginanpr {
     runtime.global().setProperty(runtime, jsi::PropNameID::forUtf8(runtime, funcName), pluginFunc);
   }
 
-  void installPlugin(jsi::Runtime& runtime) {
+  void installPlugin(jsi::Runtime& runtime, std::shared_ptr<react::CallInvoker> callInvoker) {
     bool isInstalled = runtime.global().hasProperty(runtime, "initializeANPR");
 
     if(isInstalled) {
@@ -393,9 +1308,20 @@ namespace visioncamerapluginanpr {
     
     LOGI("Installing plugin...");
 
+    g_callInvoker = std::move(callInvoker);
+    g_pendingRecognitions = new PendingRecognitions();
+    g_pendingInitializations = new std::unordered_map<uint64_t, PendingInitialization>();
+    g_pendingBatches = new std::unordered_map<uint64_t, std::shared_ptr<PendingBatch>>();
+
     // Add initializeANPR
     addPluginFunction(runtime, "initializeANPR", initializeANPR);
 
+    // Add initializeANPRAsync
+    addPluginFunction(runtime, "initializeANPRAsync", initializeANPRAsync);
+
+    // Add getInitializationTimings
+    addPluginFunction(runtime, "getInitializationTimings", getInitializationTimings);
+
     // Add setTopN
     addPluginFunction(runtime, "setTopN", setTopN);
 
@@ -414,12 +1340,69 @@ namespace visioncamerapluginanpr {
     // Add setDefaultRegion
     addPluginFunction(runtime, "setDefaultRegion", setDefaultRegion);
 
+    // Add setPlateDetector
+    addPluginFunction(runtime, "setPlateDetector", setPlateDetector);
+
+    // Add setReducedJpegDecode
+    addPluginFunction(runtime, "setReducedJpegDecode", setReducedJpegDecode);
+
     // Add recognise
     addPluginFunction(runtime, "recognise", recognise);
 
     // Add recogniseFrame
     addPluginFunction(runtime, "recogniseFrame", recogniseFrame);
 
+    // Add recogniseFrameAsync
+    addPluginFunction(runtime, "recogniseFrameAsync", recogniseFrameAsync);
+
+    // Add recogniseAsync
+    addPluginFunction(runtime, "recogniseAsync", recogniseAsync);
+
+    // Add cancelRecognition
+    addPluginFunction(runtime, "cancelRecognition", cancelRecognition);
+
+    // Add recogniseBatch
+    addPluginFunction(runtime, "recogniseBatch", recogniseBatch);
+
+    // Add getLatestFrameResult
+    addPluginFunction(runtime, "getLatestFrameResult", getLatestFrameResult);
+
+    // Add getBufferPoolStats
+    addPluginFunction(runtime, "getBufferPoolStats", getBufferPoolStats);
+
+    // Add getANPRStats
+    addPluginFunction(runtime, "getANPRStats", getANPRStats);
+
+    // Add resetANPRStats
+    addPluginFunction(runtime, "resetANPRStats", resetANPRStats);
+
+    // Add configureFrameScheduler
+    addPluginFunction(runtime, "configureFrameScheduler", configureFrameScheduler);
+
+    // Add getFrameSchedulerStats
+    addPluginFunction(runtime, "getFrameSchedulerStats", getFrameSchedulerStats);
+
+    // Add getMotionGateStats
+    addPluginFunction(runtime, "getMotionGateStats", getMotionGateStats);
+
+    // Add resetMotionGate
+    addPluginFunction(runtime, "resetMotionGate", resetMotionGate);
+
+    // Add configurePlateTracker
+    addPluginFunction(runtime, "configurePlateTracker", configurePlateTracker);
+
+    // Add getPlateTracks
+    addPluginFunction(runtime, "getPlateTracks", getPlateTracks);
+
+    // Add takeCompletedPlates
+    addPluginFunction(runtime, "takeCompletedPlates", takeCompletedPlates);
+
+    // Add getPlateTrackerStats
+    addPluginFunction(runtime, "getPlateTrackerStats", getPlateTrackerStats);
+
+    // Add resetPlateTracker
+    addPluginFunction(runtime, "resetPlateTracker", resetPlateTracker);
+
     LOGI("Plugin installation complete");
   }
 }
\ No newline at end of file
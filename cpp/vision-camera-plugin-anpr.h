@@ -4,9 +4,20 @@
 #include <jsi/jsilib.h>
 #include <jsi/jsi.h>
 
+#include <memory>
+
+namespace facebook {
+  namespace react {
+    class CallInvoker;
+  }
+}
+
 namespace visioncamerapluginanpr {
-  void installPlugin(facebook::jsi::Runtime& jsiRuntime);
+  // `callInvoker` runs work on the JS thread; recogniseAsync settles its Promises through it
+  void installPlugin(facebook::jsi::Runtime& jsiRuntime, std::shared_ptr<facebook::react::CallInvoker> callInvoker);
   void setAlprPaths(const char* configPath, const char* runtimePath);
+  // Packed runtime data, extracted into `directory` the first time the engines load after its version changed
+  void setRuntimeBundle(const char* bundlePath, const char* directory);
 }
 
 #endif /* VISIONCAMERAPLUGINANPR_H */
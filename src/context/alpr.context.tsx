@@ -12,6 +12,9 @@ interface ALPRProviderProps {
     country: string;
     topN: number;
     region?: string;
+    engines?: number;
+    // Warm the engines up on a synthetic frame while they load
+    warmUp?: boolean;
   };
 }
 
@@ -21,10 +24,12 @@ export const ALPRContext = createContext<ALPRContextType | null>(null);
 
 export const ALPRProvider: FC<ALPRProviderProps> = ({
   children,
-  config: { country, topN, region },
+  config: { country, topN, region, engines, warmUp },
 }) => {
   useEffect(() => {
-    alprService.initialize(country, topN, region);
+    alprService
+      .initialize(country, topN, region, engines, { warmUp })
+      .catch((e) => console.error(e));
 
     // TD: return cleanup function
     // return () => { ... }
@@ -1,4 +1,5 @@
 import { ALPRProvider } from './context/alpr.context';
 import { useALPR } from './hooks/useALPR';
+import { decodeAlprResults } from './services/results.decoder';
 
-export { ALPRProvider, useALPR };
+export { ALPRProvider, useALPR, decodeAlprResults };
@@ -1,49 +1,134 @@
-import type { AlprRegionOfInterest } from '../types/global';
+import type {
+  ANPRStats,
+  AlprRegionOfInterest,
+  BatchResult,
+  BufferPoolStats,
+  FrameSchedulerConfig,
+  FrameSchedulerStats,
+  InitializationTimings,
+  InitializeOptions,
+  MotionGateStats,
+  PlateDetector,
+  PlateTrack,
+  PlateTrackerConfig,
+  PlateTrackerStats,
+  BinaryResultOptions,
+  ObjectResultOptions,
+  RecogniseOptions,
+  ResultOptions,
+} from '../types/global';
+import type { AlprResults } from '../types/openalpr';
 import { installPlugin } from '../plugin';
 
-type queueMethod = () => void;
+type queueMethod = {
+  run: () => void;
+  // Called instead of run when initialization fails
+  fail: (error: unknown) => void;
+};
+
+const isResultOptions = (value: unknown): value is ResultOptions =>
+  typeof value === 'object' && value !== null && !Array.isArray(value);
 
 export class ALPRService {
   private isInitialized: boolean = false;
   private methodQueue: queueMethod[] = [];
+  private initialization: Promise<InitializationTimings> | null = null;
 
   constructor() {
     installPlugin();
 
     // Bind context for overloaded methods
     this.recognise = this.recognise.bind(this);
+    this.recogniseBatch = this.recogniseBatch.bind(this);
   }
 
-  private queueOrExectute = (method: queueMethod) => {
+  private queueOrExectute = (method: () => void) => {
     if (this.isInitialized) {
       method();
     } else {
-      this.methodQueue.push(method);
+      this.methodQueue.push({ run: method, fail: () => {} });
     }
   };
 
   private queueOrExecuteAsync = <T>(method: () => T): Promise<T> => {
-    return new Promise((resolve) => {
+    return new Promise((resolve, reject) => {
       if (this.isInitialized) {
         resolve(method());
       } else {
-        this.methodQueue.push(() => resolve(method()));
+        this.methodQueue.push({
+          run: () => {
+            try {
+              resolve(method());
+            } catch (e) {
+              reject(e);
+            }
+          },
+          fail: reject,
+        });
       }
     });
   };
 
+  // Each queued call runs once: the queue is swapped out before it is drained, and calls queued while it drains
+  // run after it, in order
   private runMethodQueue = () => {
-    this.methodQueue.forEach((method) => {
-      method();
-    });
+    while (this.methodQueue.length > 0) {
+      const queue = this.methodQueue;
+      this.methodQueue = [];
+      queue.forEach((method) => {
+        method.run();
+      });
+    }
     this.isInitialized = true;
   };
 
-  // Initialize OpenALPR with country
-  initialize = (country: string, topN?: number, region?: string) => {
-    if (global.initializeANPR) {
-      global.initializeANPR(country, topN, region);
-      this.runMethodQueue();
+  private rejectMethodQueue = (error: unknown) => {
+    const queue = this.methodQueue;
+    this.methodQueue = [];
+    queue.forEach((method) => {
+      method.fail(error);
+    });
+  };
+
+  // Initialize OpenALPR with country. `engines` independent engines let recognitions run concurrently.
+  // The engines load on a native background thread; calls made meanwhile are queued until they are ready.
+  // Pass { warmUp: true } to warm every engine up on a synthetic frame before the Promise resolves.
+  // Calls made while the engines are loading get the same Promise; if loading fails, queued calls reject with its error.
+  initialize = (
+    country: string,
+    topN?: number,
+    region?: string,
+    engines?: number,
+    options?: InitializeOptions
+  ): Promise<InitializationTimings> => {
+    if (!global.initializeANPRAsync) {
+      return Promise.reject(new Error('Plugin not installed'));
+    }
+
+    if (!this.initialization) {
+      this.initialization = global
+        .initializeANPRAsync(country, topN, region, engines, options)
+        .then(
+          (timings) => {
+            this.initialization = null;
+            this.runMethodQueue();
+            return timings;
+          },
+          (error) => {
+            this.initialization = null;
+            this.rejectMethodQueue(error);
+            throw error;
+          }
+        );
+    }
+    return this.initialization;
+  };
+
+  // Where the engines' cold start went, including the time to the first result once there is one.
+  // Null until the engines are ready.
+  getInitializationTimings = (): InitializationTimings | null => {
+    if (global.getInitializationTimings) {
+      return global.getInitializationTimings();
     } else {
       throw new Error('Plugin not installed');
     }
@@ -120,49 +205,172 @@ export class ALPRService {
     });
   };
 
-  // Keeping recognise methods unchanged
-  async recognise(filePath: string): Promise<string>;
-  async recognise(imgBytes: ArrayBuffer): Promise<string>;
+  // Choose the plate detector; 'lbp' unless set. Takes effect on each engine's next detection.
+  setPlateDetector = (detector: PlateDetector) => {
+    if (global.setPlateDetector) {
+      global.setPlateDetector(detector);
+    } else {
+      throw new Error('Plugin not installed');
+    }
+  };
+
+  // Find plates in large JPEG files and bytes on a reduced decode, and decode them at full
+  // size only to read the plates found. Much faster, but can find different plates; off unless set.
+  setReducedJpegDecode = (enabled: boolean) => {
+    if (global.setReducedJpegDecode) {
+      global.setReducedJpegDecode(enabled);
+    } else {
+      throw new Error('Plugin not installed');
+    }
+  };
+
+  // Recognises file paths and encoded image bytes across all engines at once, off the JS thread.
+  // Results are in input order; an image that fails carries an error instead of a result. An
+  // ArrayBuffer must not be changed until the returned Promise settles.
+  async recogniseBatch(
+    inputs: (string | ArrayBuffer)[],
+    options: ObjectResultOptions
+  ): Promise<BatchResult<AlprResults>[]>;
+  async recogniseBatch(
+    inputs: (string | ArrayBuffer)[],
+    options: Pick<BinaryResultOptions, 'output'>
+  ): Promise<BatchResult<ArrayBuffer>[]>;
+  async recogniseBatch(
+    inputs: (string | ArrayBuffer)[],
+    options?: ResultOptions
+  ): Promise<BatchResult[]>;
+  async recogniseBatch(
+    inputs: (string | ArrayBuffer)[],
+    options?: ResultOptions
+  ): Promise<BatchResult<string | AlprResults | ArrayBuffer>[]> {
+    return this.queueOrExecuteAsync(() => {
+      if (!global.recogniseBatch) {
+        throw new Error('OpenALPR is not initialized');
+      }
+
+      return global.recogniseBatch(inputs, options);
+    });
+  }
+
+  private nextRequestId = 1;
+
+  // Runs the native recogniseAsync, cancelling it when `signal` aborts
+  private recogniseOffThread = (
+    input: string | ArrayBuffer,
+    args: (AlprRegionOfInterest[] | number)[],
+    options?: ResultOptions & RecogniseOptions
+  ): Promise<string | AlprResults | ArrayBuffer> => {
+    const { signal, ...resultOptions }: ResultOptions & RecogniseOptions =
+      options ?? {};
+    if (signal?.aborted) {
+      return Promise.reject(new Error('Recognition cancelled'));
+    }
+
+    const requestId = this.nextRequestId++;
+    const onAbort = () => global.cancelRecognition(requestId);
+    signal?.addEventListener('abort', onAbort);
+
+    return global
+      .recogniseAsync(input, ...args, { ...resultOptions, requestId })
+      .finally(() => signal?.removeEventListener('abort', onAbort));
+  };
+
+  // Recognition runs on native engine threads, so the JS thread stays free while it does.
+  // Pass an AbortSignal as `signal` to cancel it.
+  async recognise(
+    filePath: string,
+    options: ObjectResultOptions & RecogniseOptions
+  ): Promise<AlprResults>;
+  async recognise(
+    filePath: string,
+    options: BinaryResultOptions & RecogniseOptions
+  ): Promise<ArrayBuffer>;
+  async recognise(
+    filePath: string,
+    options?: ResultOptions & RecogniseOptions
+  ): Promise<string>;
+  async recognise(
+    imgBytes: ArrayBuffer,
+    options: ObjectResultOptions & RecogniseOptions
+  ): Promise<AlprResults>;
+  async recognise(
+    imgBytes: ArrayBuffer,
+    options: BinaryResultOptions & RecogniseOptions
+  ): Promise<ArrayBuffer>;
+  async recognise(
+    imgBytes: ArrayBuffer,
+    options?: ResultOptions & RecogniseOptions
+  ): Promise<string>;
+  async recognise(
+    imageBytes: ArrayBuffer,
+    regionsOfInterest: AlprRegionOfInterest[],
+    options: ObjectResultOptions & RecogniseOptions
+  ): Promise<AlprResults>;
   async recognise(
     imageBytes: ArrayBuffer,
-    regionsOfInterest: AlprRegionOfInterest[]
+    regionsOfInterest: AlprRegionOfInterest[],
+    options: BinaryResultOptions & RecogniseOptions
+  ): Promise<ArrayBuffer>;
+  async recognise(
+    imageBytes: ArrayBuffer,
+    regionsOfInterest: AlprRegionOfInterest[],
+    options?: ResultOptions & RecogniseOptions
   ): Promise<string>;
   async recognise(
     pixelData: ArrayBuffer,
     imgWidth: number,
     imgHeight: number,
-    regionsOfInterest: AlprRegionOfInterest[]
+    regionsOfInterest: AlprRegionOfInterest[],
+    options: ObjectResultOptions & RecogniseOptions
+  ): Promise<AlprResults>;
+  async recognise(
+    pixelData: ArrayBuffer,
+    imgWidth: number,
+    imgHeight: number,
+    regionsOfInterest: AlprRegionOfInterest[],
+    options: BinaryResultOptions & RecogniseOptions
+  ): Promise<ArrayBuffer>;
+  async recognise(
+    pixelData: ArrayBuffer,
+    imgWidth: number,
+    imgHeight: number,
+    regionsOfInterest: AlprRegionOfInterest[],
+    options?: ResultOptions & RecogniseOptions
   ): Promise<string>;
   async recognise(
     arg1: string | ArrayBuffer,
-    arg2?: AlprRegionOfInterest[] | number,
-    arg3?: number,
-    arg4?: AlprRegionOfInterest[]
-  ): Promise<string> {
-    return this.queueOrExecuteAsync<string>(() => {
-      if (!global.recognise) {
+    arg2?: AlprRegionOfInterest[] | number | (ResultOptions & RecogniseOptions),
+    arg3?: number | (ResultOptions & RecogniseOptions),
+    arg4?: AlprRegionOfInterest[],
+    arg5?: ResultOptions & RecogniseOptions
+  ): Promise<string | AlprResults | ArrayBuffer> {
+    return this.queueOrExecuteAsync(() => {
+      if (!global.recogniseAsync) {
         throw new Error('OpenALPR is not initialized');
       }
 
+      const options = isResultOptions(arg2) ? arg2 : undefined;
+
       // Recognise from file path
       if (typeof arg1 === 'string') {
-        if (global.recognise) {
-          return global.recognise(arg1);
-        }
+        return this.recogniseOffThread(arg1, [], options);
       }
 
       // Recognise from image bytes (simple byte array)
-      if (arg1 instanceof ArrayBuffer && typeof arg2 === 'undefined') {
-        if (global.recognise) {
-          return global.recognise(arg1);
-        }
+      if (
+        arg1 instanceof ArrayBuffer &&
+        (typeof arg2 === 'undefined' || options)
+      ) {
+        return this.recogniseOffThread(arg1, [], options);
       }
 
       // Recognise from image bytes with regions of interest
       if (arg1 instanceof ArrayBuffer && Array.isArray(arg2)) {
-        if (global.recognise) {
-          return global.recognise(arg1, arg2 as AlprRegionOfInterest[]);
-        }
+        return this.recogniseOffThread(
+          arg1,
+          [arg2 as AlprRegionOfInterest[]],
+          isResultOptions(arg3) ? arg3 : undefined
+        );
       }
 
       // Recognise from raw pixel data
@@ -172,20 +380,146 @@ export class ALPRService {
         typeof arg3 === 'number' &&
         Array.isArray(arg4)
       ) {
-        if (global.recognise) {
-          return global.recognise(arg1, arg2, arg3, arg4);
-        }
+        return this.recogniseOffThread(arg1, [arg2, arg3, arg4], arg5);
       }
 
       throw new Error('Invalid arguments passed to recognise');
     });
   }
 
-  get recogniseFrame(): (frame: any) => string {
+  // Returns null when the frame scheduler skips the frame.
+  // Pass { output: 'object' } for a native results object, or { output: 'binary' } for a packed ArrayBuffer,
+  // instead of a JSON string
+  get recogniseFrame(): typeof global.recogniseFrame {
     if (global.recogniseFrame) {
       return global.recogniseFrame;
     } else {
       throw new Error('OpenALPR is not initialized');
     }
   }
+
+  // Queues a frame for recognition on a native worker and returns its frame id immediately.
+  // Only the newest queued frame is kept; older pending frames are dropped.
+  // Returns null when the frame scheduler skips the frame.
+  get recogniseFrameAsync(): typeof global.recogniseFrameAsync {
+    if (global.recogniseFrameAsync) {
+      return global.recogniseFrameAsync;
+    } else {
+      throw new Error('OpenALPR is not initialized');
+    }
+  }
+
+  // Returns the newest completed async frame result, or null if none has completed since the last call
+  get getLatestFrameResult(): typeof global.getLatestFrameResult {
+    if (global.getLatestFrameResult) {
+      return global.getLatestFrameResult;
+    } else {
+      throw new Error('OpenALPR is not initialized');
+    }
+  }
+
+  // Limits which camera frames are recognised, by frame rate, CPU duty cycle or recent latency
+  configureFrameScheduler = (config: FrameSchedulerConfig) => {
+    if (global.configureFrameScheduler) {
+      global.configureFrameScheduler(config);
+    } else {
+      throw new Error('Plugin not installed');
+    }
+  };
+
+  // How many frames the scheduler processed and skipped, by reason, and recent latency percentiles
+  getFrameSchedulerStats = (): FrameSchedulerStats => {
+    if (global.getFrameSchedulerStats) {
+      return global.getFrameSchedulerStats();
+    } else {
+      throw new Error('Plugin not installed');
+    }
+  };
+
+  // How many frames the motion gate checked, and how many of them were static
+  getMotionGateStats = (): MotionGateStats => {
+    if (global.getMotionGateStats) {
+      return global.getMotionGateStats();
+    } else {
+      throw new Error('Plugin not installed');
+    }
+  };
+
+  // Forgets the learned background, e.g. after the camera was moved
+  resetMotionGate = () => {
+    if (global.resetMotionGate) {
+      global.resetMotionGate();
+    } else {
+      throw new Error('Plugin not installed');
+    }
+  };
+
+  // Association and convergence settings for frames recognised with { track: true }
+  configurePlateTracker = (config: PlateTrackerConfig) => {
+    if (global.configurePlateTracker) {
+      global.configurePlateTracker(config);
+    } else {
+      throw new Error('Plugin not installed');
+    }
+  };
+
+  // Plates currently being tracked
+  get getPlateTracks(): () => PlateTrack[] {
+    if (global.getPlateTracks) {
+      return global.getPlateTracks;
+    } else {
+      throw new Error('Plugin not installed');
+    }
+  }
+
+  // One consolidated result per vehicle: each track once, when it converges or leaves the view
+  get takeCompletedPlates(): () => PlateTrack[] {
+    if (global.takeCompletedPlates) {
+      return global.takeCompletedPlates;
+    } else {
+      throw new Error('Plugin not installed');
+    }
+  }
+
+  getPlateTrackerStats = (): PlateTrackerStats => {
+    if (global.getPlateTrackerStats) {
+      return global.getPlateTrackerStats();
+    } else {
+      throw new Error('Plugin not installed');
+    }
+  };
+
+  resetPlateTracker = () => {
+    if (global.resetPlateTracker) {
+      global.resetPlateTracker();
+    } else {
+      throw new Error('Plugin not installed');
+    }
+  };
+
+  // Native frame buffer pool usage, including its high-water mark
+  getBufferPoolStats = (): BufferPoolStats => {
+    if (global.getBufferPoolStats) {
+      return global.getBufferPoolStats();
+    } else {
+      throw new Error('Plugin not installed');
+    }
+  };
+
+  // Frame and image throughput, latency histograms and buffer usage since the last reset
+  getANPRStats = (): ANPRStats => {
+    if (global.getANPRStats) {
+      return global.getANPRStats();
+    } else {
+      throw new Error('Plugin not installed');
+    }
+  };
+
+  resetANPRStats = () => {
+    if (global.resetANPRStats) {
+      global.resetANPRStats();
+    } else {
+      throw new Error('Plugin not installed');
+    }
+  };
 }
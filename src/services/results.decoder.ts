@@ -0,0 +1,169 @@
+import type {
+  AlprChar,
+  AlprCoordinate,
+  AlprPlate,
+  AlprPlateResult,
+  AlprResults,
+} from '../types/openalpr';
+
+// Reader for the packed AlprResults encoding written by ResultEncoder (cpp/result-encoding.h).
+// The layout is documented there; keep both sides in sync.
+const MAGIC = 0x52504c41;
+const VERSION = 1;
+const REGION_SIZE = 8;
+const PLATE_SIZE = 52;
+const CANDIDATE_SIZE = 16;
+const CHAR_SIZE = 24;
+
+// Hermes has no TextDecoder, so strings are decoded by hand
+const decodeUtf8 = (bytes: Uint8Array, start: number, end: number): string => {
+  'worklet';
+  let result = '';
+  let i = start;
+
+  while (i < end) {
+    const byte = bytes[i++]!;
+    let codePoint = byte;
+
+    if (byte >= 0xf0) {
+      codePoint =
+        ((byte & 0x07) << 18) |
+        ((bytes[i++]! & 0x3f) << 12) |
+        ((bytes[i++]! & 0x3f) << 6) |
+        (bytes[i++]! & 0x3f);
+    } else if (byte >= 0xe0) {
+      codePoint =
+        ((byte & 0x0f) << 12) |
+        ((bytes[i++]! & 0x3f) << 6) |
+        (bytes[i++]! & 0x3f);
+    } else if (byte >= 0xc0) {
+      codePoint = ((byte & 0x1f) << 6) | (bytes[i++]! & 0x3f);
+    }
+
+    result += String.fromCodePoint(codePoint);
+  }
+
+  return result;
+};
+
+const readCorners = (
+  view: DataView,
+  offset: number
+): [AlprCoordinate, AlprCoordinate, AlprCoordinate, AlprCoordinate] => {
+  'worklet';
+  const corner = (index: number): AlprCoordinate => ({
+    x: view.getInt16(offset + index * 4, true),
+    y: view.getInt16(offset + index * 4 + 2, true),
+  });
+
+  return [corner(0), corner(1), corner(2), corner(3)];
+};
+
+// Decodes results returned with { output: 'binary' }. Throws if the buffer is not a valid encoding.
+export const decodeAlprResults = (buffer: ArrayBuffer): AlprResults => {
+  'worklet';
+  const view = new DataView(buffer);
+  const bytes = new Uint8Array(buffer);
+
+  if (
+    buffer.byteLength < 56 ||
+    view.getUint32(0, true) !== MAGIC ||
+    view.getUint16(4, true) !== VERSION
+  ) {
+    throw new Error('Not an encoded AlprResults buffer');
+  }
+
+  const headerSize = view.getUint16(6, true);
+  if (headerSize < 56) {
+    throw new Error('Invalid AlprResults header size');
+  }
+  const plateCount = view.getUint16(8, true);
+  const roiCount = view.getUint16(10, true);
+  const candidateCount = view.getUint32(12, true);
+  const charCount = view.getUint32(16, true);
+  const totalSize = view.getUint32(52, true);
+
+  if (totalSize > buffer.byteLength) {
+    throw new Error('Truncated AlprResults buffer');
+  }
+
+  const roiOffset = headerSize;
+  const plateOffset = roiOffset + roiCount * REGION_SIZE;
+  const candidateOffset = plateOffset + plateCount * PLATE_SIZE;
+  const charOffset = candidateOffset + candidateCount * CANDIDATE_SIZE;
+  const stringOffset = charOffset + charCount * CHAR_SIZE;
+
+  const readString = (offset: number): string => {
+    const start = stringOffset + offset;
+    const length = view.getUint16(start, true);
+    return decodeUtf8(bytes, start + 2, start + 2 + length);
+  };
+
+  const readCandidate = (index: number): AlprPlate => {
+    const record = candidateOffset + index * CANDIDATE_SIZE;
+    const firstChar = view.getUint32(record + 8, true);
+    const count = view.getUint16(record + 12, true);
+
+    const characterDetails: AlprChar[] = [];
+    for (let i = 0; i < count; i++) {
+      const charRecord = charOffset + (firstChar + i) * CHAR_SIZE;
+      characterDetails.push({
+        corners: readCorners(view, charRecord),
+        confidence: view.getFloat32(charRecord + 16, true),
+        character: readString(view.getUint32(charRecord + 20, true)),
+      });
+    }
+
+    return {
+      characters: readString(view.getUint32(record, true)),
+      overall_confidence: view.getFloat32(record + 4, true),
+      character_details: characterDetails,
+      matches_template: bytes[record + 14] !== 0,
+    };
+  };
+
+  const regionsOfInterest = [];
+  for (let i = 0; i < roiCount; i++) {
+    const record = roiOffset + i * REGION_SIZE;
+    regionsOfInterest.push({
+      x: view.getInt16(record, true),
+      y: view.getInt16(record + 2, true),
+      width: view.getInt16(record + 4, true),
+      height: view.getInt16(record + 6, true),
+    });
+  }
+
+  const plates: AlprPlateResult[] = [];
+  for (let i = 0; i < plateCount; i++) {
+    const record = plateOffset + i * PLATE_SIZE;
+    const firstCandidate = view.getUint32(record + 44, true);
+    const topNCount = view.getUint32(record + 48, true);
+
+    const topNPlates: AlprPlate[] = [];
+    for (let j = 0; j < topNCount; j++) {
+      topNPlates.push(readCandidate(firstCandidate + j));
+    }
+
+    plates.push({
+      plate_points: readCorners(view, record),
+      processing_time_ms: view.getFloat32(record + 16, true),
+      requested_topn: view.getInt32(record + 20, true),
+      plate_index: view.getInt32(record + 24, true),
+      regionConfidence: view.getInt32(record + 28, true),
+      country: readString(view.getUint32(record + 32, true)),
+      region: readString(view.getUint32(record + 36, true)),
+      bestPlate: readCandidate(view.getUint32(record + 40, true)),
+      topNPlates,
+    });
+  }
+
+  return {
+    img_width: view.getInt32(24, true),
+    img_height: view.getInt32(28, true),
+    epoch_time: view.getFloat64(32, true),
+    frame_number: view.getFloat64(40, true),
+    total_processing_time_ms: view.getFloat32(48, true),
+    plates,
+    regionsOfInterest,
+  };
+};
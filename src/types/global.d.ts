@@ -1,4 +1,5 @@
 import { Frame } from 'react-native-vision-camera';
+import type { AlprResults } from './openalpr';
 
 export interface AlprRegionOfInterest {
   x: number;
@@ -7,13 +8,211 @@ export interface AlprRegionOfInterest {
   height: number;
 }
 
+export interface BufferPoolStats {
+  bytesInUse: number;
+  bytesCached: number;
+  highWaterMark: number;
+  allocations: number;
+  reuses: number;
+}
+
+// Bucket of a latency histogram; upperMs is null on the last bucket, which takes everything slower
+export interface LatencyBucket {
+  upperMs: number | null;
+  count: number;
+}
+
+export interface LatencyHistogram {
+  buckets: LatencyBucket[];
+  // Upper bounds of the buckets holding the 50th and 95th percentiles
+  p50Ms: number;
+  p95Ms: number;
+}
+
+export interface ANPRStats {
+  framesReceived: number;
+  framesProcessed: number;
+  // Skipped by the scheduler or motion gate, or replaced before the async worker read them
+  framesDropped: number;
+  imagesProcessed: number;
+  platesFound: number;
+  // Plate regions read after detecting them first (tracking, decimated detection, timing)
+  ocrCalls: number;
+  averageCandidatesPerFrame: number;
+  frameLatency: LatencyHistogram;
+  imageLatency: LatencyHistogram;
+  bufferBytesInUse: number;
+  bufferBytesCached: number;
+  bufferHighWaterMark: number;
+}
+
+export interface StageTiming {
+  ms: number;
+  runs: number;
+}
+
+export interface InitializeOptions {
+  // Recognise a synthetic frame on every engine before resolving, so the first
+  // real recognition does not pay for loading model pages and caches
+  warmUp?: boolean;
+}
+
+// Where one engine's cold start went
+export interface EngineLoadTiming {
+  // OpenALPR loads its config, cascade, OCR data and patterns in one constructor
+  constructMs: number;
+  warmUpMs: number;
+  // detection, plateDetector and the reading stages of the warm-up pass
+  warmUpStages: Record<string, StageTiming>;
+}
+
+export interface InitializationTimings {
+  // Extracting the packed runtime data, which only writes files when it changed
+  bundleMs: number;
+  engines: EngineLoadTiming[];
+  // From the start of initialization until every engine was ready
+  totalMs: number;
+  // From the start of initialization until the first recognition returned,
+  // or 0 until one has
+  firstResultMs: number;
+}
+
+// Detector that finds plates before they are read. 'openalpr' is the library's own, which parses the region
+// cascade for every engine; 'lbp' shares one cascade across engines and finds the same plates; 'lbpVector'
+// does too, evaluating several windows at once with NEON/SSE.
+export type PlateDetector = 'openalpr' | 'lbp' | 'lbpVector';
+
+// 'json' returns results as a JSON string, 'object' as a native object whose fields are read lazily,
+// and 'binary' as a packed ArrayBuffer read with decodeAlprResults
+export type ResultOutput = 'json' | 'object' | 'binary';
+
+export interface ResultOptions {
+  output?: ResultOutput;
+  // Attach a per-stage timing breakdown as `timing` to 'json' and 'object' results. The
+  // plates found are the same either way. Candidates are only timed one by one where the
+  // plugin detects plates before reading them, such as for tracked frames.
+  timing?: boolean;
+}
+
+export interface RecogniseOptions {
+  // Rejects the recognition with 'Recognition cancelled' when aborted. Work an engine
+  // has not started yet is skipped; a recognition already running finishes unseen.
+  signal?: AbortSignal;
+}
+
+// Options understood by the native recogniseAsync; requestId is what cancelRecognition takes
+export type AsyncResultOptions = ResultOptions & { requestId?: number };
+
+export interface ObjectResultOptions {
+  output: 'object';
+  timing?: boolean;
+}
+
+export interface BinaryResultOptions {
+  output: 'binary';
+  // Written into when large enough, instead of allocating a new ArrayBuffer per result
+  buffer?: ArrayBuffer;
+}
+
+export interface FrameResult<T = string> {
+  frameId: number;
+  result?: T;
+  error?: string;
+}
+
+export interface BatchResult<T = string> {
+  result?: T;
+  // Why this image could not be read or recognised; the rest of the batch is unaffected
+  error?: string;
+}
+
+export interface FrameOptions {
+  // Skip frames in which nothing moved, and only search the moving region of the rest.
+  // Meant for fixed cameras; call resetMotionGate after the camera moves.
+  motionGate?: boolean;
+  // Follow plates across frames and return one consensus reading per vehicle.
+  // Plates whose track has converged are not read again.
+  track?: boolean;
+  // Areas to search, in the frame's own width x height coordinates before it is turned upright.
+  // Only these are read; plates are still reported in upright frame coordinates.
+  regionsOfInterest?: AlprRegionOfInterest[];
+  // Detect plates on a copy reduced to max_detection_input_width/height and read
+  // only the detected plates at full resolution. Cuts ingest cost on 4K frames.
+  // recogniseFrame only; frames queued with recogniseFrameAsync are copied whole.
+  decimatedDetection?: boolean;
+}
+
+export interface PlateTrackerConfig {
+  // Plates overlapping a track by at least this much belong to it
+  minIoU?: number;
+  // Plates that moved further still match a track if their reading is this close
+  maxEditDistance?: number;
+  // Consensus confidence at which a track stops being read
+  convergedConfidence?: number;
+  // Frames a track must be read in before it can converge
+  minObservations?: number;
+  // Tracks not seen for this long are finished
+  trackTimeoutMs?: number;
+}
+
+export interface PlateTrack {
+  id: number;
+  // JSON of the consensus plate result
+  plate: string;
+  observations: number;
+  converged: boolean;
+  firstSeenMs: number;
+  lastSeenMs: number;
+}
+
+export interface PlateTrackerStats {
+  tracksStarted: number;
+  tracksConverged: number;
+  readsSkipped: number;
+  // Completed tracks discarded because takeCompletedPlates was not called often enough
+  completedDropped: number;
+}
+
+export interface MotionGateStats {
+  framesChecked: number;
+  framesStatic: number;
+}
+
+export interface FrameSchedulerConfig {
+  // Upper bound on frames recognised per second; 0 disables it
+  maxFps?: number;
+  // Fraction of time recognition may take up, in (0, 1]; 1 disables it
+  maxDutyCycle?: number;
+  // Back off while p95 latency is above this; 0 disables it
+  targetLatencyMs?: number;
+}
+
+export interface FrameSchedulerStats {
+  processed: number;
+  skippedFrameRate: number;
+  skippedDutyCycle: number;
+  skippedLatency: number;
+  p50LatencyMs: number;
+  p95LatencyMs: number;
+  latencySamples: number;
+}
+
 // global.d.ts
 declare global {
   function initializeANPR(
     country: string,
     topN?: number,
-    region?: string
+    region?: string,
+    engines?: number
   ): void;
+  function initializeANPRAsync(
+    country: string,
+    topN?: number,
+    region?: string,
+    engines?: number,
+    options?: InitializeOptions
+  ): Promise<InitializationTimings>;
+  function getInitializationTimings(): InitializationTimings | null;
   function setCountry(country: string): void;
   function setPrewarp(prewarpConfig: string): void;
   function setMask(
@@ -25,19 +224,115 @@ declare global {
   function setDetectRegion(detectRegion: Boolean): void;
   function setTopN(topN: number): void;
   function setDefaultRegion(region: string): void;
-  function recognise(filePath: string): string;
-  function recognise(imgBytes: ArrayBuffer): string;
+  function setPlateDetector(detector: PlateDetector): void;
+  function setReducedJpegDecode(enabled: boolean): void;
+  // Invalid arguments throw; a recognition that fails returns 'Error during recognition: <reason>'
+  function recognise(
+    filePath: string,
+    options: ObjectResultOptions
+  ): AlprResults;
+  function recognise(
+    filePath: string,
+    options: BinaryResultOptions
+  ): ArrayBuffer;
+  function recognise(filePath: string, options?: ResultOptions): string;
+  function recognise(
+    imgBytes: ArrayBuffer,
+    options: ObjectResultOptions
+  ): AlprResults;
+  function recognise(
+    imgBytes: ArrayBuffer,
+    options: BinaryResultOptions
+  ): ArrayBuffer;
+  function recognise(imgBytes: ArrayBuffer, options?: ResultOptions): string;
+  function recognise(
+    imageBytes: ArrayBuffer,
+    regionsOfInterest: AlprRegionOfInterest[],
+    options: ObjectResultOptions
+  ): AlprResults;
+  function recognise(
+    imageBytes: ArrayBuffer,
+    regionsOfInterest: AlprRegionOfInterest[],
+    options: BinaryResultOptions
+  ): ArrayBuffer;
   function recognise(
     imageBytes: ArrayBuffer,
-    regionsOfInterest: AlprRegionOfInterest[]
+    regionsOfInterest: AlprRegionOfInterest[],
+    options?: ResultOptions
   ): string;
   function recognise(
     pixelData: ArrayBuffer,
     imgWidth: number,
     imgHeight: number,
-    regionsOfInterest: AlprRegionOfInterest[]
+    regionsOfInterest: AlprRegionOfInterest[],
+    options: ObjectResultOptions
+  ): AlprResults;
+  function recognise(
+    pixelData: ArrayBuffer,
+    imgWidth: number,
+    imgHeight: number,
+    regionsOfInterest: AlprRegionOfInterest[],
+    options: BinaryResultOptions
+  ): ArrayBuffer;
+  function recognise(
+    pixelData: ArrayBuffer,
+    imgWidth: number,
+    imgHeight: number,
+    regionsOfInterest: AlprRegionOfInterest[],
+    options?: ResultOptions
   ): string;
-  function recogniseFrame(frame: Frame): string;
+  function recogniseFrame(
+    frame: Frame,
+    options: FrameOptions & ObjectResultOptions
+  ): AlprResults | null;
+  function recogniseFrame(
+    frame: Frame,
+    options: FrameOptions & BinaryResultOptions
+  ): ArrayBuffer | null;
+  function recogniseFrame(
+    frame: Frame,
+    options?: FrameOptions & ResultOptions
+  ): string | null;
+  function recogniseFrameAsync(
+    frame: Frame,
+    options?: FrameOptions & Pick<ResultOptions, 'timing'>
+  ): number | null;
+  function recogniseAsync(
+    input: string | ArrayBuffer,
+    ...args: (AlprRegionOfInterest[] | number | AsyncResultOptions | undefined)[]
+  ): Promise<string | AlprResults | ArrayBuffer>;
+  function cancelRecognition(requestId: number): boolean;
+  function recogniseBatch(
+    inputs: (string | ArrayBuffer)[],
+    options: ObjectResultOptions
+  ): Promise<BatchResult<AlprResults>[]>;
+  function recogniseBatch(
+    inputs: (string | ArrayBuffer)[],
+    options: Pick<BinaryResultOptions, 'output'>
+  ): Promise<BatchResult<ArrayBuffer>[]>;
+  function recogniseBatch(
+    inputs: (string | ArrayBuffer)[],
+    options?: ResultOptions
+  ): Promise<BatchResult[]>;
+  function getLatestFrameResult(
+    options: ObjectResultOptions
+  ): FrameResult<AlprResults> | null;
+  function getLatestFrameResult(
+    options: BinaryResultOptions
+  ): FrameResult<ArrayBuffer> | null;
+  function getLatestFrameResult(options?: ResultOptions): FrameResult | null;
+  function getBufferPoolStats(): BufferPoolStats;
+  function getANPRStats(): ANPRStats;
+  function resetANPRStats(): void;
+  function configureFrameScheduler(config: FrameSchedulerConfig): void;
+  function getFrameSchedulerStats(): FrameSchedulerStats;
+  function getMotionGateStats(): MotionGateStats;
+  function resetMotionGate(): void;
+  function configurePlateTracker(config: PlateTrackerConfig): void;
+  function getPlateTracks(): PlateTrack[];
+  function takeCompletedPlates(): PlateTrack[];
+  function getPlateTrackerStats(): PlateTrackerStats;
+  function resetPlateTracker(): void;
   __turboModuleProxy;
 }
 
@@ -1,22 +1,22 @@
-interface AlprCoordinate {
+export interface AlprCoordinate {
   x: number;
   y: number;
 }
 
-interface AlprChar {
+export interface AlprChar {
   corners: [AlprCoordinate, AlprCoordinate, AlprCoordinate, AlprCoordinate];
   confidence: number;
   character: string;
 }
 
-interface AlprPlate {
+export interface AlprPlate {
   characters: string;
   overall_confidence: number;
   character_details: AlprChar[];
   matches_template: boolean;
 }
 
-interface AlprPlateResult {
+export interface AlprPlateResult {
   requested_topn: number;
   country: string;
   bestPlate: AlprPlate;
@@ -33,7 +33,32 @@ interface AlprPlateResult {
   region: string;
 }
 
-interface AlprResults {
+// Time spent in one stage, summed over every time it ran. Stages include decode, rotate, detection,
+// characterAnalysis, thresholds, plateLines, plateCorners, segmentation, ocr and postProcess.
+export interface StageTiming {
+  ms: number;
+  runs: number;
+}
+
+export interface CandidateTiming {
+  region: AlprRegionOfInterest;
+  // Index of the plate read from the region, or -1 if it was rejected.
+  // Tracked frames report consensus plates, which this index does not refer to.
+  plateIndex: number;
+  stages: Record<string, StageTiming>;
+}
+
+// Present on results recognised with { timing: true }
+export interface RecognitionTimings {
+  totalMs: number;
+  // Stages that run once over the whole image
+  stages: Record<string, StageTiming>;
+  candidates: CandidateTiming[];
+  candidatesRejected: number;
+  thresholdPasses: number;
+}
+
+export interface AlprResults {
   epoch_time: number;
   frame_number: number;
   img_width: number;
@@ -41,6 +66,7 @@ interface AlprResults {
   total_processing_time_ms: number;
   plates: AlprPlateResult[];
   regionsOfInterest: AlprRegionOfInterest[];
+  timing?: RecognitionTimings;
 }
 
 interface AlprRegionOfInterest {